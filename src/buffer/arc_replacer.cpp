@@ -0,0 +1,188 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.cpp
+//
+// Identification: src/buffer/arc_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "buffer/arc_replacer.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+ARCReplacer::ARCReplacer(size_t num_pages) : num_pages_(num_pages), frames_(num_pages) {}
+
+ARCReplacer::~ARCReplacer() = default;
+
+void ARCReplacer::InsertResident(frame_id_t frame_id, ListType list) {
+  auto &resident = list == ListType::T1 ? t1_ : t2_;
+  resident.push_front(frame_id);
+  frames_[frame_id].list_ = list;
+  frames_[frame_id].pos_ = resident.begin();
+}
+
+void ARCReplacer::RemoveResident(frame_id_t frame_id) {
+  FrameInfo &info = frames_[frame_id];
+  (info.list_ == ListType::T1 ? t1_ : t2_).erase(info.pos_);
+  info.list_ = ListType::NONE;
+}
+
+void ARCReplacer::InsertGhost(page_id_t page_id, ListType list) {
+  auto &ghost = list == ListType::B1 ? b1_ : b2_;
+  ghost.push_front(page_id);
+  ghosts_[page_id] = GhostInfo{list, ghost.begin()};
+}
+
+void ARCReplacer::RemoveLRUGhost(ListType list) {
+  auto &ghost = list == ListType::B1 ? b1_ : b2_;
+  ghosts_.erase(ghost.back());
+  ghost.pop_back();
+}
+
+frame_id_t ARCReplacer::FindEvictable(ListType list) {
+  auto &resident = list == ListType::T1 ? t1_ : t2_;
+  for (auto it = resident.rbegin(); it != resident.rend(); ++it) {
+    if (frames_[*it].evictable_) {
+      return *it;
+    }
+  }
+  return -1;
+}
+
+bool ARCReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (num_evictable_ == 0) {
+    return false;
+  }
+  CHECK(frame_id) << "Expected output frame_id is not nullptr.";
+  // REPLACE: take from T1 while it is above its target, from T2 otherwise,
+  // falling back to the other list when every frame of one of them is pinned.
+  frame_id_t from_t1 = FindEvictable(ListType::T1);
+  frame_id_t from_t2 = FindEvictable(ListType::T2);
+  bool use_t1 = from_t1 != -1 && (t1_.size() > target_ || from_t2 == -1);
+  *frame_id = use_t1 ? from_t1 : from_t2;
+  CHECK(*frame_id != -1) << "Expected an evictable frame.";
+
+  FrameInfo &info = frames_[*frame_id];
+  RemoveResident(*frame_id);
+  if (info.page_id_ != INVALID_PAGE_ID) {
+    InsertGhost(info.page_id_, use_t1 ? ListType::B1 : ListType::B2);
+  }
+  info = FrameInfo();
+  num_evictable_--;
+  return true;
+}
+
+void ARCReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  CHECK(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_) << "Frame id out of range: " << frame_id;
+  FrameInfo &info = frames_[frame_id];
+  if (info.list_ != ListType::NONE && info.page_id_ == page_id) {
+    // Case I: a hit in T1 or T2 makes the page frequent.
+    RemoveResident(frame_id);
+    InsertResident(frame_id, ListType::T2);
+    return;
+  }
+  if (info.list_ != ListType::NONE) {
+    // The frame was handed out again without going through Victim, e.g. after a delete.
+    RemoveResident(frame_id);
+  }
+  info.page_id_ = page_id;
+
+  auto ghost = ghosts_.find(page_id);
+  if (ghost != ghosts_.end() && ghost->second.list_ == ListType::B1) {
+    // Case II: evicted from T1 too early, favour recency.
+    b1_hits_++;
+    size_t delta = std::max<size_t>(1, b2_.size() / b1_.size());
+    target_ = std::min(num_pages_, target_ + delta);
+    b1_.erase(ghost->second.pos_);
+    ghosts_.erase(ghost);
+    InsertResident(frame_id, ListType::T2);
+  } else if (ghost != ghosts_.end()) {
+    // Case III: evicted from T2 too early, favour frequency.
+    b2_hits_++;
+    size_t delta = std::max<size_t>(1, b1_.size() / b2_.size());
+    target_ = target_ > delta ? target_ - delta : 0;
+    b2_.erase(ghost->second.pos_);
+    ghosts_.erase(ghost);
+    InsertResident(frame_id, ListType::T2);
+  } else {
+    // Case IV: a page not seen recently. Keep |T1| + |B1| <= c and the whole
+    // directory <= 2c by forgetting the oldest ghosts.
+    if (t1_.size() + b1_.size() >= num_pages_ && !b1_.empty()) {
+      RemoveLRUGhost(ListType::B1);
+    } else if (t1_.size() + t2_.size() + b1_.size() + b2_.size() >= 2 * num_pages_ && !b2_.empty()) {
+      RemoveLRUGhost(ListType::B2);
+    }
+    InsertResident(frame_id, ListType::T1);
+  }
+}
+
+void ARCReplacer::Forget(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  auto ghost = ghosts_.find(page_id);
+  if (ghost == ghosts_.end()) {
+    return;
+  }
+  (ghost->second.list_ == ListType::B1 ? b1_ : b2_).erase(ghost->second.pos_);
+  ghosts_.erase(ghost);
+}
+
+void ARCReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  CHECK(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_) << "Frame id out of range: " << frame_id;
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    info.evictable_ = false;
+    num_evictable_--;
+  }
+}
+
+void ARCReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  CHECK(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_) << "Frame id out of range: " << frame_id;
+  FrameInfo &info = frames_[frame_id];
+  if (info.list_ == ListType::NONE) {
+    // NOTE: a frame unpinned without a recorded access is treated as a new page.
+    InsertResident(frame_id, ListType::T1);
+  }
+  if (!info.evictable_) {
+    info.evictable_ = true;
+    num_evictable_++;
+  }
+}
+
+size_t ARCReplacer::Size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return num_evictable_;
+}
+
+size_t ARCReplacer::GetTarget() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return target_;
+}
+
+size_t ARCReplacer::GetB1Hits() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return b1_hits_;
+}
+
+size_t ARCReplacer::GetB2Hits() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return b2_hits_;
+}
+
+void ARCReplacer::ResetHits() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  b1_hits_ = 0;
+  b2_hits_ = 0;
+}
+
+}  // namespace bustub
@@ -0,0 +1,28 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.cpp
+//
+// Identification: src/buffer/buffer_access_strategy.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "buffer/buffer_access_strategy.h"
+
+namespace bustub {
+
+BufferAccessStrategy::BufferAccessStrategy(size_t ring_size)
+    : ring_(std::max<size_t>(ring_size / PAGE_SIZE, 1)) {}
+
+void BufferAccessStrategy::Add(Page *page, page_id_t page_id) {
+  ring_[cursor_].page_ = page;
+  ring_[cursor_].page_id_ = page_id;
+  cursor_ = (cursor_ + 1) % ring_.size();
+}
+
+}  // namespace bustub
@@ -9,32 +9,118 @@
 // Copyright (c) 2015-2019, Carnegie Mellon University Database Group
 //
 //===----------------------------------------------------------------------===//
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstring>
 #include <list>
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "common/logger.h"
 
 namespace bustub {
 
-BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager)
-    : pool_size_(pool_size), disk_manager_(disk_manager), log_manager_(log_manager) {
-  // We allocate a consecutive memory space for the buffer pool.
-  pages_ = new Page[pool_size_];
-  replacer_ = new LRUReplacer(pool_size);
+BufferPoolManager::BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager,
+                                     ReplacerType replacer_type, size_t max_pool_size)
+    : BufferPoolManager(pool_size, 1, 0, disk_manager, log_manager, replacer_type, max_pool_size) {}
 
-  // Initially, every page is in the free list.
-  for (size_t i = 0; i < pool_size_; ++i) {
-    free_list_.emplace_back(static_cast<int>(i));
+BufferPoolManager::BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index,
+                                     DiskManager *disk_manager, LogManager *log_manager, ReplacerType replacer_type,
+                                     size_t max_pool_size, DiskScheduler *disk_scheduler)
+    : pool_size_(pool_size),
+      max_pool_size_(std::max(pool_size, max_pool_size)),
+      arena_(max_pool_size_, max_pool_size_ > pool_size),
+      disk_manager_(disk_manager),
+      disk_scheduler_(disk_scheduler),
+      log_manager_(log_manager),
+      page_table_(max_pool_size_),
+      num_instances_(num_instances),
+      instance_index_(instance_index),
+      compressed_cache_(max_pool_size_ > 0 ? compressed_cache_size / num_instances : 0) {
+  CHECK(num_instances_ > 0) << "Expected at least one buffer pool instance.";
+  CHECK(instance_index_ < num_instances_) << "Instance index " << instance_index_ << " out of range.";
+  // The frames are one consecutive mapping, the metadata is kept apart in pages_. Everything is sized for the largest
+  // pool, the frames past the pool size start out retired.
+  pages_ = new Page[max_pool_size_];
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].data_ = arena_.GetFrame(static_cast<frame_id_t>(i));
+  }
+  read_ahead_marks_.reset(new std::atomic<ReadAheadMark>[max_pool_size_]);
+  claim_epochs_.reset(new std::atomic<uint64_t>[max_pool_size_]);
+  claim_latches_.reset(new std::mutex[max_pool_size_]);
+  switch (replacer_type) {
+    case ReplacerType::LRU:
+      replacer_ = new LRUReplacer(max_pool_size_);
+      break;
+    case ReplacerType::CLOCK:
+      replacer_ = new ClockReplacer(max_pool_size_);
+      break;
+    case ReplacerType::LRU_K:
+      replacer_ = new LRUKReplacer(max_pool_size_, lru_k_replacer_k, lru_k_correlated_period);
+      break;
+    case ReplacerType::ARC:
+      replacer_ = new ARCReplacer(max_pool_size_);
+      break;
+  }
+
+  // Initially, every page is in the free list. Free frames are claimed so that a lock-free fetch cannot pin them.
+  retired_.assign(max_pool_size_, false);
+  for (size_t i = 0; i < max_pool_size_; ++i) {
+    pages_[i].pin_count_ = -1;
+    read_ahead_marks_[i] = ReadAheadMark::NONE;
+    claim_epochs_[i] = 0;
+    if (i < pool_size_) {
+      free_list_.emplace_back(static_cast<int>(i));
+    } else {
+      retired_[i] = true;
+    }
+  }
+
+  // A pool without frames (e.g. the front of a ParallelBufferPoolManager) has nothing to write back.
+  if (max_pool_size_ > 0) {
+    if (disk_scheduler_ == nullptr) {
+      // A pool of its own does not need more than one worker thread on top of its writer and read-ahead threads.
+      disk_scheduler_ = new DiskScheduler(disk_manager_, 1);
+      owns_disk_scheduler_ = true;
+    }
+    enable_bg_flush_ = true;
+    bg_flush_thread_ = new std::thread(&BufferPoolManager::RunBackgroundFlush, this);
+    enable_read_ahead_ = true;
+    read_ahead_thread_ = new std::thread(&BufferPoolManager::RunReadAhead, this);
   }
 }
 
 BufferPoolManager::~BufferPoolManager() {
+  if (bg_flush_thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      enable_bg_flush_ = false;
+    }
+    bg_flush_cv_.notify_one();
+    bg_flush_thread_->join();
+    delete bg_flush_thread_;
+  }
+  if (read_ahead_thread_ != nullptr) {
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      enable_read_ahead_ = false;
+    }
+    read_ahead_cv_.notify_one();
+    read_ahead_thread_->join();
+    delete read_ahead_thread_;
+  }
+  if (owns_disk_scheduler_) {
+    delete disk_scheduler_;
+  }
   delete[] pages_;
   delete replacer_;
 }
 
-Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
+Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) { return FetchPageWithStrategy(page_id, nullptr); }
+
+Page *BufferPoolManager::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
   // 1.     Search the page table for the requested page (P).
   // 1.1    If P exists, pin it and return it immediately.
   // 1.2    If P does not exist, find a replacement page (R) from either the
@@ -44,128 +130,308 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then
   // return a pointer to P.
-  std::lock_guard<std::mutex> guard(mutex_);
+  frame_id_t frame_id = -1;
+  // Fast path: a cached page is found and pinned without taking the pool latch. The frame may be reassigned between
+  // the lookup and the pin, so the pin only counts if the frame still holds the page afterwards.
+  if (page_table_.Find(page_id, &frame_id)) {
+    Page *page = &pages_[frame_id];
+    if (TryPin(page)) {
+      if (page->page_id_ == page_id) {
+        replacer_->RecordAccess(frame_id, page_id);
+        replacer_->Pin(frame_id);
+        std::atomic<ReadAheadMark> &read_ahead_mark = read_ahead_marks_[frame_id];
+        if (read_ahead_mark.load(std::memory_order_relaxed) != ReadAheadMark::NONE) {
+          ReadAheadMark mark = read_ahead_mark.exchange(ReadAheadMark::NONE);
+          if (mark != ReadAheadMark::NONE) {
+            std::lock_guard<std::mutex> guard(mutex_);
+            OnReadAheadHit(frame_id, mark, strategy);
+          }
+        }
+        metrics_.Add(BufferPoolMetrics::Counter::HIT);
+        return page;
+      }
+      ReleasePin(frame_id);
+    }
+    // The frame is being reassigned or read into, wait for the latch.
+    metrics_.Add(BufferPoolMetrics::Counter::PIN_WAIT);
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
   // LOG(DEBUG) << "Fetching #page: " << page_id;
-  if (Exist(page_id)) {
-    // If this page is alreay in buffer pool, simply returns it
-    Page *page = &pages_[page_table_[page_id]];
+  if (page_table_.Find(page_id, &frame_id)) {
+    // Somebody else brought the page in, or it was being reassigned while we looked.
+    Page *page = &pages_[frame_id];
     CHECK(page->GetPageId() == page_id) << page_id << " " << page->GetPageId();
+    if (page->pin_count_ < 0) {
+      // Another fetch or the read-ahead thread is reading the page in, they are the only ones keeping a mapped frame
+      // claimed while the latch is released. Start over once the page is published.
+      metrics_.Add(BufferPoolMetrics::Counter::PIN_WAIT);
+      WaitForRead(page_id, &lock);
+      lock.unlock();
+      return FetchPageWithStrategy(page_id, strategy);
+    }
     page->pin_count_++;
+    replacer_->RecordAccess(frame_id, page_id);
+    replacer_->Pin(frame_id);
+    ReadAheadMark mark = read_ahead_marks_[frame_id].exchange(ReadAheadMark::NONE);
+    if (mark != ReadAheadMark::NONE) {
+      OnReadAheadHit(frame_id, mark, strategy);
+    }
+    metrics_.Add(BufferPoolMetrics::Counter::HIT);
     // LOG(DEBUG) << "Fetching from the exising #page " << page_id << " pin_count: " << page->pin_count_;
     return page;
   } else {
     // Otherwise found a new place and read that page from disk.
-    int frame_id = -1;
-    if (!free_list_.empty()) {
-      // If we can get a frame from free_list_
-      frame_id = free_list_.front();
-      free_list_.erase(free_list_.begin());
-    } else if (replacer_->Size() > 0) {
-      // Otherwise get a frame from the replacer, for LRU, this frame should be
-      // the least recently used one
-      page_id_t page_id;
-      CHECK(replacer_->Victim(&page_id));
-      // Remove this frame from the replacer_
-      replacer_->Pin(page_id);
-      frame_id = page_table_[page_id];
-      // LOG(DEBUG) << "Erasing page_id: " << page_id;
-      // page_table_.erase(page_id);
-    } else {
+    if (!FindFrame(strategy, &frame_id, &lock)) {
+      if (WaitForReadAhead(&lock) || WaitForWriteBack(&lock)) {
+        metrics_.Add(BufferPoolMetrics::Counter::PIN_WAIT);
+        // The page may have been brought in while we waited, start over.
+        lock.unlock();
+        return FetchPageWithStrategy(page_id, strategy);
+      }
       // No place to put this page.
       // throw Exception("Out of Memory.");
       return nullptr;
     }
+    frame_id_t cached_frame_id;
+    if (page_table_.Find(page_id, &cached_frame_id)) {
+      // The page was brought in while FindFrame waited for the background writer, start over.
+      FreeFrame(frame_id);
+      lock.unlock();
+      return FetchPageWithStrategy(page_id, strategy);
+    }
     CHECK(page_id >= 0) << "Expected page id greater or equal to 0: " << page_id;
     // LOG(DEBUG) << "Fetching a new #page " << page_id << " to frame " << frame_id;
     Page *page = &pages_[frame_id];
-    // CHECK(page->page_id_ >= 0) << page_id;
-    if (page->is_dirty_) {
-      // Flush the old page back to disk if dirty
-      FlushPageImpl(page->page_id_);
-    }
-    // LOG(DEBUG) << "Erasing page_id: " << page->page_id_;
-    page_table_.erase(page->page_id_);
-    page_table_[page_id] = frame_id;
     page->page_id_ = page_id;
-    page->pin_count_ = 1;
-    page->ResetMemory();
     CHECK(page->GetPageId() == page_id) << page_id << " " << page->GetPageId();
-    disk_manager_->ReadPage(page_id, page->GetData());
+    // Map the page while the frame is still claimed, so that other fetches of it wait for this read instead of
+    // reading it again, then read it with the latch released. Misses on other pages go on meanwhile.
+    page_table_.Insert(page_id, frame_id);
+    read_ahead_marks_[frame_id] = ReadAheadMark::NONE;
+    // A miss on the page right after the previous miss starts a sequential run. Page ids of this instance are
+    // num_instances_ apart.
+    if (last_miss_page_id_ != INVALID_PAGE_ID &&
+        page_id == last_miss_page_id_ + static_cast<page_id_t>(num_instances_)) {
+      for (size_t i = 1; i <= read_ahead_depth; ++i) {
+        ScheduleReadAhead(page_id + static_cast<page_id_t>(i * num_instances_), true);
+      }
+    }
+    last_miss_page_id_ = page_id;
+    lock.unlock();
+    // The victim may have been staged for the compressed cache, compress it now that the latch is released.
+    compressed_cache_.Compress();
+    if (!compressed_cache_.Lookup(page_id, page->GetData())) {
+      page->ResetMemory();
+      disk_scheduler_->ReadPage(page_id, page->GetData());
+    }
+    lock.lock();
+    replacer_->RecordAccess(frame_id, page_id);
+    if (strategy != nullptr) {
+      strategy->Add(page, page_id);
+    }
+    // Publish the frame only once its content is in place.
+    page->pin_count_ = 1;
+    read_done_cv_.notify_all();
+    metrics_.Add(BufferPoolMetrics::Counter::MISS);
+    metrics_.RecordMissLatency(static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
     return page;
   }
 }
 
+bool BufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) {
+  pages->assign(page_ids.size(), nullptr);
+  auto start = std::chrono::steady_clock::now();
+  std::unique_lock<std::mutex> lock(mutex_);
+  bool fetched_all = true;
+  // Frames taken for the misses and the pins they get, by page id. Like a single miss, they are mapped while still
+  // claimed, so that other fetches of these pages wait for this batch.
+  std::unordered_map<page_id_t, std::pair<frame_id_t, int>> miss_frames;
+  std::vector<page_id_t> miss_page_ids;
+  std::vector<char *> miss_data;
+  // Positions of the pages another fetch is reading in. They are only waited for once the misses of this batch are
+  // published, a batch never waits while it holds claimed frames that others may wait for in turn.
+  std::vector<size_t> pending;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    page_id_t page_id = page_ids[i];
+    auto miss = miss_frames.find(page_id);
+    if (miss != miss_frames.end()) {
+      miss->second.second++;
+      (*pages)[i] = &pages_[miss->second.first];
+      continue;
+    }
+    frame_id_t frame_id;
+    frame_id_t cached_frame_id;
+    if (page_table_.Find(page_id, &frame_id)) {
+      Page *page = &pages_[frame_id];
+      if (page->pin_count_ < 0) {
+        pending.push_back(i);
+        continue;
+      }
+      page->pin_count_++;
+      replacer_->RecordAccess(frame_id, page_id);
+      replacer_->Pin(frame_id);
+      ReadAheadMark mark = read_ahead_marks_[frame_id].exchange(ReadAheadMark::NONE);
+      if (mark != ReadAheadMark::NONE) {
+        OnReadAheadHit(frame_id, mark, nullptr);
+      }
+      metrics_.Add(BufferPoolMetrics::Counter::HIT);
+      (*pages)[i] = page;
+      continue;
+    }
+    if (!FindFrame(nullptr, &frame_id, &lock)) {
+      fetched_all = false;
+      continue;
+    }
+    if (page_table_.Find(page_id, &cached_frame_id)) {
+      // The page was brought in while FindFrame waited for the background writer, it is fetched with the pending ones.
+      FreeFrame(frame_id);
+      pending.push_back(i);
+      continue;
+    }
+    CHECK(page_id >= 0) << "Expected page id greater or equal to 0: " << page_id;
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
+    page_table_.Insert(page_id, frame_id);
+    read_ahead_marks_[frame_id] = ReadAheadMark::NONE;
+    page->ResetMemory();
+    miss_frames.emplace(page_id, std::make_pair(frame_id, 1));
+    miss_page_ids.push_back(page_id);
+    miss_data.push_back(page->GetData());
+    (*pages)[i] = page;
+  }
+
+  if (!miss_page_ids.empty()) {
+    // Scheduled as one batch with the latch released, so that the runs of consecutive pages among the misses are read
+    // with one call each. The pages kept in the compressed cache are not read.
+    lock.unlock();
+    std::vector<DiskRequest> requests;
+    std::vector<std::future<bool>> reads;
+    for (size_t i = 0; i < miss_page_ids.size(); ++i) {
+      if (compressed_cache_.Lookup(miss_page_ids[i], miss_data[i])) {
+        continue;
+      }
+      requests.push_back(DiskRequest{false, miss_data[i], miss_page_ids[i], std::promise<bool>()});
+      reads.push_back(requests.back().callback_.get_future());
+    }
+    if (!requests.empty()) {
+      disk_scheduler_->Schedule(&requests);
+    }
+    for (auto &read : reads) {
+      read.get();
+    }
+    lock.lock();
+    for (auto &[page_id, miss] : miss_frames) {
+      auto [frame_id, pin_count] = miss;
+      replacer_->RecordAccess(frame_id, page_id);
+      // Publish the frame once its content is in place, with one pin per occurrence of the page in the batch.
+      pages_[frame_id].pin_count_ = pin_count;
+    }
+    read_done_cv_.notify_all();
+    auto latency = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
+    for (size_t i = 0; i < miss_page_ids.size(); ++i) {
+      metrics_.Add(BufferPoolMetrics::Counter::MISS);
+      metrics_.RecordMissLatency(latency);
+    }
+  }
+
+  if (!pending.empty()) {
+    std::vector<page_id_t> pending_page_ids;
+    for (size_t i : pending) {
+      metrics_.Add(BufferPoolMetrics::Counter::PIN_WAIT);
+      WaitForRead(page_ids[i], &lock);
+      pending_page_ids.push_back(page_ids[i]);
+    }
+    // The pages were published or dropped meanwhile, fetch them as a batch of their own.
+    lock.unlock();
+    std::vector<Page *> pending_pages;
+    fetched_all = BufferPoolManager::FetchPages(pending_page_ids, &pending_pages) && fetched_all;
+    for (size_t j = 0; j < pending.size(); ++j) {
+      (*pages)[pending[j]] = pending_pages[j];
+    }
+  }
+  return fetched_all;
+}
+
 bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
-  std::lock_guard<std::mutex> guard(mutex_);
   // LOG(DEBUG) << "Unpinning #page: " << page_id;
-  CHECK(Exist(page_id)) << "Expected page exists: " << page_id;
-  Page *page = &pages_[page_table_[page_id]];
+  // The caller holds a pin, so the page can be neither evicted nor deleted and no latch is needed.
+  frame_id_t frame_id = -1;
+  CHECK(page_table_.Find(page_id, &frame_id)) << "Expected page exists: " << page_id;
+  Page *page = &pages_[frame_id];
   CHECK(page->GetPageId() == page_id) << page_id << " " << page->GetPageId();
-  CHECK(page->pin_count_ > 0) << page_id;
-  page->pin_count_--;
-  page->is_dirty_ = is_dirty;
-  if (page->pin_count_ == 0) {
-    if (page->is_dirty_) {
-      FlushPageImpl(page_id);
-    }
-    replacer_->Unpin(page_id);
+  // A clean unpin must not hide an earlier dirty one. Dirty pages stay in the pool and are written back by the
+  // background writer, also when an eviction finds them dirty because it fell behind. The flag is set before the pin
+  // is dropped, so whoever claims the frame afterwards sees it.
+  if (is_dirty) {
+    page->is_dirty_ = true;
   }
+  CHECK(page->pin_count_ > 0) << page_id;
+  ReleasePin(frame_id);
   return true;
 }
 
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
-  // std::lock_guard<std::mutex> guard(mutex_);
   // Make sure you call DiskManager::WritePage!
-  if (!Exist(page_id)) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  frame_id_t frame_id = -1;
+  if (!page_table_.Find(page_id, &frame_id)) {
     return false;
-  } else {
-    // LOG(DEBUG) << "Flusing # page: " << page_id;
-    Page *page = &pages_[page_table_[page_id]];
-    CHECK(page->GetPageId() == page_id) << page_id << " " << page->GetPageId();
-    disk_manager_->WritePage(page_id, page->GetData());
-    page->is_dirty_ = false;
-    // LOG(DEBUG) << "Flushed # page: " << page_id;
+  }
+  if (pages_[frame_id].pin_count_ < 0) {
+    // The page is being read in, so it is the same as on disk.
     return true;
   }
+  FlushFrame(frame_id);
+  return true;
 }
 
-Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
+Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) { return NewPageWithStrategy(page_id, nullptr); }
+
+Page *BufferPoolManager::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
   // 0.   Make sure you call DiskManager::AllocatePage!
   // 1.   If all the pages in the buffer pool are pinned, return nullptr.
   // 2.   Pick a victim page P from either the free list or the replacer. Always
   // pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::lock_guard<std::mutex> guard(mutex_);
-  page_id_t new_page_id = page_id_++;
-  CHECK(new_page_id >= 0);
-  // LOG(DEBUG) << "New #page: " << new_page_id;
-  int frame_id = -1;
-  if (!free_list_.empty()) {
-    // If we can get a frame from free_list_
-    frame_id = free_list_.front();
-    free_list_.erase(free_list_.begin());
-  } else if (replacer_->Size() > 0) {
-    page_id_t page_id;
-    CHECK(replacer_->Victim(&page_id));
-    // Remove this frame from the replacer_
-    replacer_->Pin(page_id);
-    frame_id = page_table_[page_id];
-    // LOG(DEBUG) << "Erasing page_id: " << page_id;
-    page_table_.erase(page_id);
-  } else {
+  std::unique_lock<std::mutex> lock(mutex_);
+  frame_id_t frame_id = -1;
+  if (!FindFrame(strategy, &frame_id, &lock)) {
+    bool retry = WaitForReadAhead(&lock) || WaitForWriteBack(&lock);
+    lock.unlock();
+    if (retry) {
+      metrics_.Add(BufferPoolMetrics::Counter::PIN_WAIT);
+      return NewPageWithStrategy(page_id, strategy);
+    }
     // throw Exception("Out of Memory.");
     return nullptr;
   }
   CHECK(frame_id != -1) << "Expected find a free frame.";
+  // Stripe page ids across instances so that page_id % num_instances_ identifies the owner. Deleted pages of this
+  // instance are reused first, which may sync the free space map, so the page is allocated with the latch released
+  // while the frame stays claimed. A full pool allocates nothing. The page is not zeroed on disk, the zeroed frame is
+  // dirty and gets written back instead.
+  lock.unlock();
+  page_id_t new_page_id = disk_manager_->AllocatePage(num_instances_, instance_index_, false);
+  CHECK(new_page_id >= 0);
+  CHECK(static_cast<uint32_t>(new_page_id) % num_instances_ == instance_index_);
+  lock.lock();
+  // LOG(DEBUG) << "New #page: " << new_page_id;
   Page *page = &pages_[frame_id];
-  if (page->is_dirty_) {
-    FlushPageImpl(page->page_id_);
-  }
   page->ResetMemory();
+  page->is_dirty_ = true;
   page->page_id_ = new_page_id;
+  page_table_.Insert(new_page_id, frame_id);
+  replacer_->RecordAccess(frame_id, new_page_id);
+  read_ahead_marks_[frame_id] = ReadAheadMark::NONE;
+  if (strategy != nullptr) {
+    strategy->Add(page, new_page_id);
+  }
   page->pin_count_ = 1;
-  page_table_[new_page_id] = frame_id;
   *page_id = new_page_id;
   CHECK(page->GetPageId() == new_page_id) << *page_id << " " << page->GetPageId();
   return page;
@@ -181,22 +447,29 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // metadata and return it to the free list.
   std::lock_guard<std::mutex> guard(mutex_);
   // LOG(DEBUG) << "Delete #page: " << page_id;
-  if (!Exist(page_id)) {
+  frame_id_t frame_id = -1;
+  if (!page_table_.Find(page_id, &frame_id)) {
+    compressed_cache_.Erase(page_id);
+    // The id may be handed out again, a new page of that id must not count as a ghost hit.
+    replacer_->Forget(page_id);
+    disk_manager_->DeallocatePage(page_id);
     return true;
   } else {
-    // disk_manager_->DeallocatePage(page_id);
-    Page *page = &pages_[page_table_[page_id]];
+    Page *page = &pages_[frame_id];
     CHECK(page->GetPageId() == page_id) << page_id << " " << page->GetPageId();
-    if (page->pin_count_ > 0) {
+    if (!ClaimFrame(page)) {
       return false;
     } else {
+      disk_manager_->DeallocatePage(page_id);
+      // The frame stays claimed while it is on the free list.
+      replacer_->Pin(frame_id);
+      // LOG(DEBUG) << "Erasing page_id: " << page_id;
+      page_table_.Erase(page_id);
       page->ResetMemory();
       page->page_id_ = INVALID_PAGE_ID;
-      page->pin_count_ = 0;
-      free_list_.insert(free_list_.end(), page_table_[page_id]);
-      // LOG(DEBUG) << "Erasing page_id: " << page_id;
-      page_table_.erase(page_id);
-      return false;
+      page->is_dirty_ = false;
+      FreeFrame(frame_id);
+      return true;
     }
   }
 }
@@ -209,15 +482,582 @@ void BufferPoolManager::DebugOutput() const {
 
 void BufferPoolManager::FlushAllPagesImpl() {
   // You can do it!
+  FlushDirtyPages({this});
+}
+
+void BufferPoolManager::FlushDirtyPages(const std::vector<BufferPoolManager *> &pools) {
+  struct DirtyPage {
+    page_id_t page_id_;
+    frame_id_t frame_id_;
+    BufferPoolManager *pool_;
+  };
+  std::vector<DirtyPage> dirty_pages;
+  for (auto *pool : pools) {
+    std::lock_guard<std::mutex> guard(pool->mutex_);
+    // Frames past the pool size may still hold pages a shrink left pinned.
+    for (size_t i = 0; i < pool->max_pool_size_; ++i) {
+      Page *page = &pool->pages_[i];
+      // A claimed frame is free, retired or being read into, it holds no dirty page.
+      if (page->page_id_ == INVALID_PAGE_ID || !page->is_dirty_ || page->pin_count_ < 0) {
+        continue;
+      }
+      // Pin the frame so that the page stays put, and clear the flag before writing like WriteBack does.
+      page->pin_count_++;
+      page->is_dirty_ = false;
+      pool->metrics_.Add(BufferPoolMetrics::Counter::DIRTY_WRITE_BACK);
+      dirty_pages.push_back({page->page_id_, static_cast<frame_id_t>(i), pool});
+    }
+  }
+  if (dirty_pages.empty()) {
+    return;
+  }
+  std::sort(dirty_pages.begin(), dirty_pages.end(),
+            [](const DirtyPage &a, const DirtyPage &b) { return a.page_id_ < b.page_id_; });
+
+  DiskManager *disk_manager = pools.front()->disk_manager_;
+  const size_t batch_size = FLUSH_BATCH_SIZE / PAGE_SIZE;
+  const size_t num_batches = (dirty_pages.size() + batch_size - 1) / batch_size;
+  const size_t num_threads = std::clamp<size_t>(flush_io_threads, 1, num_batches);
+  // Thread t writes batches t, t + num_threads, ... so that the batches go out roughly in page id order.
+  auto write_batches = [&](size_t thread_index) {
+    // Staged pages are aligned like the frames, as direct I/O needs them.
+    FrameArena staging(batch_size);
+    std::vector<page_id_t> page_ids;
+    std::vector<const char *> page_data;
+    for (size_t batch = thread_index; batch < num_batches; batch += num_threads) {
+      size_t begin = batch * batch_size;
+      size_t end = std::min(begin + batch_size, dirty_pages.size());
+      page_ids.clear();
+      page_data.clear();
+      for (size_t i = begin; i < end; ++i) {
+        Page *page = &dirty_pages[i].pool_->pages_[dirty_pages[i].frame_id_];
+        char *data = staging.GetFrame(static_cast<frame_id_t>(i - begin));
+        page->RLatch();
+        memcpy(data, page->GetData(), PAGE_SIZE);
+        page->RUnlatch();
+        page_ids.push_back(dirty_pages[i].page_id_);
+        page_data.push_back(data);
+      }
+      disk_manager->WritePages(page_ids, page_data);
+      for (size_t i = begin; i < end; ++i) {
+        dirty_pages[i].pool_->ReleasePin(dirty_pages[i].frame_id_);
+      }
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t t = 1; t < num_threads; ++t) {
+    threads.emplace_back(write_batches, t);
+  }
+  write_batches(0);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  disk_manager->Sync();
+}
+
+BufferPoolStats BufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  metrics_.GetStats(&stats);
+  if (auto *arc_replacer = dynamic_cast<ARCReplacer *>(replacer_)) {
+    stats.arc_target_ = arc_replacer->GetTarget();
+    stats.arc_b1_hits_ = arc_replacer->GetB1Hits();
+    stats.arc_b2_hits_ = arc_replacer->GetB2Hits();
+  }
   std::lock_guard<std::mutex> guard(mutex_);
-  for (auto &it : page_table_) {
-    FlushPageImpl(it.first);
+  stats.free_frames_ = free_list_.size();
+  return stats;
+}
+
+void BufferPoolManager::ResetStats() {
+  metrics_.Reset();
+  compressed_cache_.ResetStats();
+  if (auto *arc_replacer = dynamic_cast<ARCReplacer *>(replacer_)) {
+    arc_replacer->ResetHits();
   }
 }
 
+bool BufferPoolManager::Resize(size_t pool_size) {
+  if (pool_size == 0 || pool_size > max_pool_size_) {
+    return false;
+  }
+  std::lock_guard<std::mutex> resize_guard(resize_mutex_);
+  std::unique_lock<std::mutex> lock(mutex_);
+  size_t old_pool_size = pool_size_;
+  pool_size_ = pool_size;
+  if (pool_size > old_pool_size) {
+    // Frames a shrink left pinned are simply in use again, the retired ones become free.
+    for (size_t i = old_pool_size; i < pool_size; ++i) {
+      if (retired_[i]) {
+        retired_[i] = false;
+        free_list_.emplace_back(static_cast<frame_id_t>(i));
+      }
+    }
+    return true;
+  }
+
+  // From here on no frame past the new size is handed out: those on the free list are dropped, and the ones taken
+  // by FetchPage/NewPage are retired when picked as a victim.
+  for (auto it = free_list_.begin(); it != free_list_.end();) {
+    if (static_cast<size_t>(*it) >= pool_size) {
+      RetireFrame(*it);
+      it = free_list_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+  // A read-ahead in flight holds a frame that is neither free nor mapped, it is retired once the read is done.
+  WaitForReadAhead(&lock);
+  // This includes the frames an earlier shrink left pinned, so resizing to the current size retries them.
+  bool shrunk = true;
+  for (size_t i = pool_size; i < max_pool_size_; ++i) {
+    if (!retired_[i] && !TryRetireFrame(static_cast<frame_id_t>(i), &lock)) {
+      shrunk = false;
+    }
+  }
+  return shrunk;
+}
+
 bool BufferPoolManager::Exist(page_id_t page_id) {
   // DebugOutput();
-  return page_table_.find(page_id) != page_table_.end();
+  frame_id_t frame_id;
+  return page_table_.Find(page_id, &frame_id);
+}
+
+bool BufferPoolManager::TryPin(Page *page) {
+  int pin_count = page->pin_count_;
+  while (pin_count >= 0) {
+    if (page->pin_count_.compare_exchange_weak(pin_count, pin_count + 1)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BufferPoolManager::ReleasePin(frame_id_t frame_id) {
+  // The pin keeps the frame from being claimed, so this is the epoch of the page being unpinned.
+  uint64_t epoch = claim_epochs_[frame_id].load();
+  if (pages_[frame_id].pin_count_.fetch_sub(1) == 1) {
+    std::lock_guard<std::mutex> guard(claim_latches_[frame_id]);
+    // Once the frame was claimed, whoever claimed it took it out of the replacer, and it may hold another page by
+    // now whose history must not be touched.
+    if (claim_epochs_[frame_id].load() == epoch) {
+      replacer_->Unpin(frame_id);
+    }
+  }
+}
+
+bool BufferPoolManager::ClaimFrame(Page *page) {
+  auto frame_id = static_cast<size_t>(page - pages_);
+  std::lock_guard<std::mutex> guard(claim_latches_[frame_id]);
+  int pin_count = 0;
+  if (!page->pin_count_.compare_exchange_strong(pin_count, -1)) {
+    return false;
+  }
+  claim_epochs_[frame_id]++;
+  return true;
+}
+
+void BufferPoolManager::FlushFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  if (page->is_dirty_) {
+    metrics_.Add(BufferPoolMetrics::Counter::DIRTY_WRITE_BACK);
+  }
+  disk_scheduler_->WritePage(page->page_id_, page->GetData());
+  page->is_dirty_ = false;
+}
+
+void BufferPoolManager::KeepCompressed(Page *page) {
+  if (compressed_cache_.Stage(page->page_id_, page->GetData())) {
+    RequestBackgroundFlush();
+  }
+}
+
+bool BufferPoolManager::FindVictimFrame(frame_id_t *frame_id, std::unique_lock<std::mutex> *lock) {
+  while (true) {
+    if (!free_list_.empty()) {
+      // If we can get a frame from free_list_
+      *frame_id = free_list_.front();
+      free_list_.pop_front();
+      if (free_list_.size() < bg_free_frames) {
+        RequestBackgroundFlush();
+      }
+      return true;
+    }
+    // Otherwise get a frame from the replacer, for LRU, this frame should be
+    // the least recently used one
+    size_t num_handed_over = 0;
+    while (num_handed_over <= bg_free_frames && replacer_->Victim(frame_id)) {
+      Page *page = &pages_[*frame_id];
+      if (!ClaimFrame(page)) {
+        // Pinned by a lock-free fetch or by the background writer, whoever drops the last pin puts the frame back into
+        // the replacer.
+        continue;
+      }
+      if (page->is_dirty_) {
+        // The background writer fell behind. The victim is handed to it instead of being written back here, and stays
+        // claimed and mapped until it is written, so that fetches of the page wait for the write.
+        evict_queue_.push_back(*frame_id);
+        num_handed_over++;
+        RequestBackgroundFlush();
+        continue;
+      }
+      KeepCompressed(page);
+      // LOG(DEBUG) << "Erasing page_id: " << page->page_id_;
+      page_table_.Erase(page->page_id_);
+      metrics_.Add(BufferPoolMetrics::Counter::EVICTION);
+      page->page_id_ = INVALID_PAGE_ID;
+      if (static_cast<size_t>(*frame_id) >= pool_size_) {
+        // A shrink left the frame pinned, it is retired now instead of being reused.
+        RetireFrame(*frame_id);
+        continue;
+      }
+      RequestBackgroundFlush();
+      return true;
+    }
+    if (evict_queue_.empty()) {
+      return false;
+    }
+    // Every victim was dirty, wait for the background writer to free one of them and look again.
+    frame_freed_cv_.wait(*lock, [&] { return !free_list_.empty() || evict_queue_.empty(); });
+  }
+}
+
+void BufferPoolManager::RetireFrame(frame_id_t frame_id) {
+  Page *page = &pages_[frame_id];
+  page->page_id_ = INVALID_PAGE_ID;
+  page->is_dirty_ = false;
+  read_ahead_marks_[frame_id] = ReadAheadMark::NONE;
+  replacer_->Pin(frame_id);
+  retired_[frame_id] = true;
+  arena_.Release(frame_id, 1);
+}
+
+void BufferPoolManager::FreeFrame(frame_id_t frame_id) {
+  if (static_cast<size_t>(frame_id) < pool_size_) {
+    free_list_.emplace_back(frame_id);
+  } else {
+    RetireFrame(frame_id);
+  }
+}
+
+bool BufferPoolManager::TryRetireFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page *page = &pages_[frame_id];
+  if (page->is_dirty_ && page->pin_count_ == 0) {
+    WriteBack(frame_id, lock);
+    // The frame may have been retired as a victim while the latch was released, or be back in use after a grow.
+    if (retired_[frame_id] || static_cast<size_t>(frame_id) < pool_size_) {
+      return retired_[frame_id];
+    }
+  }
+  if (page->is_dirty_ || !ClaimFrame(page)) {
+    return false;
+  }
+  KeepCompressed(page);
+  page_table_.Erase(page->page_id_);
+  metrics_.Add(BufferPoolMetrics::Counter::EVICTION);
+  RetireFrame(frame_id);
+  return true;
+}
+
+bool BufferPoolManager::ClaimRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id) {
+  BufferAccessStrategy::Slot *slot = strategy->Current();
+  // The ring may hold frames of other instances of a parallel pool, or frames past the pool size after a shrink, and
+  // the page may have been evicted or deleted since the strategy put it there.
+  if (slot->page_ < pages_ || slot->page_ >= pages_ + pool_size_ || slot->page_->page_id_ != slot->page_id_ ||
+      !ClaimFrame(slot->page_)) {
+    return false;
+  }
+  *frame_id = static_cast<frame_id_t>(slot->page_ - pages_);
+  replacer_->Pin(*frame_id);
+  return true;
+}
+
+bool BufferPoolManager::RecycleRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id,
+                                         std::unique_lock<std::mutex> *lock) {
+  if (!ClaimRingFrame(strategy, frame_id)) {
+    return false;
+  }
+  Page *page = &pages_[*frame_id];
+  page_id_t page_id = page->page_id_;
+  if (page->is_dirty_) {
+    // A bulk load writes back its own pages, they are never worth keeping in the pool. The frame stays claimed and
+    // mapped during the write, so that fetches of the page wait for it, and needs no page latch.
+    page->is_dirty_ = false;
+    metrics_.Add(BufferPoolMetrics::Counter::DIRTY_WRITE_BACK);
+    lock->unlock();
+    disk_scheduler_->ScheduleWrite(page_id, page->GetData(), DiskRequestPriority::FOREGROUND).get();
+    lock->lock();
+  }
+  page_table_.Erase(page_id);
+  metrics_.Add(BufferPoolMetrics::Counter::EVICTION);
+  page->page_id_ = INVALID_PAGE_ID;
+  read_done_cv_.notify_all();
+  if (static_cast<size_t>(*frame_id) >= pool_size_) {
+    // The pool shrank during the write.
+    RetireFrame(*frame_id);
+    return false;
+  }
+  return true;
+}
+
+bool BufferPoolManager::FindFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id,
+                                  std::unique_lock<std::mutex> *lock) {
+  if (strategy != nullptr && RecycleRingFrame(strategy, frame_id, lock)) {
+    return true;
+  }
+  return FindVictimFrame(frame_id, lock);
+}
+
+void BufferPoolManager::OnReadAheadHit(frame_id_t frame_id, ReadAheadMark mark, BufferAccessStrategy *strategy) {
+  Page *page = &pages_[frame_id];
+  if (mark == ReadAheadMark::SEQUENTIAL) {
+    // Keep the run read_ahead_depth pages ahead of the reader.
+    ScheduleReadAhead(page->page_id_ + static_cast<page_id_t>(read_ahead_depth * num_instances_), true);
+  }
+  if (strategy != nullptr) {
+    // The read-ahead took a free frame for the operation, give one of its ring back so that it stays in its ring.
+    // The caller may not release the latch, a dirty one is handed to the background writer, which frees it.
+    frame_id_t ring_frame_id;
+    if (ClaimRingFrame(strategy, &ring_frame_id)) {
+      Page *ring_page = &pages_[ring_frame_id];
+      if (ring_page->is_dirty_) {
+        evict_queue_.push_back(ring_frame_id);
+        RequestBackgroundFlush();
+      } else {
+        page_table_.Erase(ring_page->page_id_);
+        metrics_.Add(BufferPoolMetrics::Counter::EVICTION);
+        ring_page->page_id_ = INVALID_PAGE_ID;
+        FreeFrame(ring_frame_id);
+      }
+    }
+    strategy->Add(page, page->page_id_);
+  }
+}
+
+void BufferPoolManager::RequestBackgroundFlush() {
+  bg_flush_requested_ = true;
+  bg_flush_cv_.notify_one();
+}
+
+void BufferPoolManager::WriteBack(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page *page = &pages_[frame_id];
+  page_id_t page_id = page->page_id_;
+  // Pin the frame so that it is neither evicted nor deleted while the pool latch is released.
+  page->pin_count_++;
+  // Clear the flag before writing: an update racing with the write dirties the page again on unpin.
+  page->is_dirty_ = false;
+  metrics_.Add(BufferPoolMetrics::Counter::DIRTY_WRITE_BACK);
+  lock->unlock();
+  page->RLatch();
+  write_backs_in_flight_++;
+  disk_scheduler_->ScheduleWrite(page_id, page->GetData(), DiskRequestPriority::BACKGROUND).get();
+  page->RUnlatch();
+  lock->lock();
+  // A victim search may have skipped the frame during the write, dropping the last pin puts it back.
+  ReleasePin(frame_id);
+  write_backs_in_flight_--;
+  write_back_done_cv_.notify_all();
+}
+
+void BufferPoolManager::EvictHandedOverFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock) {
+  Page *page = &pages_[frame_id];
+  page_id_t page_id = page->page_id_;
+  page->is_dirty_ = false;
+  metrics_.Add(BufferPoolMetrics::Counter::DIRTY_WRITE_BACK);
+  // The frame is claimed, so the page can be neither pinned nor changed during the write and needs no page latch.
+  // Somebody waits for the frame, the write is a foreground one.
+  lock->unlock();
+  disk_scheduler_->ScheduleWrite(page_id, page->GetData(), DiskRequestPriority::FOREGROUND).get();
+  lock->lock();
+  KeepCompressed(page);
+  page_table_.Erase(page_id);
+  metrics_.Add(BufferPoolMetrics::Counter::EVICTION);
+  page->page_id_ = INVALID_PAGE_ID;
+  FreeFrame(frame_id);
+  // Fetches of the page read it from disk again.
+  read_done_cv_.notify_all();
+  frame_freed_cv_.notify_all();
+}
+
+void BufferPoolManager::PrefetchPage(page_id_t page_id) {
+  frame_id_t frame_id;
+  if (page_id == INVALID_PAGE_ID || page_table_.Find(page_id, &frame_id)) {
+    return;
+  }
+  // A mapped page comes from the OS page cache then, even if the read-ahead below is dropped.
+  disk_manager_->Advise(page_id, 1, AccessHint::WILLNEED);
+  std::lock_guard<std::mutex> guard(mutex_);
+  ScheduleReadAhead(page_id, false);
+}
+
+void BufferPoolManager::ScheduleReadAhead(page_id_t page_id, bool sequential) {
+  if (read_ahead_thread_ == nullptr || read_ahead_depth == 0 || read_ahead_queue_.size() >= pool_size_) {
+    return;
+  }
+  read_ahead_queue_.emplace_back(page_id, sequential);
+  read_ahead_cv_.notify_one();
+}
+
+void BufferPoolManager::WaitForRead(page_id_t page_id, std::unique_lock<std::mutex> *lock) {
+  read_done_cv_.wait(*lock, [&] {
+    frame_id_t frame_id;
+    return !page_table_.Find(page_id, &frame_id) || pages_[frame_id].pin_count_ >= 0;
+  });
+}
+
+bool BufferPoolManager::WaitForReadAhead(std::unique_lock<std::mutex> *lock) {
+  if (!read_ahead_in_flight_) {
+    return false;
+  }
+  read_ahead_done_cv_.wait(*lock, [&] { return !read_ahead_in_flight_; });
+  return true;
+}
+
+bool BufferPoolManager::WaitForWriteBack(std::unique_lock<std::mutex> *lock) {
+  if (write_backs_in_flight_ == 0) {
+    return false;
+  }
+  write_back_done_cv_.wait(*lock, [&] { return write_backs_in_flight_ == 0; });
+  return true;
+}
+
+void BufferPoolManager::RunReadAhead() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    read_ahead_cv_.wait(lock, [&] { return !enable_read_ahead_ || !read_ahead_queue_.empty(); });
+    if (!enable_read_ahead_) {
+      break;
+    }
+    auto [page_id, sequential] = read_ahead_queue_.front();
+    read_ahead_queue_.pop_front();
+    frame_id_t frame_id;
+    // Never read into a frame that has to be evicted first, read-ahead must not push out pages that are in use.
+    if (page_table_.Find(page_id, &frame_id) || free_list_.empty() || !disk_manager_->IsPageAllocated(page_id)) {
+      continue;
+    }
+    frame_id = free_list_.front();
+    free_list_.pop_front();
+    if (free_list_.size() < bg_free_frames) {
+      RequestBackgroundFlush();
+    }
+    // Map the page while the frame is still claimed, like a foreground miss does, so that fetches of the page wait
+    // for this read instead of reading it again, and the page can be neither fetched, updated and evicted nor deleted
+    // before the read is done.
+    Page *page = &pages_[frame_id];
+    page->page_id_ = page_id;
+    page_table_.Insert(page_id, frame_id);
+    read_ahead_marks_[frame_id] = ReadAheadMark::NONE;
+    read_ahead_in_flight_ = true;
+    lock.unlock();
+    if (!compressed_cache_.Lookup(page_id, page->GetData())) {
+      page->ResetMemory();
+      disk_scheduler_->ScheduleRead(page_id, page->GetData(), DiskRequestPriority::BACKGROUND).get();
+    }
+    lock.lock();
+    // Either way the frame can be taken again below, wake up whoever found the pool full in the meantime.
+    read_ahead_in_flight_ = false;
+    read_ahead_done_cv_.notify_all();
+    if (static_cast<size_t>(frame_id) >= pool_size_) {
+      // The pool shrank during the read. The fetches that waited for the page read it themselves.
+      page_table_.Erase(page_id);
+      RetireFrame(frame_id);
+      read_done_cv_.notify_all();
+      continue;
+    }
+    // The page is not recorded as accessed, it only counts once somebody fetches it.
+    read_ahead_marks_[frame_id] = sequential ? ReadAheadMark::SEQUENTIAL : ReadAheadMark::HINTED;
+    page->pin_count_ = 0;
+    replacer_->Unpin(frame_id);
+    read_done_cv_.notify_all();
+    metrics_.Add(BufferPoolMetrics::Counter::READ_AHEAD_PAGE);
+  }
+}
+
+void BufferPoolManager::RunBackgroundFlush() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (enable_bg_flush_) {
+    bg_flush_cv_.wait_for(lock, bg_flush_interval.load(), [&] { return !enable_bg_flush_ || bg_flush_requested_; });
+    // 0. Free the dirty victims a foreground search handed over, it waits for them. Nothing handed over is left
+    //    behind on shutdown.
+    //    A frame stays queued until it is free, so that a search never finds the pool full while it is written.
+    frame_id_t frame_id;
+    while (!evict_queue_.empty()) {
+      EvictHandedOverFrame(evict_queue_.front(), &lock);
+      evict_queue_.pop_front();
+    }
+    if (!enable_bg_flush_) {
+      break;
+    }
+    bg_flush_requested_ = false;
+    size_t budget = bg_flush_max_pages;
+
+    // 1. Retire the frames a shrink left pinned once they are no longer in use.
+    for (size_t i = pool_size_; i < max_pool_size_ && budget > 0; ++i) {
+      frame_id = static_cast<frame_id_t>(i);
+      if (!retired_[i] && pages_[i].page_id_ != INVALID_PAGE_ID && pages_[i].pin_count_ == 0) {
+        budget -= pages_[i].is_dirty_ ? 1 : 0;
+        TryRetireFrame(frame_id, &lock);
+      }
+    }
+
+    // 2. Keep a reserve of clean frames on the free list, so that FetchPage/NewPage can take a frame without writing
+    //    anything back. Victims come from the replacer, dirty ones are written back first.
+    while (free_list_.size() < bg_free_frames && budget > 0 && replacer_->Victim(&frame_id)) {
+      Page *page = &pages_[frame_id];
+      if (!ClaimFrame(page)) {
+        // Pinned, whoever drops the last pin puts it back into the replacer.
+        continue;
+      }
+      if (page->is_dirty_) {
+        // Give up the claim for the write, WriteBack pins the frame instead.
+        page->pin_count_ = 0;
+        WriteBack(frame_id, &lock);
+        budget--;
+        if (!ClaimFrame(page)) {
+          // Somebody fetched the page while it was being written, it is no longer a victim.
+          continue;
+        }
+        // Dropping the write's pin put the frame back into the replacer.
+        replacer_->Pin(frame_id);
+        if (page->is_dirty_) {
+          page->pin_count_ = 0;
+          replacer_->Unpin(frame_id);
+          continue;
+        }
+      }
+      KeepCompressed(page);
+      page_table_.Erase(page->page_id_);
+      page->page_id_ = INVALID_PAGE_ID;
+      FreeFrame(frame_id);
+      metrics_.Add(BufferPoolMetrics::Counter::EVICTION);
+    }
+
+    // 3. Write back unpinned dirty pages while the dirty ratio is above the threshold. The pages stay cached.
+    size_t num_dirty = 0;
+    for (size_t i = 0; i < max_pool_size_; ++i) {
+      num_dirty += pages_[i].is_dirty_ ? 1 : 0;
+    }
+    auto max_dirty = static_cast<size_t>(bg_dirty_ratio * pool_size_.load());
+    for (size_t i = 0; i < max_pool_size_ && num_dirty > max_dirty && budget > 0; ++i) {
+      frame_id = static_cast<frame_id_t>(bg_flush_cursor_);
+      bg_flush_cursor_ = (bg_flush_cursor_ + 1) % max_pool_size_;
+      Page *page = &pages_[frame_id];
+      if (!page->is_dirty_ || page->pin_count_ != 0) {
+        continue;
+      }
+      WriteBack(frame_id, &lock);
+      budget--;
+      num_dirty--;
+    }
+
+    // 4. Compress the pages evicted since the last round for the compressed cache, a fetch meanwhile finds them
+    //    staged.
+    if (compressed_cache_.IsEnabled()) {
+      lock.unlock();
+      compressed_cache_.Compress();
+      lock.lock();
+    }
+  }
 }
 
 }  // namespace bustub
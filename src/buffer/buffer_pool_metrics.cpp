@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_metrics.cpp
+//
+// Identification: src/buffer/buffer_pool_metrics.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "buffer/buffer_pool_metrics.h"
+
+namespace bustub {
+
+size_t LatencyHistogram::BucketOf(uint64_t value) {
+  if (value < 2 * SUB_BUCKETS) {
+    return static_cast<size_t>(value);
+  }
+  // The top SUB_BUCKET_BITS + 1 bits of the value pick the bucket, the rest is the precision given up.
+  auto shift = static_cast<size_t>(63 - __builtin_clzll(value)) - SUB_BUCKET_BITS;
+  return (shift + 1) * SUB_BUCKETS + static_cast<size_t>(value >> shift) - SUB_BUCKETS;
+}
+
+uint64_t LatencyHistogram::BucketLowerBound(size_t bucket) {
+  if (bucket < 2 * SUB_BUCKETS) {
+    return bucket;
+  }
+  size_t shift = bucket / SUB_BUCKETS - 1;
+  return static_cast<uint64_t>(SUB_BUCKETS + bucket % SUB_BUCKETS) << shift;
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t bucket) {
+  return bucket + 1 == NUM_BUCKETS ? UINT64_MAX : BucketLowerBound(bucket + 1) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value) {
+  counts_[BucketOf(value)]++;
+  count_++;
+  sum_ += value;
+  max_ = std::max(max_, value);
+}
+
+void LatencyHistogram::Merge(const LatencyHistogram &other) {
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    counts_[i] += other.counts_[i];
+  }
+  count_ += other.count_;
+  sum_ += other.sum_;
+  max_ = std::max(max_, other.max_);
+}
+
+uint64_t LatencyHistogram::GetPercentile(double percentile) const {
+  if (count_ == 0) {
+    return 0;
+  }
+  // The rank of the percentile, counting from 1, so that the 0th percentile is the smallest value.
+  auto rank = std::max<uint64_t>(1, static_cast<uint64_t>(percentile / 100 * static_cast<double>(count_) + 0.5));
+  uint64_t seen = 0;
+  for (size_t i = 0; i < NUM_BUCKETS; ++i) {
+    seen += counts_[i];
+    if (seen >= rank) {
+      return std::min(BucketUpperBound(i), max_);
+    }
+  }
+  return max_;
+}
+
+void BufferPoolStats::Merge(const BufferPoolStats &other) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  evictions_ += other.evictions_;
+  dirty_write_backs_ += other.dirty_write_backs_;
+  pin_waits_ += other.pin_waits_;
+  read_ahead_pages_ += other.read_ahead_pages_;
+  free_frames_ += other.free_frames_;
+  arc_target_ += other.arc_target_;
+  arc_b1_hits_ += other.arc_b1_hits_;
+  arc_b2_hits_ += other.arc_b2_hits_;
+  miss_latency_.Merge(other.miss_latency_);
+}
+
+void BufferPoolMetrics::RecordMissLatency(uint64_t nanoseconds) {
+  Shard *shard = LocalShard();
+  shard->miss_latency_counts_[LatencyHistogram::BucketOf(nanoseconds)].fetch_add(1, std::memory_order_relaxed);
+  shard->miss_latency_sum_.fetch_add(nanoseconds, std::memory_order_relaxed);
+  // Only the threads sharing this shard race on the maximum, and the value rarely changes.
+  uint64_t max = shard->miss_latency_max_.load(std::memory_order_relaxed);
+  while (nanoseconds > max && !shard->miss_latency_max_.compare_exchange_weak(max, nanoseconds)) {
+  }
+}
+
+void BufferPoolMetrics::GetStats(BufferPoolStats *stats) const {
+  std::array<uint64_t, static_cast<size_t>(Counter::NUM_COUNTERS)> counters{};
+  LatencyHistogram miss_latency;
+  for (const auto &shard : shards_) {
+    for (size_t i = 0; i < counters.size(); ++i) {
+      counters[i] += shard.counters_[i].load(std::memory_order_relaxed);
+    }
+    for (size_t i = 0; i < LatencyHistogram::NUM_BUCKETS; ++i) {
+      uint64_t count = shard.miss_latency_counts_[i].load(std::memory_order_relaxed);
+      miss_latency.counts_[i] += count;
+      miss_latency.count_ += count;
+    }
+    miss_latency.sum_ += shard.miss_latency_sum_.load(std::memory_order_relaxed);
+    miss_latency.max_ = std::max(miss_latency.max_, shard.miss_latency_max_.load(std::memory_order_relaxed));
+  }
+  stats->hits_ = counters[static_cast<size_t>(Counter::HIT)];
+  stats->misses_ = counters[static_cast<size_t>(Counter::MISS)];
+  stats->evictions_ = counters[static_cast<size_t>(Counter::EVICTION)];
+  stats->dirty_write_backs_ = counters[static_cast<size_t>(Counter::DIRTY_WRITE_BACK)];
+  stats->pin_waits_ = counters[static_cast<size_t>(Counter::PIN_WAIT)];
+  stats->read_ahead_pages_ = counters[static_cast<size_t>(Counter::READ_AHEAD_PAGE)];
+  stats->miss_latency_ = miss_latency;
+}
+
+void BufferPoolMetrics::Reset() {
+  for (auto &shard : shards_) {
+    for (auto &counter : shard.counters_) {
+      counter.exchange(0, std::memory_order_relaxed);
+    }
+    for (auto &count : shard.miss_latency_counts_) {
+      count.exchange(0, std::memory_order_relaxed);
+    }
+    shard.miss_latency_sum_.exchange(0, std::memory_order_relaxed);
+    shard.miss_latency_max_.exchange(0, std::memory_order_relaxed);
+  }
+}
+
+BufferPoolMetrics::Shard *BufferPoolMetrics::LocalShard() {
+  // Threads get consecutive shard indexes in the order they first record something, in any pool.
+  static std::atomic<size_t> next_shard{0};
+  static thread_local size_t shard = next_shard.fetch_add(1, std::memory_order_relaxed) % NUM_SHARDS;
+  return &shards_[shard];
+}
+
+}  // namespace bustub
@@ -10,20 +10,57 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+
 #include "buffer/clock_replacer.h"
+#include "common/logger.h"
 
 namespace bustub {
 
-ClockReplacer::ClockReplacer(size_t num_pages) {}
+ClockReplacer::ClockReplacer(size_t num_pages)
+    : num_pages_(num_pages), states_(new std::atomic<uint8_t>[num_pages]) {
+  for (size_t i = 0; i < num_pages_; ++i) {
+    states_[i].store(0, std::memory_order_relaxed);
+  }
+}
 
 ClockReplacer::~ClockReplacer() = default;
 
-bool ClockReplacer::Victim(frame_id_t *frame_id) { return false; }
+bool ClockReplacer::Victim(frame_id_t *frame_id) {
+  CHECK(frame_id) << "Expected output frame_id is not nullptr.";
+  // Two full sweeps are enough to clear every reference bit and come back to an
+  // evictable frame, unless concurrent Unpins keep setting them again.
+  while (size_.load() > 0) {
+    size_t pos = hand_.fetch_add(1) % num_pages_;
+    uint8_t state = states_[pos].load();
+    if ((state & EVICTABLE) != 0) {
+      if ((state & REFERENCED) != 0) {
+        // Give it a second chance.
+        states_[pos].compare_exchange_strong(state, EVICTABLE);
+      } else if (states_[pos].compare_exchange_strong(state, 0)) {
+        size_.fetch_sub(1);
+        *frame_id = static_cast<frame_id_t>(pos);
+        return true;
+      }
+    }
+  }
+  return false;
+}
 
-void ClockReplacer::Pin(frame_id_t frame_id) {}
+void ClockReplacer::Pin(frame_id_t frame_id) {
+  CHECK(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_) << "Frame id out of range: " << frame_id;
+  if ((states_[frame_id].exchange(0) & EVICTABLE) != 0) {
+    size_.fetch_sub(1);
+  }
+}
 
-void ClockReplacer::Unpin(frame_id_t frame_id) {}
+void ClockReplacer::Unpin(frame_id_t frame_id) {
+  CHECK(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_) << "Frame id out of range: " << frame_id;
+  if ((states_[frame_id].exchange(EVICTABLE | REFERENCED) & EVICTABLE) == 0) {
+    size_.fetch_add(1);
+  }
+}
 
-size_t ClockReplacer::Size() { return 0; }
+size_t ClockReplacer::Size() { return static_cast<size_t>(std::max<int64_t>(size_.load(), 0)); }
 
 }  // namespace bustub
@@ -0,0 +1,191 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.cpp
+//
+// Identification: src/buffer/compressed_page_cache.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstring>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "buffer/compressed_page_cache.h"
+#include "common/logger.h"
+#include "common/util/lz_codec.h"
+
+namespace bustub {
+
+void CompressedCacheStats::Merge(const CompressedCacheStats &other) {
+  hits_ += other.hits_;
+  misses_ += other.misses_;
+  inserts_ += other.inserts_;
+  rejects_ += other.rejects_;
+  evictions_ += other.evictions_;
+  pages_ += other.pages_;
+  staged_ += other.staged_;
+  memory_used_ += other.memory_used_;
+  capacity_ += other.capacity_;
+}
+
+CompressedPageCache::CompressedPageCache(size_t capacity) : capacity_(capacity) {}
+
+bool CompressedPageCache::Insert(page_id_t page_id, const char *page_data) {
+  if (!IsEnabled()) {
+    return false;
+  }
+  size_t size;
+  std::unique_ptr<char[]> data = CompressPage(page_data, &size);
+  std::lock_guard<std::mutex> guard(latch_);
+  staged_.erase(page_id);
+  return InsertEntry(page_id, size, std::move(data));
+}
+
+bool CompressedPageCache::Stage(page_id_t page_id, const char *page_data) {
+  if (!IsEnabled()) {
+    return false;
+  }
+  std::shared_ptr<char[]> data(new char[PAGE_SIZE]);
+  memcpy(data.get(), page_data, PAGE_SIZE);
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+  if (staged_.size() >= MAX_STAGED_PAGES && staged_.count(page_id) == 0) {
+    stats_.rejects_++;
+    return false;
+  }
+  staged_[page_id] = StagedPage{std::move(data), false};
+  return true;
+}
+
+void CompressedPageCache::Compress() {
+  if (!IsEnabled()) {
+    return;
+  }
+  std::vector<std::pair<page_id_t, std::shared_ptr<char[]>>> staged;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    for (auto &[page_id, staged_page] : staged_) {
+      if (!staged_page.compressing_) {
+        staged_page.compressing_ = true;
+        staged.emplace_back(page_id, staged_page.data_);
+      }
+    }
+  }
+  // The copies stay staged during the compression, so that lookups still find them.
+  for (auto &[page_id, plain] : staged) {
+    size_t size;
+    std::unique_ptr<char[]> data = CompressPage(plain.get(), &size);
+    std::lock_guard<std::mutex> guard(latch_);
+    auto it = staged_.find(page_id);
+    if (it == staged_.end() || it->second.data_ != plain) {
+      continue;
+    }
+    staged_.erase(it);
+    InsertEntry(page_id, size, std::move(data));
+  }
+}
+
+std::unique_ptr<char[]> CompressedPageCache::CompressPage(const char *page_data, size_t *size) {
+  // A page that does not fit into MAX_ENTRY_SIZE byte fails to compress.
+  char buffer[MAX_ENTRY_SIZE];
+  *size = LZCodec::Compress(page_data, PAGE_SIZE, buffer, MAX_ENTRY_SIZE);
+  std::unique_ptr<char[]> data;
+  if (*size != 0) {
+    data.reset(new char[*size]);
+    memcpy(data.get(), buffer, *size);
+  }
+  return data;
+}
+
+bool CompressedPageCache::InsertEntry(page_id_t page_id, size_t size, std::unique_ptr<char[]> data) {
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+  if (size == 0 || size + ENTRY_OVERHEAD > capacity_) {
+    stats_.rejects_++;
+    return false;
+  }
+  while (memory_used_ + size + ENTRY_OVERHEAD > capacity_) {
+    EraseEntry(entries_.begin());
+    stats_.evictions_++;
+  }
+  entries_.push_back(Entry{page_id, size, std::move(data)});
+  index_[page_id] = std::prev(entries_.end());
+  memory_used_ += size + ENTRY_OVERHEAD;
+  stats_.inserts_++;
+  return true;
+}
+
+bool CompressedPageCache::Lookup(page_id_t page_id, char *page_data) {
+  if (!IsEnabled()) {
+    return false;
+  }
+  Entry entry;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto staged = staged_.find(page_id);
+    if (staged != staged_.end()) {
+      memcpy(page_data, staged->second.data_.get(), PAGE_SIZE);
+      staged_.erase(staged);
+      stats_.hits_++;
+      return true;
+    }
+    auto it = index_.find(page_id);
+    if (it == index_.end()) {
+      stats_.misses_++;
+      return false;
+    }
+    entry = std::move(*it->second);
+    memory_used_ -= entry.size_ + ENTRY_OVERHEAD;
+    entries_.erase(it->second);
+    index_.erase(it);
+    stats_.hits_++;
+  }
+  size_t size = LZCodec::Decompress(entry.data_.get(), entry.size_, page_data, PAGE_SIZE);
+  CHECK(size == static_cast<size_t>(PAGE_SIZE)) << "Corrupt compressed copy of page " << page_id;
+  return true;
+}
+
+void CompressedPageCache::Erase(page_id_t page_id) {
+  if (!IsEnabled()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  staged_.erase(page_id);
+  auto it = index_.find(page_id);
+  if (it != index_.end()) {
+    EraseEntry(it->second);
+  }
+}
+
+CompressedCacheStats CompressedPageCache::GetStats() {
+  std::lock_guard<std::mutex> guard(latch_);
+  CompressedCacheStats stats = stats_;
+  stats.pages_ = entries_.size();
+  stats.staged_ = staged_.size();
+  stats.memory_used_ = memory_used_;
+  stats.capacity_ = capacity_;
+  return stats;
+}
+
+void CompressedPageCache::ResetStats() {
+  std::lock_guard<std::mutex> guard(latch_);
+  stats_ = CompressedCacheStats();
+}
+
+void CompressedPageCache::EraseEntry(std::list<Entry>::iterator entry) {
+  memory_used_ -= entry->size_ + ENTRY_OVERHEAD;
+  index_.erase(entry->page_id_);
+  entries_.erase(entry);
+}
+
+}  // namespace bustub
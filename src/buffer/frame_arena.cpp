@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.cpp
+//
+// Identification: src/buffer/frame_arena.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/mman.h>
+
+#include "buffer/frame_arena.h"
+#include "common/exception.h"
+
+namespace bustub {
+
+static_assert(PAGE_SIZE % 4096 == 0, "Frames must stay aligned to the OS page size.");
+
+FrameArena::FrameArena(size_t num_frames, bool resizable) {
+  size_ = num_frames * PAGE_SIZE;
+  if (size_ == 0) {
+    return;
+  }
+  void *data = MAP_FAILED;
+#ifdef MAP_HUGETLB
+  if (!resizable && size_ >= HUGE_PAGE_SIZE) {
+    size_t huge_size = (size_ + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    data = mmap(nullptr, huge_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+    if (data != MAP_FAILED) {
+      size_ = huge_size;
+      huge_tlb_ = true;
+    }
+  }
+#endif
+  if (data == MAP_FAILED) {
+    int flags = MAP_PRIVATE | MAP_ANONYMOUS | (resizable ? MAP_NORESERVE : 0);
+    data = mmap(nullptr, size_, PROT_READ | PROT_WRITE, flags, -1, 0);
+    if (data == MAP_FAILED) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "Cannot map the buffer pool frames.");
+    }
+#ifdef MADV_HUGEPAGE
+    if (size_ >= HUGE_PAGE_SIZE) {
+      // Only a hint, the kernel may have transparent huge pages disabled.
+      madvise(data, size_, MADV_HUGEPAGE);
+    }
+#endif
+  }
+  data_ = static_cast<char *>(data);
+}
+
+void FrameArena::Release(frame_id_t frame_id, size_t num_frames) {
+  if (huge_tlb_ || num_frames == 0) {
+    return;
+  }
+  // Only a hint as well, the frames keep their content if the kernel declines.
+  madvise(GetFrame(frame_id), num_frames * PAGE_SIZE, MADV_DONTNEED);
+}
+
+FrameArena::~FrameArena() {
+  if (data_ != nullptr) {
+    munmap(data_, size_);
+  }
+}
+
+}  // namespace bustub
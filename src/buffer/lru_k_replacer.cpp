@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.cpp
+//
+// Identification: src/buffer/lru_k_replacer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/lru_k_replacer.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+LRUKReplacer::LRUKReplacer(size_t num_pages, size_t k, size_t correlated_period)
+    : num_pages_(num_pages), k_(k), correlated_period_(correlated_period), frames_(num_pages) {
+  CHECK(k_ > 0) << "Expected k greater than 0.";
+}
+
+LRUKReplacer::~LRUKReplacer() = default;
+
+LRUKReplacer::Key LRUKReplacer::MakeKey(frame_id_t frame_id) const {
+  const FrameInfo &info = frames_[frame_id];
+  // A burst still going on is ranked as if it ended now, otherwise a page referenced without a pause would look as
+  // old as its first reference.
+  uint64_t oldest = info.history_.empty() ? 0 : info.history_.front() + (info.last_ - info.history_.back());
+  return Key(info.history_.size() >= k_, oldest, frame_id);
+}
+
+bool LRUKReplacer::Victim(frame_id_t *frame_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  if (evictable_.empty()) {
+    return false;
+  }
+  CHECK(frame_id) << "Expected output frame_id is not nullptr.";
+  *frame_id = std::get<2>(*evictable_.begin());
+  evictable_.erase(evictable_.begin());
+  // The frame will hold another page, its history goes with the evicted one.
+  frames_[*frame_id] = FrameInfo();
+  return true;
+}
+
+void LRUKReplacer::RecordAccess(frame_id_t frame_id, page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  CHECK(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_) << "Frame id out of range: " << frame_id;
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    evictable_.erase(MakeKey(frame_id));
+  }
+  if (info.page_id_ != page_id) {
+    // A new page in this frame, e.g. reused from the free list.
+    info.page_id_ = page_id;
+    info.history_.clear();
+  }
+  uint64_t now = ++current_timestamp_;
+  if (info.history_.empty()) {
+    info.history_.push_back(now);
+  } else if (now - info.last_ > correlated_period_) {
+    // An uncorrelated reference: the older references move forward by the length
+    // of the correlated burst that just ended, so that it counts as one reference.
+    uint64_t burst = info.last_ - info.history_.back();
+    for (auto &time : info.history_) {
+      time += burst;
+    }
+    info.history_.push_back(now);
+    if (info.history_.size() > k_) {
+      info.history_.pop_front();
+    }
+  }
+  info.last_ = now;
+  if (info.evictable_) {
+    evictable_.insert(MakeKey(frame_id));
+  }
+}
+
+void LRUKReplacer::Pin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  CHECK(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_) << "Frame id out of range: " << frame_id;
+  FrameInfo &info = frames_[frame_id];
+  if (info.evictable_) {
+    evictable_.erase(MakeKey(frame_id));
+    info.evictable_ = false;
+  }
+}
+
+void LRUKReplacer::Unpin(frame_id_t frame_id) {
+  std::lock_guard<std::mutex> guard(mutex_);
+  CHECK(frame_id >= 0 && static_cast<size_t>(frame_id) < num_pages_) << "Frame id out of range: " << frame_id;
+  FrameInfo &info = frames_[frame_id];
+  if (!info.evictable_) {
+    info.evictable_ = true;
+    evictable_.insert(MakeKey(frame_id));
+  }
+}
+
+size_t LRUKReplacer::Size() {
+  std::lock_guard<std::mutex> guard(mutex_);
+  return evictable_.size();
+}
+
+}  // namespace bustub
@@ -0,0 +1,118 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.cpp
+//
+// Identification: src/buffer/page_table.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/page_table.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+PageTable::PageTable(size_t num_frames) : capacity_(2), shift_(1) {
+  CHECK(num_frames <= FRAME_ID_MASK) << "Too many frames for the page table: " << num_frames;
+  while (capacity_ < 2 * num_frames) {
+    capacity_ <<= 1;
+    shift_++;
+  }
+  slots_.reset(new std::atomic<uint64_t>[capacity_]);
+  for (size_t i = 0; i < capacity_; ++i) {
+    slots_[i].store(EMPTY, std::memory_order_relaxed);
+  }
+}
+
+size_t PageTable::Home(page_id_t page_id) const {
+  // Fibonacci hashing, the high bits of the product are well mixed even for consecutive page ids.
+  return static_cast<size_t>((static_cast<uint64_t>(page_id) * 0x9E3779B97F4A7C15ULL) >>
+                             (64 - shift_));
+}
+
+size_t PageTable::Probe(page_id_t page_id) const {
+  size_t pos = Home(page_id);
+  // The bound only matters for a reader racing with a writer, a consistent table always has an empty slot.
+  for (size_t i = 0; i < capacity_; ++i) {
+    uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      return capacity_;
+    }
+    if (PageOf(slot) == page_id) {
+      return pos;
+    }
+    pos = (pos + 1) & (capacity_ - 1);
+  }
+  return capacity_;
+}
+
+bool PageTable::Find(page_id_t page_id, frame_id_t *frame_id) const {
+  while (true) {
+    uint64_t version = version_.load(std::memory_order_acquire);
+    if ((version & 1) != 0) {
+      // A writer is in the middle of a change, it only holds the table for a few stores.
+      continue;
+    }
+    size_t pos = Probe(page_id);
+    uint64_t slot = pos == capacity_ ? EMPTY : slots_[pos].load(std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (version_.load(std::memory_order_relaxed) != version) {
+      continue;
+    }
+    if (slot == EMPTY) {
+      return false;
+    }
+    *frame_id = FrameOf(slot);
+    return true;
+  }
+}
+
+void PageTable::Insert(page_id_t page_id, frame_id_t frame_id) {
+  CHECK(page_id >= 0) << "Expected page id greater or equal to 0: " << page_id;
+  CHECK(page_id < (page_id_t{1} << PAGE_ID_BITS)) << "Page id too large for the page table: " << page_id;
+  CHECK(2 * (size_ + 1) <= capacity_) << "Page table is full.";
+  size_t pos = Home(page_id);
+  while (slots_[pos].load(std::memory_order_relaxed) != EMPTY) {
+    CHECK(PageOf(slots_[pos].load(std::memory_order_relaxed)) != page_id) << "Page already in table: " << page_id;
+    pos = (pos + 1) & (capacity_ - 1);
+  }
+  version_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  slots_[pos].store(Pack(page_id, frame_id), std::memory_order_relaxed);
+  version_.fetch_add(1, std::memory_order_release);
+  size_++;
+}
+
+bool PageTable::Erase(page_id_t page_id) {
+  size_t hole = Probe(page_id);
+  if (hole == capacity_) {
+    return false;
+  }
+  version_.fetch_add(1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  // Backward shift deletion: move every following entry of the cluster whose home is not in (hole, pos] into the
+  // hole, so that no probe ever has to step over a deleted slot.
+  size_t pos = hole;
+  while (true) {
+    pos = (pos + 1) & (capacity_ - 1);
+    uint64_t slot = slots_[pos].load(std::memory_order_relaxed);
+    if (slot == EMPTY) {
+      break;
+    }
+    size_t home = Home(PageOf(slot));
+    bool stays = hole < pos ? (hole < home && home <= pos) : (hole < home || home <= pos);
+    if (!stays) {
+      slots_[hole].store(slot, std::memory_order_relaxed);
+      hole = pos;
+    }
+  }
+  slots_[hole].store(EMPTY, std::memory_order_relaxed);
+  version_.fetch_add(1, std::memory_order_release);
+  size_--;
+  return true;
+}
+
+}  // namespace bustub
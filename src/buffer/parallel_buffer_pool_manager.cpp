@@ -0,0 +1,168 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.cpp
+//
+// Identification: src/buffer/parallel_buffer_pool_manager.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/logger.h"
+
+namespace bustub {
+
+ParallelBufferPoolManager::ParallelBufferPoolManager(size_t num_instances, size_t pool_size,
+                                                     DiskManager *disk_manager, LogManager *log_manager,
+                                                     ReplacerType replacer_type, size_t max_pool_size)
+    : BufferPoolManager(0, static_cast<uint32_t>(num_instances), 0, disk_manager, log_manager) {
+  // The base part owns no frames, every page lives in one of the num_instances_ instances. The instances share one
+  // disk scheduler, so that consecutive pages, which live in different instances, are merged into one I/O.
+  disk_scheduler_ = new DiskScheduler(disk_manager, std::max<size_t>(disk_scheduler_workers, 1));
+  owns_disk_scheduler_ = true;
+  for (size_t i = 0; i < num_instances_; ++i) {
+    instances_.emplace_back(new BufferPoolManager(pool_size, num_instances_, static_cast<uint32_t>(i), disk_manager,
+                                                  log_manager, replacer_type, max_pool_size, disk_scheduler_));
+  }
+}
+
+ParallelBufferPoolManager::~ParallelBufferPoolManager() {
+  for (auto *instance : instances_) {
+    delete instance;
+  }
+}
+
+size_t ParallelBufferPoolManager::GetPoolSize() {
+  size_t pool_size = 0;
+  for (auto *instance : instances_) {
+    pool_size += instance->GetPoolSize();
+  }
+  return pool_size;
+}
+
+size_t ParallelBufferPoolManager::GetMaxPoolSize() {
+  size_t max_pool_size = 0;
+  for (auto *instance : instances_) {
+    max_pool_size += instance->GetMaxPoolSize();
+  }
+  return max_pool_size;
+}
+
+bool ParallelBufferPoolManager::Resize(size_t pool_size) {
+  if (pool_size < num_instances_ || pool_size > GetMaxPoolSize()) {
+    return false;
+  }
+  // The first pool_size % num_instances_ instances get one frame more. Every instance is resized even if an earlier
+  // one could not shrink completely.
+  bool resized = true;
+  for (size_t i = 0; i < num_instances_; ++i) {
+    size_t instance_pool_size = pool_size / num_instances_ + (i < pool_size % num_instances_ ? 1 : 0);
+    resized = instances_[i]->Resize(instance_pool_size) && resized;
+  }
+  return resized;
+}
+
+BufferPoolManager *ParallelBufferPoolManager::GetBufferPoolManager(page_id_t page_id) {
+  CHECK(page_id >= 0) << "Expected page id greater or equal to 0: " << page_id;
+  return instances_[static_cast<size_t>(page_id) % num_instances_];
+}
+
+Page *ParallelBufferPoolManager::FetchPageImpl(page_id_t page_id) { return FetchPageWithStrategy(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) {
+  BufferPoolManager *instance = GetBufferPoolManager(page_id);
+  return strategy == nullptr ? instance->FetchPage(page_id) : instance->FetchPage(page_id, *strategy);
+}
+
+bool ParallelBufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
+  return GetBufferPoolManager(page_id)->UnpinPage(page_id, is_dirty);
+}
+
+bool ParallelBufferPoolManager::FlushPageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->FlushPage(page_id);
+}
+
+Page *ParallelBufferPoolManager::NewPageImpl(page_id_t *page_id) { return NewPageWithStrategy(page_id, nullptr); }
+
+Page *ParallelBufferPoolManager::NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  // Rotate the starting instance on every call, then probe each instance once until one of them has a frame.
+  size_t start = next_instance_.fetch_add(1) % num_instances_;
+  for (size_t i = 0; i < num_instances_; ++i) {
+    BufferPoolManager *instance = instances_[(start + i) % num_instances_];
+    Page *page = strategy == nullptr ? instance->NewPage(page_id) : instance->NewPage(page_id, *strategy);
+    if (page != nullptr) {
+      return page;
+    }
+  }
+  *page_id = INVALID_PAGE_ID;
+  return nullptr;
+}
+
+bool ParallelBufferPoolManager::DeletePageImpl(page_id_t page_id) {
+  return GetBufferPoolManager(page_id)->DeletePage(page_id);
+}
+
+void ParallelBufferPoolManager::FlushAllPagesImpl() {
+  // Flush all instances together: page ids are striped across them, so only the union has runs of consecutive pages.
+  FlushDirtyPages(instances_);
+}
+
+bool ParallelBufferPoolManager::FetchPages(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) {
+  pages->assign(page_ids.size(), nullptr);
+  // Split the batch by instance, remembering where every page goes in the result.
+  std::vector<std::vector<page_id_t>> instance_page_ids(num_instances_);
+  std::vector<std::vector<size_t>> instance_indexes(num_instances_);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    CHECK(page_ids[i] >= 0) << "Expected page id greater or equal to 0: " << page_ids[i];
+    size_t instance = static_cast<size_t>(page_ids[i]) % num_instances_;
+    instance_page_ids[instance].push_back(page_ids[i]);
+    instance_indexes[instance].push_back(i);
+  }
+  bool fetched_all = true;
+  std::vector<Page *> instance_pages;
+  for (size_t instance = 0; instance < num_instances_; ++instance) {
+    if (instance_page_ids[instance].empty()) {
+      continue;
+    }
+    fetched_all = instances_[instance]->FetchPages(instance_page_ids[instance], &instance_pages) && fetched_all;
+    for (size_t j = 0; j < instance_pages.size(); ++j) {
+      (*pages)[instance_indexes[instance][j]] = instance_pages[j];
+    }
+  }
+  return fetched_all;
+}
+
+void ParallelBufferPoolManager::PrefetchPage(page_id_t page_id) {
+  if (page_id != INVALID_PAGE_ID) {
+    GetBufferPoolManager(page_id)->PrefetchPage(page_id);
+  }
+}
+
+BufferPoolStats ParallelBufferPoolManager::GetStats() {
+  BufferPoolStats stats;
+  for (auto *instance : instances_) {
+    stats.Merge(instance->GetStats());
+  }
+  return stats;
+}
+
+CompressedCacheStats ParallelBufferPoolManager::GetCompressedCacheStats() {
+  CompressedCacheStats stats;
+  for (auto *instance : instances_) {
+    stats.Merge(instance->GetCompressedCacheStats());
+  }
+  return stats;
+}
+
+void ParallelBufferPoolManager::ResetStats() {
+  for (auto *instance : instances_) {
+    instance->ResetStats();
+  }
+}
+
+}  // namespace bustub
@@ -48,6 +48,8 @@ std::vector<Value> TableGenerator::MakeValues(ColumnInsertMeta *col_meta, uint32
 void TableGenerator::FillTable(TableMetadata *info, TableInsertMeta *table_meta) {
   uint32_t num_inserted = 0;
   uint32_t batch_size = 128;
+  // Keep the load in a small ring of frames, so that it does not evict the pages cached for other work.
+  BufferAccessStrategy strategy;
   while (num_inserted < table_meta->num_rows_) {
     std::vector<std::vector<Value>> values;
     uint32_t num_values = std::min(batch_size, table_meta->num_rows_ - num_inserted);
@@ -61,7 +63,8 @@ void TableGenerator::FillTable(TableMetadata *info, TableInsertMeta *table_meta)
         entry.emplace_back(col[i]);
       }
       RID rid;
-      bool inserted = info->table_->InsertTuple(Tuple(entry, &info->schema_), &rid, exec_ctx_->GetTransaction());
+      bool inserted =
+          info->table_->InsertTuple(Tuple(entry, &info->schema_), &rid, exec_ctx_->GetTransaction(), &strategy);
       BUSTUB_ASSERT(inserted, "Sequential insertion cannot fail");
       num_inserted++;
     }
@@ -70,7 +73,7 @@ void TableGenerator::FillTable(TableMetadata *info, TableInsertMeta *table_meta)
   LOG_INFO("Wrote %d tuples to table %s.", num_inserted, table_meta->name_);
 }
 
-void TableGenerator::GenerateTestTables() {
+void TableGenerator::GenerateTestTables(bool compressed) {
   /**
    * This array configures each of the test tables. Each table is configured
    * with a name, size, and schema. We also configure the columns of the table.
@@ -127,7 +130,8 @@ void TableGenerator::GenerateTestTables() {
       }
     }
     Schema schema(cols);
-    auto info = exec_ctx_->GetCatalog()->CreateTable(exec_ctx_->GetTransaction(), table_meta.name_, schema);
+    auto info =
+        exec_ctx_->GetCatalog()->CreateTable(exec_ctx_->GetTransaction(), table_meta.name_, schema, compressed);
     FillTable(info, &table_meta);
   }
 }
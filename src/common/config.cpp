@@ -20,4 +20,28 @@ std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+std::atomic<std::chrono::milliseconds> bg_flush_interval(std::chrono::milliseconds(50));
+
+std::atomic<size_t> bg_flush_max_pages(64);
+
+std::atomic<double> bg_dirty_ratio(0.5);
+
+std::atomic<size_t> bg_free_frames(4);
+
+std::atomic<size_t> read_ahead_depth(8);
+
+std::atomic<size_t> lru_k_replacer_k(LRUK_REPLACER_K);
+
+std::atomic<size_t> lru_k_correlated_period(4);
+
+std::atomic<size_t> flush_io_threads(1);
+
+std::atomic<size_t> disk_scheduler_workers(4);
+
+std::atomic<size_t> db_extent_size(64 * 1024 * 1024);
+
+std::atomic<size_t> compressed_cache_size(0);
+
+std::atomic<bool> enable_io_uring(true);
+
 }  // namespace bustub
@@ -0,0 +1,183 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec.cpp
+//
+// Identification: src/common/util/lz_codec.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "common/util/lz_codec.h"
+
+namespace bustub {
+
+// The hash table of 4-byte prefixes has 1 << HASH_BITS entries.
+static constexpr int HASH_BITS = 12;
+
+// A match reaches back at most this far.
+static constexpr size_t MAX_OFFSET = 65535;
+
+static inline uint32_t Load32(const char *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
+static inline uint32_t HashPrefix(uint32_t v) { return (v * 2654435761U) >> (32 - HASH_BITS); }
+
+/**
+ * Appends a nibble's overflow of a length as length bytes
+ * @return false if the output is full
+ */
+static inline bool PutLength(size_t length, char **op, const char *end) {
+  for (; length >= 255; length -= 255) {
+    if (*op == end) {
+      return false;
+    }
+    *(*op)++ = static_cast<char>(255);
+  }
+  if (*op == end) {
+    return false;
+  }
+  *(*op)++ = static_cast<char>(length);
+  return true;
+}
+
+/**
+ * Appends a sequence, literal_length literals from literals followed by a match unless match_length is 0
+ * @return false if the output is full
+ */
+static bool PutSequence(const char *literals, size_t literal_length, size_t offset, size_t match_length, char **op,
+                        const char *end) {
+  if (*op == end) {
+    return false;
+  }
+  char *token = (*op)++;
+  size_t match_code = match_length == 0 ? 0 : match_length - LZCodec::MIN_MATCH;
+  *token = static_cast<char>((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15));
+  if (literal_length >= 15 && !PutLength(literal_length - 15, op, end)) {
+    return false;
+  }
+  if (static_cast<size_t>(end - *op) < literal_length) {
+    return false;
+  }
+  memcpy(*op, literals, literal_length);
+  *op += literal_length;
+  if (match_length == 0) {
+    return true;
+  }
+  if (end - *op < 2) {
+    return false;
+  }
+  *(*op)++ = static_cast<char>(offset & 0xff);
+  *(*op)++ = static_cast<char>(offset >> 8);
+  return match_code < 15 || PutLength(match_code - 15, op, end);
+}
+
+size_t LZCodec::Compress(const char *src, size_t size, char *dst, size_t capacity) {
+  // Positions are kept plus one, so that 0 is an empty entry.
+  uint32_t table[1 << HASH_BITS] = {};
+  const char *end = dst + capacity;
+  char *op = dst;
+  size_t anchor = 0;
+  size_t pos = 0;
+  size_t misses = 0;
+  while (size >= MIN_MATCH && pos <= size - MIN_MATCH) {
+    uint32_t prefix = Load32(src + pos);
+    uint32_t &entry = table[HashPrefix(prefix)];
+    size_t candidate = entry;
+    entry = static_cast<uint32_t>(pos + 1);
+    if (candidate == 0 || pos - (candidate - 1) > MAX_OFFSET || Load32(src + candidate - 1) != prefix) {
+      // Runs of incompressible input are skipped over faster and faster.
+      pos += 1 + (misses++ >> 5);
+      continue;
+    }
+    misses = 0;
+    size_t match = candidate - 1;
+    size_t length = MIN_MATCH;
+    while (pos + length < size && src[match + length] == src[pos + length]) {
+      length++;
+    }
+    if (!PutSequence(src + anchor, pos - anchor, pos - match, length, &op, end)) {
+      return 0;
+    }
+    pos += length;
+    anchor = pos;
+  }
+  if (!PutSequence(src + anchor, size - anchor, 0, 0, &op, end)) {
+    return 0;
+  }
+  return op - dst;
+}
+
+/**
+ * Reads the length bytes continuing a nibble of 15
+ * @return false if the input ends first
+ */
+static inline bool GetLength(const unsigned char **ip, const unsigned char *end, size_t *length) {
+  unsigned char byte;
+  do {
+    if (*ip == end) {
+      return false;
+    }
+    byte = *(*ip)++;
+    *length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+size_t LZCodec::Decompress(const char *src, size_t size, char *dst, size_t capacity) {
+  const auto *ip = reinterpret_cast<const unsigned char *>(src);
+  const auto *end = ip + size;
+  size_t out = 0;
+  while (ip < end) {
+    unsigned char token = *ip++;
+    size_t literal_length = token >> 4;
+    if (literal_length == 15 && !GetLength(&ip, end, &literal_length)) {
+      return 0;
+    }
+    if (static_cast<size_t>(end - ip) < literal_length || capacity - out < literal_length) {
+      return 0;
+    }
+    memcpy(dst + out, ip, literal_length);
+    ip += literal_length;
+    out += literal_length;
+    if (ip == end) {
+      // The last sequence has no match.
+      break;
+    }
+    if (end - ip < 2) {
+      return 0;
+    }
+    size_t offset = ip[0] | (static_cast<size_t>(ip[1]) << 8);
+    ip += 2;
+    size_t match_length = token & 15;
+    if (match_length == 15 && !GetLength(&ip, end, &match_length)) {
+      return 0;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > out || capacity - out < match_length) {
+      return 0;
+    }
+    const char *match = dst + out - offset;
+    if (offset >= match_length) {
+      memcpy(dst + out, match, match_length);
+    } else {
+      // The match overlaps what it produces, e.g. a run of one byte.
+      for (size_t i = 0; i < match_length; ++i) {
+        dst[out + i] = match[i];
+      }
+    }
+    out += match_length;
+  }
+  return out;
+}
+
+}  // namespace bustub
@@ -19,7 +19,7 @@ SeqScanExecutor::SeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNod
 void SeqScanExecutor::Init() {
   auto table_id = plan_->GetTableOid();
   auto txn = GetExecutorContext()->GetTransaction();
-  it_ = GetExecutorContext()->GetCatalog()->GetTable(table_id)->table_->Begin(txn);
+  it_ = GetExecutorContext()->GetCatalog()->GetTable(table_id)->table_->Begin(txn, &strategy_);
 }
 
 bool SeqScanExecutor::Next(Tuple *tuple, RID *rid) {
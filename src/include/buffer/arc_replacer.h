@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer.h
+//
+// Identification: src/include/buffer/arc_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <list>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ARCReplacer implements the Adaptive Replacement Cache policy.
+ *
+ * Resident frames live in T1 (referenced once) or T2 (referenced at least twice),
+ * and the page ids of recently evicted pages are remembered in the ghost lists B1
+ * and B2. The target size p of T1 moves towards recency on a B1 ghost hit and
+ * towards frequency on a B2 ghost hit, so the split adapts to the workload.
+ *
+ * The buffer pool picks the victim before it knows the missing page, so REPLACE
+ * here cannot use the "page is in B2" tie-break of the original algorithm.
+ */
+class ARCReplacer : public Replacer {
+ public:
+  /**
+   * Create a new ARCReplacer.
+   * @param num_pages the maximum number of pages the ARCReplacer will be
+   * required to store
+   */
+  explicit ARCReplacer(size_t num_pages);
+
+  /**
+   * Destroys the ARCReplacer.
+   */
+  ~ARCReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Forget(page_id_t page_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+  /** @return the current target size of T1 */
+  size_t GetTarget();
+
+  /** @return the number of accesses that hit the B1 ghost list */
+  size_t GetB1Hits();
+
+  /** @return the number of accesses that hit the B2 ghost list */
+  size_t GetB2Hits();
+
+  /** Sets the ghost hit counters back to zero, the lists and the target stay. */
+  void ResetHits();
+
+ private:
+  enum class ListType { NONE, T1, T2, B1, B2 };
+
+  struct FrameInfo {
+    page_id_t page_id_{INVALID_PAGE_ID};
+    ListType list_{ListType::NONE};
+    std::list<frame_id_t>::iterator pos_;
+    bool evictable_{false};
+  };
+
+  struct GhostInfo {
+    ListType list_;
+    std::list<page_id_t>::iterator pos_;
+  };
+
+  /** Puts a frame at the MRU end of T1 or T2. */
+  void InsertResident(frame_id_t frame_id, ListType list);
+
+  /** Takes a frame out of T1 or T2. */
+  void RemoveResident(frame_id_t frame_id);
+
+  /** Remembers an evicted page at the MRU end of B1 or B2. */
+  void InsertGhost(page_id_t page_id, ListType list);
+
+  /** Forgets the LRU page of B1 or B2. */
+  void RemoveLRUGhost(ListType list);
+
+  /** @return the LRU evictable frame of T1 or T2, or -1 if there is none */
+  frame_id_t FindEvictable(ListType list);
+
+  size_t num_pages_;
+  std::mutex mutex_;
+  /** Target size of T1. */
+  size_t target_{0};
+  size_t b1_hits_{0};
+  size_t b2_hits_{0};
+  size_t num_evictable_{0};
+  std::vector<FrameInfo> frames_;
+  /** Resident lists, MRU at the front. */
+  std::list<frame_id_t> t1_;
+  std::list<frame_id_t> t2_;
+  /** Ghost lists, MRU at the front. */
+  std::list<page_id_t> b1_;
+  std::list<page_id_t> b2_;
+  std::unordered_map<page_id_t, GhostInfo> ghosts_;
+};
+
+}  // namespace bustub
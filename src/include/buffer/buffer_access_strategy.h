@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_access_strategy.h
+//
+// Identification: src/include/buffer/buffer_access_strategy.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/config.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * BufferAccessStrategy confines a bulk operation, e.g. a full table scan or a bulk load, to a small ring of frames.
+ *
+ * Every page the operation reads in (or creates) on a miss takes the next slot of the ring. Once the ring has gone
+ * around, the frame of that slot is recycled for the next miss instead of evicting a page through the replacer, so
+ * the operation never pushes more than the ring size out of the buffer pool. A slot is only recycled if its frame is
+ * unpinned and still holds the page the operation put there, otherwise the operation falls back to a regular victim.
+ *
+ * A strategy belongs to one operation and is not thread safe. It may be shared by the instances of a
+ * ParallelBufferPoolManager, each of them only recycles its own frames.
+ */
+class BufferAccessStrategy {
+  friend class BufferPoolManager;
+
+ public:
+  /**
+   * Creates a new BufferAccessStrategy.
+   * @param ring_size size of the ring in bytes, rounded down to whole frames but at least one frame
+   */
+  explicit BufferAccessStrategy(size_t ring_size = BUFFER_RING_SIZE);
+
+  /** @return the number of frames in the ring */
+  size_t GetNumFrames() const { return ring_.size(); }
+
+ private:
+  /** A frame the operation used, along with the page it put there. */
+  struct Slot {
+    Page *page_{nullptr};
+    page_id_t page_id_{INVALID_PAGE_ID};
+  };
+
+  /** @return the slot the next page goes to, it holds the oldest frame of the ring */
+  Slot *Current() { return &ring_[cursor_]; }
+
+  /**
+   * Puts a page into the current slot and moves on to the next one.
+   * @param page the frame holding the page
+   * @param page_id id of the page
+   */
+  void Add(Page *page, page_id_t page_id);
+
+  std::vector<Slot> ring_;
+  /** Index of the current slot. */
+  size_t cursor_{0};
+};
+
+}  // namespace bustub
@@ -12,13 +12,27 @@
 
 #pragma once
 
+#include <condition_variable>  // NOLINT
+#include <deque>
 #include <list>
+#include <memory>
 #include <mutex>  // NOLINT
-#include <unordered_map>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
 
+#include "buffer/arc_replacer.h"
+#include "buffer/buffer_access_strategy.h"
+#include "buffer/buffer_pool_metrics.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/compressed_page_cache.h"
+#include "buffer/frame_arena.h"
+#include "buffer/lru_k_replacer.h"
 #include "buffer/lru_replacer.h"
+#include "buffer/page_table.h"
 #include "recovery/log_manager.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/disk_scheduler.h"
 #include "storage/page/page.h"
 
 namespace bustub {
@@ -37,13 +51,33 @@ class BufferPoolManager {
    * @param disk_manager the disk manager
    * @param log_manager the log manager (for testing only: nullptr = disable
    * logging)
+   * @param replacer_type the replacement policy
+   * @param max_pool_size the size the buffer pool can grow to with Resize, 0 = pool_size
    */
-  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr);
+  BufferPoolManager(size_t pool_size, DiskManager *disk_manager, LogManager *log_manager = nullptr,
+                    ReplacerType replacer_type = ReplacerType::LRU, size_t max_pool_size = 0);
+
+  /**
+   * Creates a new BufferPoolManager that is one instance of a ParallelBufferPoolManager.
+   * @param pool_size the size of the buffer pool
+   * @param num_instances total number of instances sharing the page id space
+   * @param instance_index index of this instance, it only allocates page ids p with p % num_instances == instance_index
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable
+   * logging)
+   * @param replacer_type the replacement policy
+   * @param max_pool_size the size the buffer pool can grow to with Resize, 0 = pool_size
+   * @param disk_scheduler the disk scheduler to do the page I/O through, shared by the instances. nullptr = the pool
+   * creates its own, with one worker thread
+   */
+  BufferPoolManager(size_t pool_size, uint32_t num_instances, uint32_t instance_index, DiskManager *disk_manager,
+                    LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                    size_t max_pool_size = 0, DiskScheduler *disk_scheduler = nullptr);
 
   /**
    * Destroys an existing BufferPoolManager.
    */
-  ~BufferPoolManager();
+  virtual ~BufferPoolManager();
 
   /** Grading function. Do not modify! */
   Page *FetchPage(page_id_t page_id, bufferpool_callback_fn callback = nullptr) {
@@ -92,11 +126,115 @@ class BufferPoolManager {
     GradingCallback(callback, CallbackType::AFTER, INVALID_PAGE_ID);
   }
 
+  /**
+   * Fetches a page on behalf of a bulk operation. On a miss the page is read into the operation's ring of frames
+   * instead of evicting a page through the replacer.
+   * @param page_id id of page to be fetched
+   * @param strategy the operation's access strategy
+   * @return the requested page, or nullptr if every frame is pinned
+   */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy &strategy) {  // NOLINT
+    return FetchPageWithStrategy(page_id, &strategy);
+  }
+
+  /**
+   * Creates a new page on behalf of a bulk operation, in the operation's ring of frames.
+   * @param[out] page_id id of created page
+   * @param strategy the operation's access strategy
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  Page *NewPage(page_id_t *page_id, BufferAccessStrategy &strategy) {  // NOLINT
+    return NewPageWithStrategy(page_id, &strategy);
+  }
+
+  /**
+   * Fetches a batch of pages. Cached pages are pinned right away, and the missing ones are read from disk in one
+   * batch, in page id order, with the pool latch released. Pages another fetch is reading in are waited for last. A
+   * page id may appear more than once, it is then pinned once per occurrence.
+   * @param page_ids ids of the pages to be fetched
+   * @param[out] pages one entry per page id, the pinned page or nullptr if no frame was left for it. The caller
+   * unpins every page returned.
+   * @return true if every page was fetched
+   */
+  virtual bool FetchPages(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages);
+
   /** @return pointer to all the pages in the buffer pool */
   Page *GetPages() { return pages_; }
 
   /** @return size of the buffer pool */
-  size_t GetPoolSize() { return pool_size_; }
+  virtual size_t GetPoolSize() { return pool_size_; }
+
+  /** @return the size the buffer pool can grow to */
+  virtual size_t GetMaxPoolSize() { return max_pool_size_; }
+
+  /**
+   * Grows or shrinks the buffer pool while it is in use. The pool latch is only held while frames are moved around,
+   * never during I/O.
+   *
+   * Growing hands the frames up to the new size to the free list. Shrinking takes the frames past the new size out
+   * of use right away: free ones are dropped from the free list, and cached pages are evicted, dirty ones written
+   * back first. Their memory goes back to the OS. A frame that is pinned keeps its page until it is unpinned, it is
+   * retired the next time it is picked as a victim or by the background writer, or by resizing to the same size.
+   * @param pool_size the new size of the buffer pool, at most GetMaxPoolSize()
+   * @return false if the size is out of range or some frames past the new size were still pinned, true otherwise
+   */
+  virtual bool Resize(size_t pool_size);
+
+  /**
+   * Hints that a page is about to be fetched. The page is read into a free frame in the background, unless it is
+   * already cached or no frame is free, and nothing is pinned. The OS is told to start reading a page that is not
+   * cached, too, see DiskManager::Advise.
+   * @param page_id id of the page, INVALID_PAGE_ID is ignored
+   */
+  virtual void PrefetchPage(page_id_t page_id);
+
+  /**
+   * Tells the OS how a range of pages is about to be accessed, e.g. by a scan, see DiskManager::Advise.
+   * @param page_id id of the first page, INVALID_PAGE_ID is ignored
+   * @param num_pages number of pages, 0 for all pages from page_id on
+   * @param hint the access pattern
+   */
+  void AdviseAccess(page_id_t page_id, size_t num_pages, AccessHint hint) {
+    disk_manager_->Advise(page_id, num_pages, hint);
+  }
+
+  /**
+   * Enables or disables compression on disk for a page, see DiskManager::SetPageCompression.
+   * @param page_id id of the page
+   * @param compressed true to keep the page compressed on disk
+   */
+  void SetPageCompression(page_id_t page_id, bool compressed) {
+    disk_manager_->SetPageCompression(page_id, compressed);
+  }
+
+  /**
+   * @param page_id id of the page
+   * @return true if the page is kept compressed on disk
+   */
+  bool IsPageCompressed(page_id_t page_id) { return disk_manager_->IsPageCompressed(page_id); }
+
+  /**
+   * Takes a snapshot of the metrics of this buffer pool. The counters are read without stopping fetches, only the
+   * free list depth is read under the pool latch.
+   * @return the metrics since the pool was created or last reset
+   */
+  virtual BufferPoolStats GetStats();
+
+  /** Sets the metrics of this buffer pool back to zero, e.g. after a scrape. */
+  virtual void ResetStats();
+
+  /**
+   * Takes a snapshot of the counters of the compressed cache of this buffer pool, see CompressedPageCache. They are
+   * set back to zero by ResetStats.
+   * @return the counters since the pool was created or last reset
+   */
+  virtual CompressedCacheStats GetCompressedCacheStats() { return compressed_cache_.GetStats(); }
+
+  /** @return the disk scheduler the page I/O goes through, e.g. to watch its queue depth */
+  DiskScheduler *GetDiskScheduler() { return disk_scheduler_; }
+
+  /** @return the number of pages read ahead, either on a hint or after a sequential pattern was detected */
+  uint64_t GetNumReadAheadPages() { return GetStats().read_ahead_pages_; }
 
  protected:
   /**
@@ -117,7 +255,15 @@ class BufferPoolManager {
    * @param page_id id of page to be fetched
    * @return the requested page
    */
-  Page *FetchPageImpl(page_id_t page_id);
+  virtual Page *FetchPageImpl(page_id_t page_id);
+
+  /**
+   * Fetch the requested page, recycling the frames of the strategy's ring on a miss.
+   * @param page_id id of page to be fetched
+   * @param strategy access strategy of the calling operation, may be nullptr
+   * @return the requested page
+   */
+  virtual Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy);
 
   /**
    * Unpin the target page from the buffer pool.
@@ -126,7 +272,7 @@ class BufferPoolManager {
    * @return false if the page pin count is <= 0 before this call, true
    * otherwise
    */
-  bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
+  virtual bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
 
   /**
    * Flushes the target page to disk.
@@ -134,7 +280,7 @@ class BufferPoolManager {
    * @return false if the page could not be found in the page table, true
    * otherwise
    */
-  bool FlushPageImpl(page_id_t page_id);
+  virtual bool FlushPageImpl(page_id_t page_id);
 
   /**
    * Creates a new page in the buffer pool.
@@ -142,7 +288,15 @@ class BufferPoolManager {
    * @return nullptr if no new pages could be created, otherwise pointer to new
    * page
    */
-  Page *NewPageImpl(page_id_t *page_id);
+  virtual Page *NewPageImpl(page_id_t *page_id);
+
+  /**
+   * Creates a new page in the strategy's ring of frames.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of the calling operation, may be nullptr
+   * @return nullptr if no new pages could be created, otherwise pointer to new page
+   */
+  virtual Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy);
 
   /**
    * Deletes a page from the buffer pool.
@@ -150,35 +304,296 @@ class BufferPoolManager {
    * @return false if the page exists but could not be deleted, true if the page
    * didn't exist or deletion succeeded
    */
-  bool DeletePageImpl(page_id_t page_id);
+  virtual bool DeletePageImpl(page_id_t page_id);
+
+  /**
+   * Writes all the dirty pages in the buffer pool back to disk, see FlushDirtyPages.
+   */
+  virtual void FlushAllPagesImpl();
 
   /**
-   * Flushes all the pages in the buffer pool to disk.
+   * Writes back the dirty pages of several buffer pools sharing one disk manager, for a checkpoint or at shutdown.
+   * The dirty pages are pinned and marked clean under the latch of their pool, then written in page id order, in
+   * batches of FLUSH_BATCH_SIZE split among flush_io_threads threads. A batch is copied into a staging buffer one
+   * page latch at a time, so that a run of consecutive pages goes out in one write. Clean pages are not written.
+   * @param pools the buffer pools, they all use the disk manager of the first one
    */
-  void FlushAllPagesImpl();
+  static void FlushDirtyPages(const std::vector<BufferPoolManager *> &pools);
 
   // Whether a page already in this buffer pool
   bool Exist(page_id_t page_id);
 
   void DebugOutput() const;
 
-  /** Number of pages in the buffer pool. */
-  size_t pool_size_;
-  /** Array of buffer pool pages. */
+  /** How the page in a frame was read ahead, until it is fetched for the first time. */
+  enum class ReadAheadMark : uint8_t { NONE, HINTED, SEQUENTIAL };
+
+  /**
+   * Handles the first fetch of a page that was read ahead: a sequential run is extended, and an operation with an
+   * access strategy takes the page into its ring, handing the ring's oldest frame back to the free list instead,
+   * through the background writer if it is dirty. The caller must hold mutex_.
+   * @param frame_id frame holding the page
+   * @param mark how the page was read ahead
+   * @param strategy access strategy of the fetching operation, may be nullptr
+   */
+  void OnReadAheadHit(frame_id_t frame_id, ReadAheadMark mark, BufferAccessStrategy *strategy);
+
+  /**
+   * Pins a frame found without holding mutex_, unless it is free or being reassigned. The caller must check that the
+   * frame still holds the page it looked up.
+   * @param page the frame
+   * @return true if the frame was pinned
+   */
+  static bool TryPin(Page *page);
+
+  /**
+   * Drops one pin of a frame and returns the frame to the replacer when that was the last one. Needs no pool latch.
+   * The frame may be claimed and given another page between the last pin being dropped and the replacer being told,
+   * the claim epoch of the frame tells such a late unpin apart, it is dropped then.
+   * @param frame_id the frame
+   */
+  void ReleasePin(frame_id_t frame_id);
+
+  /**
+   * Claims an unpinned frame for eviction or deletion by setting its pin count to -1, which makes TryPin fail until
+   * the frame is published again, and starts a new claim epoch for the frame. The caller must hold mutex_.
+   * @param page the frame
+   * @return false if the frame is pinned or already claimed
+   */
+  bool ClaimFrame(Page *page);
+
+  /**
+   * Writes the page held in the given frame to disk and marks it clean. The caller must hold mutex_.
+   * @param frame_id frame holding the page
+   */
+  void FlushFrame(frame_id_t frame_id);
+
+  /**
+   * Keeps the page of a frame that is being evicted in the compressed cache, if it is enabled. Pages recycled from
+   * the ring of an access strategy are not kept, the bulk operation that read them is done with them. The page is only
+   * staged here, a miss or the background writer compresses it once mutex_ is released. The caller must hold mutex_,
+   * and the page must be clean.
+   * @param page the frame
+   */
+  void KeepCompressed(Page *page);
+
+  /**
+   * Finds a frame for a new page, from the free list first and then from the replacer. Dirty victims are never
+   * written back here, they are handed to the background writer, up to bg_free_frames + 1 of them. If no clean victim
+   * is left, the caller waits for the writer to free a frame. The caller must hold mutex_.
+   * @param[out] frame_id the frame found, it is claimed and no longer in the page table
+   * @param lock the caller's lock on mutex_, released while waiting for the background writer
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindVictimFrame(frame_id_t *frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Takes a frame out of use after a shrink: it stays claimed, is in neither the free list nor the replacer, and its
+   * memory goes back to the OS. The caller must hold mutex_, and the frame must be claimed and hold no page.
+   * @param frame_id the frame
+   */
+  void RetireFrame(frame_id_t frame_id);
+
+  /**
+   * Returns a claimed frame that holds no page to the free list, or retires it if it is past the pool size. The
+   * caller must hold mutex_.
+   * @param frame_id the frame
+   */
+  void FreeFrame(frame_id_t frame_id);
+
+  /**
+   * Evicts the page of a frame past the pool size and retires the frame, writing the page back first if it is
+   * dirty. The caller must hold mutex_, which is released during the write.
+   * @param frame_id the frame
+   * @param lock the caller's lock on mutex_
+   * @return false if the frame is pinned, true if it is retired
+   */
+  bool TryRetireFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Claims the frame in the current slot of a strategy's ring, if it belongs to this instance, is unpinned and still
+   * holds the page the strategy put there. The caller must hold mutex_.
+   * @param strategy the access strategy
+   * @param[out] frame_id the frame claimed, it is still in the page table
+   * @return false if the slot cannot be recycled
+   */
+  bool ClaimRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id);
+
+  /**
+   * Takes back the frame in the current slot of a strategy's ring, see ClaimRingFrame. A dirty page is written back
+   * first, with mutex_ released during the I/O. The caller must hold mutex_.
+   * @param strategy the access strategy
+   * @param[out] frame_id the frame taken back, it is claimed and no longer in the page table
+   * @param lock the caller's lock on mutex_
+   * @return false if the slot cannot be recycled
+   */
+  bool RecycleRingFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Finds a frame for a page fetched or created by an operation with the given strategy, recycling its ring first.
+   * The caller must hold mutex_.
+   * @param strategy the access strategy, may be nullptr
+   * @param[out] frame_id the frame found
+   * @param lock the caller's lock on mutex_, see FindVictimFrame
+   * @return false if every frame is pinned, true otherwise
+   */
+  bool FindFrame(BufferAccessStrategy *strategy, frame_id_t *frame_id, std::unique_lock<std::mutex> *lock);
+
+  /** Wakes up the background writer, e.g. because the free frame reserve ran low. The caller must hold mutex_. */
+  void RequestBackgroundFlush();
+
+  /**
+   * Writes a dirty page back to disk with mutex_ released during the I/O. The frame stays pinned while it is
+   * written, and goes back into the replacer if the write held its last pin.
+   * @param frame_id frame holding the page
+   * @param lock the caller's lock on mutex_
+   */
+  void WriteBack(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Writes back the page of a dirty frame handed over by FindVictimFrame or OnReadAheadHit, with mutex_ released during
+   * the I/O, then evicts it and frees the frame. Runs on the background writer, the caller must hold mutex_.
+   * @param frame_id the frame, claimed and still in the page table
+   * @param lock the caller's lock on mutex_
+   */
+  void EvictHandedOverFrame(frame_id_t frame_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Queues a page for the read-ahead thread. The caller must hold mutex_.
+   * @param page_id id of the page
+   * @param sequential true if the page is part of a sequential run, its first fetch then extends the run
+   */
+  void ScheduleReadAhead(page_id_t page_id, bool sequential);
+
+  /**
+   * Body of the read-ahead thread. It reads queued pages into free frames with mutex_ released during the I/O, and
+   * leaves them unpinned in the replacer. Only pages this instance already allocated are read. The page is mapped to
+   * its claimed frame during the read, so fetches of it wait for the read.
+   */
+  void RunReadAhead();
+
+  /**
+   * Waits until a fetch or the read-ahead thread that is reading the given page in has published it. The caller must
+   * hold mutex_, which is released while waiting.
+   * @param page_id id of the page
+   * @param lock the caller's lock on mutex_
+   */
+  void WaitForRead(page_id_t page_id, std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Waits for the read-ahead thread to finish the read it has in flight, if any. The frame it holds meanwhile is
+   * neither free nor in the replacer, so a caller that found no frame for a page retries afterwards. The caller
+   * must hold mutex_, which is released while waiting.
+   * @param lock the caller's lock on mutex_
+   * @return true if the caller waited, false if no read was in flight
+   */
+  bool WaitForReadAhead(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Waits for the write-backs of the background writer that are writing, if any. Their frames are pinned meanwhile,
+   * so a caller that found no frame for a page retries afterwards. A write-back still waiting for its page latch is
+   * not waited for, the caller may hold that latch. The caller must hold mutex_, which is released while waiting.
+   * @param lock the caller's lock on mutex_
+   * @return true if the caller waited, false if no write-back was writing
+   */
+  bool WaitForWriteBack(std::unique_lock<std::mutex> *lock);
+
+  /**
+   * Body of the background writer. Every bg_flush_interval, or when woken up, it frees the dirty victims handed over
+   * by FindVictimFrame, retires the frames a shrink left pinned, refills the free frame reserve and writes back dirty
+   * pages while the dirty ratio is above bg_dirty_ratio, at most bg_flush_max_pages per round. Last, it compresses
+   * the pages staged for the compressed cache, with mutex_ released.
+   */
+  void RunBackgroundFlush();
+
+  /** Number of pages in the buffer pool. Frames from pool_size_ on are retired, or about to be. */
+  std::atomic<size_t> pool_size_;
+  /** Number of frames the pool was set up with, the bound for pool_size_. */
+  const size_t max_pool_size_;
+  /** Array of buffer pool pages, holding the frame metadata. */
   Page *pages_;
+  /** The frame data, pages_[i] points at frame i. */
+  FrameArena arena_;
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
+  /**
+   * The disk scheduler the page I/O goes through. Misses and the write-backs of victims a miss waits for are foreground
+   * requests, the other writes of the background writer and the reads of the read-ahead thread background ones. A
+   * ParallelBufferPoolManager shares its own with the instances.
+   */
+  DiskScheduler *disk_scheduler_{nullptr};
+  /** True if this pool created disk_scheduler_ and deletes it. */
+  bool owns_disk_scheduler_{false};
   /** Pointer to the log manager. */
   LogManager *log_manager_ __attribute__((__unused__));
-  /** Page table for keeping track of buffer pool pages. */
-  std::unordered_map<page_id_t, frame_id_t> page_table_;
+  /** Page table for keeping track of buffer pool pages. Lookups need no latch, changes are made under mutex_. */
+  PageTable page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this
-   * comment to describe what it protects. */
+  /** Set on the frames taken out of use by a shrink, indexed by frame id. Protected by mutex_. */
+  std::vector<bool> retired_;
+  /** Serializes resizes, which release mutex_ while writing back pages. */
+  std::mutex resize_mutex_;
+  /**
+   * This latch serializes changes to the page table, the free list and the frame assignment. Cached pages are
+   * fetched and unpinned without it, through the atomic pin counts.
+   */
   std::mutex mutex_;
-  size_t page_id_{0};
+  /** Number of instances sharing the page id space. */
+  const uint32_t num_instances_;
+  /** Index of this instance in the parallel buffer pool. */
+  const uint32_t instance_index_;
+  /** True while the background writer should keep running. Protected by mutex_. */
+  bool enable_bg_flush_{false};
+  /** True if the background writer was asked to run before its next timeout. Protected by mutex_. */
+  bool bg_flush_requested_{false};
+  /** Next frame the background writer looks at when writing back dirty pages. */
+  size_t bg_flush_cursor_{0};
+  /** Wakes up the background writer. */
+  std::condition_variable bg_flush_cv_;
+  /** Dirty victims handed to the background writer, claimed and mapped until freed. Protected by mutex_. */
+  std::deque<frame_id_t> evict_queue_;
+  /** Signaled when the background writer frees a victim handed to it. */
+  std::condition_variable frame_freed_cv_;
+  /** The background writer thread, nullptr for a pool without frames. */
+  std::thread *bg_flush_thread_{nullptr};
+  /** Pages waiting to be read ahead, with their sequential flag. Protected by mutex_. */
+  std::deque<std::pair<page_id_t, bool>> read_ahead_queue_;
+  /**
+   * Number of times each frame was claimed, indexed by frame id. It only changes under the frame's claim latch, and
+   * not while the frame is pinned.
+   */
+  std::unique_ptr<std::atomic<uint64_t>[]> claim_epochs_;
+  /** Serializes claiming a frame with returning it to the replacer after its last unpin, indexed by frame id. */
+  std::unique_ptr<std::mutex[]> claim_latches_;
+  /** Set on frames holding a page that was read ahead but not fetched yet, indexed by frame id. */
+  std::unique_ptr<std::atomic<ReadAheadMark>[]> read_ahead_marks_;
+  /** The page of the last miss, a miss on the next page of this instance starts a sequential run. */
+  page_id_t last_miss_page_id_{INVALID_PAGE_ID};
+  /** True while the read-ahead thread should keep running. Protected by mutex_. */
+  bool enable_read_ahead_{false};
+  /** Wakes up the read-ahead thread. */
+  std::condition_variable read_ahead_cv_;
+  /** True while the read-ahead thread reads a page into a frame it took. Protected by mutex_. */
+  bool read_ahead_in_flight_{false};
+  /** Signaled when the read-ahead thread finishes a read. */
+  std::condition_variable read_ahead_done_cv_;
+  /** Number of write-backs that hold their page latch and are writing. It only drops under mutex_. */
+  std::atomic<size_t> write_backs_in_flight_{0};
+  /** Signaled when a write-back is done. */
+  std::condition_variable write_back_done_cv_;
+  /** Signaled when a fetch publishes a page it read in with mutex_ released. */
+  std::condition_variable read_done_cv_;
+  /** The read-ahead thread, nullptr for a pool without frames. */
+  std::thread *read_ahead_thread_{nullptr};
+  /** Counters and histograms of this pool. */
+  BufferPoolMetrics metrics_;
+  /**
+   * Second tier for the clean pages this pool evicts. A miss looks there before reading from disk. Its budget is
+   * compressed_cache_size split among the instances.
+   */
+  CompressedPageCache compressed_cache_;
 };
 }  // namespace bustub
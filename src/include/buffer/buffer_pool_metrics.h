@@ -0,0 +1,157 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_metrics.h
+//
+// Identification: src/include/buffer/buffer_pool_metrics.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * LatencyHistogram counts values in log-linear buckets, the way HDR histograms do: every power of two is split into
+ * 2^SUB_BUCKET_BITS equal sub-buckets, so a value is known to within 1/2^SUB_BUCKET_BITS of itself over the whole
+ * uint64_t range, with a fixed number of buckets. Values below 2^(SUB_BUCKET_BITS + 1) are exact.
+ *
+ * This is the plain snapshot type, it is not thread safe.
+ */
+class LatencyHistogram {
+ public:
+  static constexpr size_t SUB_BUCKET_BITS = 3;
+  static constexpr size_t SUB_BUCKETS = size_t{1} << SUB_BUCKET_BITS;
+  static constexpr size_t NUM_BUCKETS = (64 - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+  /** @return the bucket counting the given value */
+  static size_t BucketOf(uint64_t value);
+
+  /** @return the smallest value counted in the given bucket */
+  static uint64_t BucketLowerBound(size_t bucket);
+
+  /** @return the largest value counted in the given bucket */
+  static uint64_t BucketUpperBound(size_t bucket);
+
+  /** Counts one value. */
+  void Record(uint64_t value);
+
+  /** Adds the counts of another histogram to this one. */
+  void Merge(const LatencyHistogram &other);
+
+  /** @return the number of values in the given bucket */
+  uint64_t GetBucketCount(size_t bucket) const { return counts_[bucket]; }
+
+  /** @return the number of values recorded */
+  uint64_t GetCount() const { return count_; }
+
+  /** @return the largest value recorded, 0 if there is none */
+  uint64_t GetMax() const { return max_; }
+
+  /** @return the mean of the values recorded, 0 if there is none */
+  double GetMean() const { return count_ == 0 ? 0 : static_cast<double>(sum_) / count_; }
+
+  /**
+   * @param percentile in [0, 100]
+   * @return an upper bound of the given percentile, within the bucket precision and never above GetMax(), 0 if no
+   * value was recorded
+   */
+  uint64_t GetPercentile(double percentile) const;
+
+ private:
+  friend class BufferPoolMetrics;
+
+  std::array<uint64_t, NUM_BUCKETS> counts_{};
+  uint64_t count_{0};
+  uint64_t sum_{0};
+  uint64_t max_{0};
+};
+
+/**
+ * A point-in-time view of the metrics of a buffer pool.
+ */
+struct BufferPoolStats {
+  /** Fetches of a page that was cached. */
+  uint64_t hits_{0};
+  /** Fetches that read the page from disk, or took it from the compressed cache. */
+  uint64_t misses_{0};
+  /** Pages dropped from the pool to make room for another one. */
+  uint64_t evictions_{0};
+  /** Dirty pages written back, on eviction, by the background writer or when flushed. */
+  uint64_t dirty_write_backs_{0};
+  /** Fetches that could not pin a frame right away, because it was being reassigned or read into. */
+  uint64_t pin_waits_{0};
+  /** Pages read ahead, either on a hint or after a sequential pattern was detected. */
+  uint64_t read_ahead_pages_{0};
+  /** Frames on the free list when the snapshot was taken. */
+  uint64_t free_frames_{0};
+  /** With the ARC replacer only: the target size of T1 when the snapshot was taken, see ARCReplacer. */
+  uint64_t arc_target_{0};
+  /** With the ARC replacer only: fetches of a page that hit the B1 and the B2 ghost list. */
+  uint64_t arc_b1_hits_{0};
+  uint64_t arc_b2_hits_{0};
+  /** Service time of the fetches that missed, in nanoseconds, from the failed lookup to the page being pinned. */
+  LatencyHistogram miss_latency_;
+
+  /** @return hits over fetches, 0 if there was no fetch */
+  double HitRatio() const {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** Adds the metrics of another pool, e.g. to sum up the instances of a ParallelBufferPoolManager. */
+  void Merge(const BufferPoolStats &other);
+};
+
+/**
+ * BufferPoolMetrics collects the counters and histograms of one buffer pool.
+ *
+ * Every thread records into its own shard, picked once per thread, so the hot path is one relaxed increment on a
+ * cache line that other threads rarely touch. GetStats sums the shards without stopping writers, and Reset takes the
+ * counts out atomically, so an event recorded concurrently is counted either before or after the reset, never lost.
+ */
+class BufferPoolMetrics {
+ public:
+  /** Number of shards, threads beyond that share them. */
+  static constexpr size_t NUM_SHARDS = 16;
+
+  enum class Counter { HIT, MISS, EVICTION, DIRTY_WRITE_BACK, PIN_WAIT, READ_AHEAD_PAGE, NUM_COUNTERS };
+
+  /** Counts one event. */
+  void Add(Counter counter) {
+    LocalShard()->counters_[static_cast<size_t>(counter)].fetch_add(1, std::memory_order_relaxed);
+  }
+
+  /** Records the service time of a fetch that missed, in nanoseconds. */
+  void RecordMissLatency(uint64_t nanoseconds);
+
+  /**
+   * @param[out] stats receives the counters and histograms, summed over all shards; free_frames_ is left unchanged
+   */
+  void GetStats(BufferPoolStats *stats) const;
+
+  /** Sets every counter and histogram back to zero. */
+  void Reset();
+
+ private:
+  struct alignas(64) Shard {
+    std::array<std::atomic<uint64_t>, static_cast<size_t>(Counter::NUM_COUNTERS)> counters_{};
+    std::array<std::atomic<uint64_t>, LatencyHistogram::NUM_BUCKETS> miss_latency_counts_{};
+    std::atomic<uint64_t> miss_latency_sum_{0};
+    std::atomic<uint64_t> miss_latency_max_{0};
+  };
+
+  /** @return the shard of the calling thread */
+  Shard *LocalShard();
+
+  std::array<Shard, NUM_SHARDS> shards_;
+};
+
+}  // namespace bustub
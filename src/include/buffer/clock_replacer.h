@@ -12,9 +12,8 @@
 
 #pragma once
 
-#include <list>
-#include <mutex>  // NOLINT
-#include <vector>
+#include <atomic>
+#include <memory>
 
 #include "buffer/replacer.h"
 #include "common/config.h"
@@ -24,6 +23,11 @@ namespace bustub {
 /**
  * ClockReplacer implements the clock replacement policy, which approximates the
  * Least Recently Used policy.
+ *
+ * Every frame has one atomic state word holding an evictable bit and a reference
+ * bit, and the clock hand is an atomic counter. Pin and Unpin are a single atomic
+ * exchange, and Victim claims a frame with a compare-and-swap, so no operation
+ * takes a lock.
  */
 class ClockReplacer : public Replacer {
  public:
@@ -48,7 +52,21 @@ class ClockReplacer : public Replacer {
   size_t Size() override;
 
  private:
-  // TODO(student): implement me!
+  /** The frame is in the replacer and may be victimized. */
+  static constexpr uint8_t EVICTABLE = 0x1;
+  /** The frame was unpinned since the clock hand last passed it. */
+  static constexpr uint8_t REFERENCED = 0x2;
+
+  size_t num_pages_;
+  /** State word of every frame, indexed by frame id. */
+  std::unique_ptr<std::atomic<uint8_t>[]> states_;
+  /**
+   * Number of evictable frames. It is counted after the state word changed, so a Pin may take a frame out before the
+   * Unpin that put it in counted it, and the count drops below zero for a moment.
+   */
+  std::atomic<int64_t> size_{0};
+  /** The clock hand, taken modulo num_pages_. */
+  std::atomic<size_t> hand_{0};
 };
 
 }  // namespace bustub
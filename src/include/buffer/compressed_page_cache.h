@@ -0,0 +1,177 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache.h
+//
+// Identification: src/include/buffer/compressed_page_cache.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * A point-in-time view of the counters of a compressed page cache.
+ */
+struct CompressedCacheStats {
+  /** Lookups that found the page, and lookups that did not. */
+  uint64_t hits_{0};
+  uint64_t misses_{0};
+  /** Pages put into the cache. */
+  uint64_t inserts_{0};
+  /** Pages not put into the cache because they did not compress well enough, or too many were staged. */
+  uint64_t rejects_{0};
+  /** Pages dropped to stay within the memory budget. */
+  uint64_t evictions_{0};
+  /** Pages in the cache when the snapshot was taken. */
+  uint64_t pages_{0};
+  /** Pages staged but not compressed yet when the snapshot was taken. */
+  uint64_t staged_{0};
+  /** Memory charged for them, in byte, the compressed pages and the bookkeeping per page. */
+  uint64_t memory_used_{0};
+  /** The memory budget, in byte. */
+  uint64_t capacity_{0};
+
+  /** @return hits over lookups, 0 if there was no lookup */
+  double HitRatio() const {
+    return hits_ + misses_ == 0 ? 0 : static_cast<double>(hits_) / static_cast<double>(hits_ + misses_);
+  }
+
+  /** @return pages held per page worth of memory used, 0 if the cache is empty */
+  double CompressionRatio() const {
+    return memory_used_ == 0 ? 0 : static_cast<double>(pages_ * PAGE_SIZE) / static_cast<double>(memory_used_);
+  }
+
+  /** Adds the counters of another cache, e.g. to sum up the instances of a ParallelBufferPoolManager. */
+  void Merge(const CompressedCacheStats &other);
+};
+
+/**
+ * CompressedPageCache is a second tier below the frames of a buffer pool. It keeps clean pages the pool evicted,
+ * compressed with LZCodec, so that fetching one of them again decompresses it instead of reading it from disk.
+ *
+ * The cache is exclusive: a page leaves it when it is looked up, so it never holds a page that is also cached in the
+ * pool, and a copy it holds is always the one on disk. Pages are dropped oldest first once the memory charged for
+ * them, their compressed size and ENTRY_OVERHEAD, goes over the budget. A page that compresses to more than
+ * MAX_ENTRY_SIZE byte is not kept, it would take the room of several others.
+ *
+ * Compression and decompression run outside of the latch, only the bookkeeping is serialized. A caller that holds a
+ * latch of its own, like a buffer pool evicting a page, stages the page instead: the cache keeps a plain copy until
+ * Compress, which the pool calls once it released its latch, compresses it. A lookup meanwhile returns the copy.
+ */
+class CompressedPageCache {
+ public:
+  /** Memory charged per page on top of its compressed size, for the map and list nodes. */
+  static constexpr size_t ENTRY_OVERHEAD = 64;
+
+  /** Largest compressed page kept, in byte. */
+  static constexpr size_t MAX_ENTRY_SIZE = PAGE_SIZE * 3 / 4;
+
+  /** Most pages staged at a time, a plain copy takes a whole page of memory. */
+  static constexpr size_t MAX_STAGED_PAGES = 64;
+
+  /**
+   * Creates a new CompressedPageCache.
+   * @param capacity the memory budget, in byte, 0 disables the cache
+   */
+  explicit CompressedPageCache(size_t capacity);
+
+  /** @return true if the cache has a memory budget */
+  bool IsEnabled() const { return capacity_ > 0; }
+
+  /**
+   * Compresses a page and puts it into the cache, replacing the copy it may already hold. The oldest pages are
+   * dropped to make room for it.
+   * @param page_id id of the page
+   * @param page_data the page, it must be the same as on disk
+   * @return false if the cache is disabled or the page does not compress well enough
+   */
+  bool Insert(page_id_t page_id, const char *page_data);
+
+  /**
+   * Copies a page into the cache without compressing it, replacing the copy it may already hold. It is compressed
+   * and put into the cache by the next Compress.
+   * @param page_id id of the page
+   * @param page_data the page, it must be the same as on disk
+   * @return false if the cache is disabled or MAX_STAGED_PAGES pages are staged already
+   */
+  bool Stage(page_id_t page_id, const char *page_data);
+
+  /**
+   * Compresses the staged pages and puts them into the cache, like Insert does. Pages another thread is compressing
+   * already are skipped, and a page looked up, erased or staged again during the compression is left alone.
+   */
+  void Compress();
+
+  /**
+   * Takes a page out of the cache.
+   * @param page_id id of the page
+   * @param[out] page_data receives the page
+   * @return false if the page is not in the cache
+   */
+  bool Lookup(page_id_t page_id, char *page_data);
+
+  /**
+   * Drops a page from the cache, e.g. because it was deleted.
+   * @param page_id id of the page
+   */
+  void Erase(page_id_t page_id);
+
+  /** @return a snapshot of the counters */
+  CompressedCacheStats GetStats();
+
+  /** Sets the counters back to zero, the pages stay in the cache. */
+  void ResetStats();
+
+ private:
+  struct StagedPage {
+    std::shared_ptr<char[]> data_;
+    bool compressing_;
+  };
+
+  struct Entry {
+    page_id_t page_id_;
+    size_t size_;
+    std::unique_ptr<char[]> data_;
+  };
+
+  /**
+   * Compresses a page, without latch_.
+   * @param page_data the page
+   * @param[out] size size of the compressed page, 0 if it does not fit into MAX_ENTRY_SIZE byte
+   * @return the compressed page
+   */
+  static std::unique_ptr<char[]> CompressPage(const char *page_data, size_t *size);
+
+  /** Puts a compressed page into the cache, with latch_ held, see Insert. size is 0 if it did not compress. */
+  bool InsertEntry(page_id_t page_id, size_t size, std::unique_ptr<char[]> data);
+
+  /** Removes an entry, with latch_ held. */
+  void EraseEntry(std::list<Entry>::iterator entry);
+
+  const size_t capacity_;
+  // protects everything below
+  std::mutex latch_;
+  // the entries, oldest first
+  std::list<Entry> entries_;
+  std::unordered_map<page_id_t, std::list<Entry>::iterator> index_;
+  // the staged pages, not compressed yet
+  std::unordered_map<page_id_t, StagedPage> staged_;
+  size_t memory_used_{0};
+  CompressedCacheStats stats_;
+};
+
+}  // namespace bustub
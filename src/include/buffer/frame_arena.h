@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena.h
+//
+// Identification: src/include/buffer/frame_arena.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * FrameArena holds the data of all frames of a buffer pool in one anonymous memory mapping.
+ *
+ * Frame i starts at i * PAGE_SIZE from the beginning of the mapping, so every frame is aligned to the OS page size,
+ * which is what O_DIRECT I/O needs. An arena of at least one huge page is first mapped with explicit huge pages
+ * (MAP_HUGETLB). If none are reserved, it falls back to ordinary pages and asks for transparent huge pages instead
+ * (MADV_HUGEPAGE). Either way a large pool needs far fewer TLB entries than with one heap allocation per frame.
+ *
+ * A resizable arena only reserves address space: a frame takes memory once it is first written, and gives it back
+ * when it is released. It never uses explicit huge pages, those would be reserved for the whole arena upfront.
+ */
+class FrameArena {
+ public:
+  /**
+   * Maps a new arena. The memory is zeroed.
+   * @param num_frames the number of frames
+   * @param resizable true if frames are only backed by memory while in use
+   */
+  explicit FrameArena(size_t num_frames, bool resizable = false);
+
+  /** Unmaps the arena. */
+  ~FrameArena();
+
+  FrameArena(const FrameArena &) = delete;
+  FrameArena &operator=(const FrameArena &) = delete;
+
+  /** @return the data of the given frame */
+  char *GetFrame(frame_id_t frame_id) const { return data_ + static_cast<size_t>(frame_id) * PAGE_SIZE; }
+
+  /**
+   * Gives the memory of a range of frames back to the OS. The frames read as zeroes afterwards. This is a no-op for
+   * an arena backed by explicit huge pages.
+   * @param frame_id the first frame
+   * @param num_frames the number of frames
+   */
+  void Release(frame_id_t frame_id, size_t num_frames);
+
+  /** @return true if the arena is backed by explicitly reserved huge pages */
+  bool IsHugeTlb() const { return huge_tlb_; }
+
+ private:
+  /** Size of a huge page on x86-64 and the common arm64 configurations. */
+  static constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+  /** Start of the mapping, nullptr for an empty arena. */
+  char *data_{nullptr};
+  /** Size of the mapping, rounded up to a huge page when it is backed by huge pages. */
+  size_t size_{0};
+  bool huge_tlb_{false};
+};
+
+}  // namespace bustub
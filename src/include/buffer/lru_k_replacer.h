@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer.h
+//
+// Identification: src/include/buffer/lru_k_replacer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <mutex>  // NOLINT
+#include <set>
+#include <tuple>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * LRUKReplacer implements the LRU-K replacement policy.
+ *
+ * The victim is the evictable frame whose backward K-distance, i.e. the time since
+ * its K-th most recent reference, is the largest. Frames with fewer than K
+ * references have an infinite distance and are evicted first, oldest reference
+ * first, which keeps a one-pass scan from flushing pages that are referenced
+ * repeatedly.
+ *
+ * References closer than the correlated reference period to the previous one
+ * are folded into it, so a burst of accesses from one operation counts once.
+ * Time is a logical clock advanced by every recorded access.
+ */
+class LRUKReplacer : public Replacer {
+ public:
+  /**
+   * Create a new LRUKReplacer.
+   * @param num_pages the maximum number of pages the LRUKReplacer will be
+   * required to store
+   * @param k the number of references the backward distance looks back
+   * @param correlated_period references within this many accesses of the
+   * previous one are correlated with it
+   */
+  explicit LRUKReplacer(size_t num_pages, size_t k = LRUK_REPLACER_K, size_t correlated_period = 0);
+
+  /**
+   * Destroys the LRUKReplacer.
+   */
+  ~LRUKReplacer() override;
+
+  bool Victim(frame_id_t *frame_id) override;
+
+  void RecordAccess(frame_id_t frame_id, page_id_t page_id) override;
+
+  void Pin(frame_id_t frame_id) override;
+
+  void Unpin(frame_id_t frame_id) override;
+
+  size_t Size() override;
+
+ private:
+  struct FrameInfo {
+    /** The page the history belongs to. */
+    page_id_t page_id_{INVALID_PAGE_ID};
+    /** Up to k uncorrelated reference times, oldest first. */
+    std::deque<uint64_t> history_;
+    /** Time of the last reference, correlated or not. */
+    uint64_t last_{0};
+    bool evictable_{false};
+  };
+
+  /** Ordering key of an evictable frame: (has k references, oldest kept reference, frame id). */
+  using Key = std::tuple<bool, uint64_t, frame_id_t>;
+
+  Key MakeKey(frame_id_t frame_id) const;
+
+  size_t num_pages_;
+  size_t k_;
+  size_t correlated_period_;
+  std::mutex mutex_;
+  uint64_t current_timestamp_{0};
+  std::vector<FrameInfo> frames_;
+  /** Evictable frames, the first one is the victim. */
+  std::set<Key> evictable_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table.h
+//
+// Identification: src/include/buffer/page_table.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * PageTable maps the page ids cached by a buffer pool to their frames.
+ *
+ * It is a fixed-capacity open-addressing table with linear probing. Every slot is one atomic word holding both the
+ * page id and the frame id, and erasing shifts the following entries back instead of leaving tombstones, so the
+ * table never needs to be rebuilt. Writers must be serialized by the caller (the buffer pool latch). Find takes no
+ * lock: it validates its probe against a sequence counter that writers bump before and after every change, and
+ * retries if a writer got in between.
+ */
+class PageTable {
+ public:
+  /**
+   * Creates a new PageTable.
+   * @param num_frames the maximum number of entries, at most FRAME_ID_MASK, the table keeps its load factor at or
+   * below 1/2
+   */
+  explicit PageTable(size_t num_frames);
+
+  /**
+   * Looks up a page. Safe to call concurrently with a writer.
+   * @param page_id the page to look up
+   * @param[out] frame_id the frame holding the page
+   * @return true if the page is in the table
+   */
+  bool Find(page_id_t page_id, frame_id_t *frame_id) const;
+
+  /**
+   * Inserts a page that is not yet in the table. The caller must serialize writers.
+   * @param page_id the page, below 2^PAGE_ID_BITS
+   * @param frame_id the frame holding the page
+   */
+  void Insert(page_id_t page_id, frame_id_t frame_id);
+
+  /**
+   * Removes a page from the table. The caller must serialize writers.
+   * @param page_id the page
+   * @return true if the page was in the table
+   */
+  bool Erase(page_id_t page_id);
+
+  /** @return the number of entries, only exact while the caller serializes writers */
+  size_t Size() const { return size_; }
+
+ private:
+  /** A slot packs the page id into its high PAGE_ID_BITS bits and the frame id into the rest. */
+  static constexpr int FRAME_ID_BITS = 24;
+  static constexpr int PAGE_ID_BITS = 64 - FRAME_ID_BITS;
+  static constexpr uint64_t FRAME_ID_MASK = (uint64_t{1} << FRAME_ID_BITS) - 1;
+
+  /** A slot holding no entry. Frame ids stay below FRAME_ID_MASK, so no valid entry packs to this value. */
+  static constexpr uint64_t EMPTY = ~uint64_t{0};
+
+  static uint64_t Pack(page_id_t page_id, frame_id_t frame_id) {
+    return (static_cast<uint64_t>(page_id) << FRAME_ID_BITS) | static_cast<uint64_t>(frame_id);
+  }
+  static page_id_t PageOf(uint64_t slot) { return static_cast<page_id_t>(slot >> FRAME_ID_BITS); }
+  static frame_id_t FrameOf(uint64_t slot) { return static_cast<frame_id_t>(slot & FRAME_ID_MASK); }
+
+  /** @return the slot where the probe for page_id starts */
+  size_t Home(page_id_t page_id) const;
+
+  /** @return the slot holding page_id, or capacity_ if it is not in the table */
+  size_t Probe(page_id_t page_id) const;
+
+  /** Number of slots, a power of two. */
+  size_t capacity_;
+  /** log2(capacity_). */
+  size_t shift_;
+  std::unique_ptr<std::atomic<uint64_t>[]> slots_;
+  /** Odd while a writer is changing the slots. */
+  std::atomic<uint64_t> version_{0};
+  /** Number of entries. */
+  size_t size_{0};
+};
+
+}  // namespace bustub
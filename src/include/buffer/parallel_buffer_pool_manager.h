@@ -0,0 +1,117 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager.h
+//
+// Identification: src/include/buffer/parallel_buffer_pool_manager.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+#include "storage/page/page.h"
+
+namespace bustub {
+
+/**
+ * ParallelBufferPoolManager shards the buffer pool into several independent BufferPoolManager instances, each with
+ * its own frames, page table, replacer and latch. A page lives in instance (page_id % num_instances), so threads
+ * touching different pages rarely contend on the same latch.
+ */
+class ParallelBufferPoolManager : public BufferPoolManager {
+ public:
+  /**
+   * Creates a new ParallelBufferPoolManager.
+   * @param num_instances the number of individual BufferPoolManager instances
+   * @param pool_size the pool size of each instance
+   * @param disk_manager the disk manager
+   * @param log_manager the log manager (for testing only: nullptr = disable
+   * logging)
+   * @param replacer_type the replacement policy of every instance
+   * @param max_pool_size the size each instance can grow to with Resize, 0 = pool_size
+   */
+  ParallelBufferPoolManager(size_t num_instances, size_t pool_size, DiskManager *disk_manager,
+                            LogManager *log_manager = nullptr, ReplacerType replacer_type = ReplacerType::LRU,
+                            size_t max_pool_size = 0);
+
+  /**
+   * Destroys an existing ParallelBufferPoolManager.
+   */
+  ~ParallelBufferPoolManager() override;
+
+  /** @return size of the buffer pool, summed over all instances */
+  size_t GetPoolSize() override;
+
+  /** @return the size the buffer pool can grow to, summed over all instances */
+  size_t GetMaxPoolSize() override;
+
+  /**
+   * Resizes every instance, the new size is split evenly among them.
+   * @param pool_size the new size of the buffer pool, at least one frame per instance
+   * @return true if every instance was resized completely
+   */
+  bool Resize(size_t pool_size) override;
+
+  /** Fetches a batch of pages, every instance fetches its share of the batch in one go. */
+  bool FetchPages(const std::vector<page_id_t> &page_ids, std::vector<Page *> *pages) override;
+
+  void PrefetchPage(page_id_t page_id) override;
+
+  /** @return the metrics of all instances, summed up */
+  BufferPoolStats GetStats() override;
+
+  /** @return the counters of the compressed caches of the instances, summed up */
+  CompressedCacheStats GetCompressedCacheStats() override;
+
+  void ResetStats() override;
+
+  /** @return the number of instances */
+  size_t GetNumInstances() const { return num_instances_; }
+
+  /**
+   * @param page_id id of the page
+   * @return the instance responsible for handling the given page id
+   */
+  BufferPoolManager *GetBufferPoolManager(page_id_t page_id);
+
+ protected:
+  Page *FetchPageImpl(page_id_t page_id) override;
+
+  Page *FetchPageWithStrategy(page_id_t page_id, BufferAccessStrategy *strategy) override;
+
+  bool UnpinPageImpl(page_id_t page_id, bool is_dirty) override;
+
+  bool FlushPageImpl(page_id_t page_id) override;
+
+  Page *NewPageImpl(page_id_t *page_id) override;
+
+  /**
+   * Creates a new page. Instances are tried round-robin starting from a rotating index, so consecutive NewPage calls
+   * spread their pages over all instances.
+   * @param[out] page_id id of created page
+   * @param strategy access strategy of the calling operation, may be nullptr
+   * @return nullptr if every instance is full of pinned pages, otherwise pointer to new page
+   */
+  Page *NewPageWithStrategy(page_id_t *page_id, BufferAccessStrategy *strategy) override;
+
+  bool DeletePageImpl(page_id_t page_id) override;
+
+  void FlushAllPagesImpl() override;
+
+ private:
+  /** The buffer pool instances, as many as num_instances_. */
+  std::vector<BufferPoolManager *> instances_;
+  /** Instance to start the next NewPage search from. */
+  std::atomic<size_t> next_instance_{0};
+};
+
+}  // namespace bustub
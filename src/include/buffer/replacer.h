@@ -16,6 +16,9 @@
 
 namespace bustub {
 
+/** The replacement policies a BufferPoolManager can be created with. */
+enum class ReplacerType { LRU, CLOCK, LRU_K, ARC };
+
 /**
  * Replacer is an abstract class that tracks page usage.
  */
@@ -32,6 +35,23 @@ class Replacer {
    */
   virtual bool Victim(frame_id_t *frame_id) = 0;
 
+  /**
+   * Records an access to a page. The buffer pool calls this on every fetch and
+   * new page, before pinning the frame. Policies that only track evictability
+   * can ignore it.
+   * @param frame_id the id of the frame holding the page
+   * @param page_id the id of the accessed page
+   */
+  virtual void RecordAccess(frame_id_t frame_id, page_id_t page_id) {}
+
+  /**
+   * Forgets a page that is no longer cached, e.g. because it was deleted and
+   * its id may be handed out again. Policies that remember evicted pages drop
+   * them, the others can ignore it.
+   * @param page_id the id of the page
+   */
+  virtual void Forget(page_id_t page_id) {}
+
   /**
    * Pins a frame, indicating that it should not be victimized until it is
    * unpinned.
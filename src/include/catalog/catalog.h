@@ -73,11 +73,13 @@ class Catalog {
    * @param txn the transaction in which the table is being created
    * @param table_name the name of the new table
    * @param schema the schema of the new table
+   * @param compressed true to keep the pages of the table compressed on disk
    * @return a pointer to the metadata of the new table
    */
-  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
+  TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema,
+                             bool compressed = false) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
-    auto table_heap = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn);
+    auto table_heap = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn, compressed);
     auto table_id = next_table_oid_++;
     auto table_meta = std::make_unique<TableMetadata>(schema, table_name, std::move(table_heap), table_id);
     names_[table_name] = table_id;
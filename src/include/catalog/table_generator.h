@@ -22,8 +22,9 @@ class TableGenerator {
 
   /**
    * Generate test tables.
+   * @param compressed true to keep the pages of the tables compressed on disk
    */
-  void GenerateTestTables();
+  void GenerateTestTables(bool compressed = false);
 
  private:
   /**
@@ -13,6 +13,7 @@
 #include <string>
 
 #include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "recovery/checkpoint_manager.h"
@@ -32,7 +33,12 @@ class BustubInstance {
     // log related
     log_manager_ = new LogManager(disk_manager_);
 
-    buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    if (BUFFER_POOL_INSTANCES > 1) {
+      buffer_pool_manager_ =
+          new ParallelBufferPoolManager(BUFFER_POOL_INSTANCES, BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    } else {
+      buffer_pool_manager_ = new BufferPoolManager(BUFFER_POOL_SIZE, disk_manager_, log_manager_);
+    }
 
     // txn related
     lock_manager_ = new LockManager();
@@ -48,6 +54,8 @@ class BustubInstance {
     }
     delete checkpoint_manager_;
     delete log_manager_;
+    // Dirty pages are written back lazily, persist whatever is still cached.
+    buffer_pool_manager_->FlushAllPages();
     delete buffer_pool_manager_;
     delete lock_manager_;
     delete transaction_manager_;
@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -28,19 +29,67 @@ extern std::atomic<bool> enable_logging;
  * LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** The buffer pool background writer wakes up every BG_FLUSH_INTERVAL to write back dirty pages. */
+extern std::atomic<std::chrono::milliseconds> bg_flush_interval;
+
+/** The background writer writes back at most BG_FLUSH_MAX_PAGES pages per wake-up. */
+extern std::atomic<size_t> bg_flush_max_pages;
+
+/** The background writer writes back dirty pages once more than BG_DIRTY_RATIO of the frames are dirty. */
+extern std::atomic<double> bg_dirty_ratio;
+
+/** The background writer keeps BG_FREE_FRAMES clean frames on the free list for FetchPage/NewPage to use. */
+extern std::atomic<size_t> bg_free_frames;
+
+/** Once a sequential access pattern is detected, the buffer pool reads READ_AHEAD_DEPTH pages ahead. 0 disables it. */
+extern std::atomic<size_t> read_ahead_depth;
+
+/** The LRU-K replacer of a buffer pool looks back LRU_K_REPLACER_K references to rank a page. */
+extern std::atomic<size_t> lru_k_replacer_k;
+
+/**
+ * The LRU-K replacer of a buffer pool folds the references to a page within LRU_K_CORRELATED_PERIOD accesses of the
+ * previous one into it. E.g. a scan fetches its page once per tuple, the fetches count as one reference.
+ */
+extern std::atomic<size_t> lru_k_correlated_period;
+
+/** FlushAllPages writes the dirty pages back with up to FLUSH_IO_THREADS threads. */
+extern std::atomic<size_t> flush_io_threads;
+
+/**
+ * The instances of a ParallelBufferPoolManager do their page I/O through a shared disk scheduler with
+ * DISK_SCHEDULER_WORKERS worker threads. A buffer pool on its own uses a scheduler with one worker.
+ */
+extern std::atomic<size_t> disk_scheduler_workers;
+
+/** The database file is preallocated DB_EXTENT_SIZE bytes at a time as pages are allocated. 0 disables it. */
+extern std::atomic<size_t> db_extent_size;
+
+/** Asynchronous I/O goes through io_uring. If false, or io_uring is not available, it is done synchronously. */
+extern std::atomic<bool> enable_io_uring;
+
+/** A buffer pool keeps the clean pages it evicts compressed in COMPRESSED_CACHE_SIZE bytes of memory. 0 disables it. */
+extern std::atomic<size_t> compressed_cache_size;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
+static constexpr int BUFFER_POOL_INSTANCES = 1;                               // number of buffer pool instances
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int LRUK_REPLACER_K = 2;                                     // lookback window for lru-k replacer
+static constexpr int BUFFER_RING_SIZE = 256 * 1024;                           // frame ring of a bulk operation, in byte
+static constexpr int FLUSH_BATCH_SIZE = 1024 * 1024;                          // one write batch of a flush, in byte
+static constexpr int IO_URING_ENTRIES = 256;                                  // async disk I/O submission queue size
+static constexpr int TABLESPACE_STRIPE_SIZE = 1024 * 1024;                    // stripe of a striped tablespace, in byte
 
 using frame_id_t = int32_t;    // frame id type
-using page_id_t = int32_t;     // page id type
+using page_id_t = int64_t;     // page id type
 using txn_id_t = int32_t;      // transaction id type
-using lsn_t = int32_t;         // log sequence number type
+using lsn_t = int64_t;         // log sequence number type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
 
@@ -34,10 +34,6 @@ class RID {
    */
   RID(page_id_t page_id, uint32_t slot_num) : page_id_(page_id), slot_num_(slot_num) {}
 
-  explicit RID(int64_t rid) : page_id_(static_cast<page_id_t>(rid >> 32)), slot_num_(static_cast<uint32_t>(rid)) {}
-
-  inline int64_t Get() const { return (static_cast<int64_t>(page_id_)) << 32 | slot_num_; }
-
   inline page_id_t GetPageId() const { return page_id_; }
 
   inline uint32_t GetSlotNum() const { return slot_num_; }
@@ -72,7 +68,10 @@ class RID {
 namespace std {
 template <>
 struct hash<bustub::RID> {
-  size_t operator()(const bustub::RID &obj) const { return hash<int64_t>()(obj.Get()); }
+  size_t operator()(const bustub::RID &obj) const {
+    // A 64-bit page id and a slot number do not pack into one 64-bit value.
+    return hash<bustub::page_id_t>()(obj.GetPageId()) * 31 + hash<uint32_t>()(obj.GetSlotNum());
+  }
 };
 }  // namespace std
 
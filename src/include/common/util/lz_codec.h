@@ -0,0 +1,60 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lz_codec.h
+//
+// Identification: src/include/common/util/lz_codec.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+
+namespace bustub {
+
+/**
+ * LZCodec is a fast LZ77 block compressor in the style of LZ4, for buffers of up to a few pages.
+ *
+ * A compressed block is a list of sequences. A sequence is a token byte, whose high nibble is the number of literals
+ * and whose low nibble is the match length minus MIN_MATCH, the literals, and the match as a 2-byte little-endian
+ * offset back into the output. A nibble of 15 is continued by length bytes, up to the first byte below 255. The last
+ * sequence has literals only. Matches are found with a single-entry hash table of 4-byte prefixes, so compression
+ * is one pass that never looks back at more than one candidate.
+ */
+class LZCodec {
+ public:
+  /** Shortest match that is encoded as one. */
+  static constexpr size_t MIN_MATCH = 4;
+
+  /**
+   * @param size size of the input
+   * @return the size the compressed input has at most, whatever the input is
+   */
+  static constexpr size_t MaxCompressedSize(size_t size) { return size + size / 255 + 16; }
+
+  /**
+   * Compresses a buffer.
+   * @param src the input
+   * @param size size of the input
+   * @param[out] dst the output
+   * @param capacity size of the output buffer
+   * @return size of the compressed data, 0 if it does not fit into capacity bytes
+   */
+  static size_t Compress(const char *src, size_t size, char *dst, size_t capacity);
+
+  /**
+   * Decompresses a buffer. Corrupt input is detected as far as it would make the decoder read or write out of bounds.
+   * @param src the compressed data
+   * @param size size of the compressed data
+   * @param[out] dst the output
+   * @param capacity size of the output buffer
+   * @return size of the decompressed data, 0 if the input is corrupt or does not fit into capacity bytes
+   */
+  static size_t Decompress(const char *src, size_t size, char *dst, size_t capacity);
+};
+
+}  // namespace bustub
@@ -14,6 +14,7 @@
 
 #include <vector>
 
+#include "buffer/buffer_access_strategy.h"
 #include "execution/executor_context.h"
 #include "execution/executors/abstract_executor.h"
 #include "execution/plans/seq_scan_plan.h"
@@ -42,6 +43,8 @@ class SeqScanExecutor : public AbstractExecutor {
  private:
   /** The sequential scan plan node to be executed. */
   const SeqScanPlanNode *plan_;
+  /** Keeps the scan in a small ring of frames, so that a large table does not evict the rest of the buffer pool. */
+  BufferAccessStrategy strategy_;
   TableIterator it_;
 };
 }  // namespace bustub
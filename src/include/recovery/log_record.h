@@ -38,9 +38,9 @@ enum class LogRecordType {
  * For every write operation on the table page, you should write ahead a
  *corresponding log record.
  *
- * For EACH log record, HEADER is like (5 fields in common, 20 bytes in total).
+ * For EACH log record, HEADER is like (5 fields in common, 28 bytes in total).
  *---------------------------------------------
- * | size | LSN | transID | prevLSN | LogType |
+ * | size | transID | LSN | prevLSN | LogType |
  *---------------------------------------------
  * For insert type log record
  *---------------------------------------------------------------
@@ -157,9 +157,9 @@ class LogRecord {
  private:
   // the length of log record(for serialization, in bytes)
   int32_t size_{0};
-  // must have fields
-  lsn_t lsn_{INVALID_LSN};
+  // must have fields, in an order that leaves no padding between them
   txn_id_t txn_id_{INVALID_TXN_ID};
+  lsn_t lsn_{INVALID_LSN};
   lsn_t prev_lsn_{INVALID_LSN};
   LogRecordType log_record_type_{LogRecordType::INVALID};
 
@@ -179,7 +179,7 @@ class LogRecord {
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
-  static const int HEADER_SIZE = 20;
+  static const int HEADER_SIZE = 28;
 };  // namespace bustub
 
 }  // namespace bustub
@@ -0,0 +1,193 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_store.h
+//
+// Identification: src/include/storage/disk/compressed_page_store.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** Counters of a compressed page store, since it was opened. */
+struct CompressionStats {
+  /** Pages written to the store, and read from it. */
+  uint64_t pages_written_{0};
+  uint64_t pages_read_{0};
+  /** Bytes of the pages written, PAGE_SIZE each. */
+  uint64_t raw_bytes_{0};
+  /** Bytes written to the data file for them, the slots they were stored in. */
+  uint64_t stored_bytes_{0};
+  /** Time spent compressing and decompressing, in nanoseconds. */
+  uint64_t compress_ns_{0};
+  uint64_t decompress_ns_{0};
+
+  /** @return raw bytes per stored byte, 0 before the first write */
+  double CompressionRatio() const {
+    return stored_bytes_ == 0 ? 0 : static_cast<double>(raw_bytes_) / static_cast<double>(stored_bytes_);
+  }
+};
+
+/**
+ * CompressedPageStore keeps pages compressed with LZCodec, in variable-size slots of a data file, instead of in the
+ * tablespace. A page is stored here once compression is enabled for it, e.g. for all pages of a compressed table.
+ *
+ * A slot is a whole number of SLOT_SIZE byte units. It starts with the size of the compressed page, a page that does
+ * not compress is kept as it is. A page that is written again stays in its slot if it still needs as many units, and
+ * moves to the smallest free slot that is large enough, or to the end of the data file, otherwise. The rest of a
+ * larger slot stays free. The free slots are found again from the gaps between the slots in use when the store is
+ * opened.
+ *
+ * The page-to-slot map has an entry per page id, the slot and whether compression is enabled for the page. It is
+ * kept in its own file, stamped with a header page like the free space map, and written back by Sync. A slot given up
+ * by a page is not reused before the map is written, so a map that is older than the data file after a crash still
+ * points at intact slots.
+ *
+ * The files are only created once compression is enabled for a page.
+ */
+class CompressedPageStore {
+ public:
+  /** Unit of the slot sizes, in byte. */
+  static constexpr size_t SLOT_SIZE = 256;
+
+  /** Version of the format of the map and data files. */
+  static constexpr uint32_t FORMAT_VERSION = 1;
+
+  /**
+   * Opens the store of a database, if it has one.
+   * @param map_file the file name of the page-to-slot map
+   * @param data_file the file name of the data file
+   * @param read_only true to open the files read-only, compression cannot be enabled then
+   * @param discard true to delete the files of a store left behind, e.g. for a new database
+   * @throws Exception if the files cannot be opened or have another format version or page size
+   */
+  CompressedPageStore(std::string map_file, std::string data_file, bool read_only, bool discard);
+
+  ~CompressedPageStore();
+
+  /** Writes the map back and closes the files. */
+  void Close();
+
+  /** @return true once the files are open, a store that is not in use stores no page */
+  bool InUse() const { return in_use_.load(std::memory_order_acquire); }
+
+  /**
+   * Enables or disables compression for a page. A page that is disabled stays in the store until it is next written,
+   * then it goes to the tablespace.
+   * @param page_id id of the page
+   * @param enabled true to store the page from its next write on
+   * @throws Exception if the files cannot be created
+   */
+  void SetEnabled(page_id_t page_id, bool enabled);
+
+  /**
+   * @param page_id id of the page
+   * @return true if compression is enabled for the page
+   */
+  bool IsEnabled(page_id_t page_id);
+
+  /**
+   * @param page_id id of the page
+   * @return true if the page is kept in a slot of the store
+   */
+  bool IsStored(page_id_t page_id);
+
+  /**
+   * Reads a page from its slot.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @return false if the slot could not be read or decompressed
+   */
+  bool Read(page_id_t page_id, char *page_data);
+
+  /**
+   * Compresses a page and writes it to its slot.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return false if the slot could not be written
+   */
+  bool Write(page_id_t page_id, const char *page_data);
+
+  /**
+   * Gives up the slot of a page, and disables compression for it.
+   * @param page_id id of the page
+   */
+  void Free(page_id_t page_id);
+
+  /**
+   * Makes the slots written so far and the map durable. The slots given up before become free.
+   */
+  void Sync();
+
+  /** @return the size of the data file, in byte */
+  int64_t GetDataSize();
+
+  /** @return a snapshot of the counters */
+  CompressionStats GetStats() const;
+
+ private:
+  /** Number of map entries in one page of its file. */
+  static constexpr size_t ENTRIES_PER_PAGE = PAGE_SIZE / sizeof(uint64_t);
+  /** A map entry is the slot offset in units, shifted by UNIT_BITS, the number of units and the enabled bit. */
+  static constexpr int UNIT_BITS = 8;
+  static constexpr uint64_t UNITS_MASK = (uint64_t{1} << UNIT_BITS) - 1;
+  static constexpr uint64_t ENABLED_BIT = uint64_t{1} << 63;
+
+  /**
+   * Opens the files and reads the map, or creates new files, with latch_ held.
+   * @param create true to create new files
+   * @throws Exception if the files cannot be opened or have another format version or page size
+   */
+  void Open(bool create);
+  /** @return the entry of a page, 0 past the end of the map, with latch_ held */
+  uint64_t GetEntry(page_id_t page_id) const;
+  /** Sets the entry of a page, with latch_ held. */
+  void SetEntry(page_id_t page_id, uint64_t entry);
+  /**
+   * Takes the smallest free slot of at least the given number of units, or one at the end of the data file, with
+   * latch_ held.
+   * @return the offset of the slot, in units
+   */
+  uint64_t AllocateSlot(uint64_t units);
+  /** Writes the changed pages of the map to its file, with latch_ held. */
+  void WriteMap();
+
+  std::string map_name_;
+  std::string data_name_;
+  bool read_only_;
+  int map_fd_{-1};
+  int data_fd_{-1};
+  std::atomic<bool> in_use_{false};
+  // protects the map and the slots
+  std::mutex latch_;
+  std::vector<uint64_t> map_;
+  // set for the pages of the map changed since they were last written
+  std::vector<bool> map_dirty_;
+  // free_slots_[u] holds the offsets, in units, of the free slots of u units
+  std::vector<std::vector<uint64_t>> free_slots_;
+  // the slots given up since the map was last written, offset and number of units
+  std::vector<std::pair<uint64_t, uint64_t>> released_slots_;
+  // end of the data file, in units
+  uint64_t data_units_{0};
+  std::atomic<uint64_t> pages_written_{0};
+  std::atomic<uint64_t> pages_read_{0};
+  std::atomic<uint64_t> stored_bytes_{0};
+  std::atomic<uint64_t> compress_ns_{0};
+  std::atomic<uint64_t> decompress_ns_{0};
+};
+
+}  // namespace bustub
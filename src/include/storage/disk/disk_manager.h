@@ -13,38 +13,181 @@
 #pragma once
 
 #include <atomic>
-#include <fstream>
+#include <condition_variable>  // NOLINT
+#include <functional>
 #include <future>  // NOLINT
 #include <mutex>   // NOLINT
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
 #include "common/config.h"
+#include "storage/disk/compressed_page_store.h"
+#include "storage/disk/tablespace.h"
 
 namespace bustub {
 
+class IoUring;
+
+/** How a disk manager opens the database. */
+enum class DiskManagerMode {
+  /** The pages are read and written with system calls, the files are created if they do not exist. */
+  READ_WRITE,
+  /** The existing database is mapped into memory read-only, e.g. for a replica that only runs queries. */
+  READ_ONLY,
+};
+
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Pages are read and written with pread/pwrite at their offset, so any number of threads can do page I/O at the same
+ * time without a latch. Writes go to the OS page cache, Sync makes them durable.
+ *
+ * The pages are stored in a tablespace, the database file by default. A striped tablespace spreads them over one file
+ * per directory given, see Tablespace. Its layout is stamped into the free space map, and the database must be opened
+ * with the same number of directories and stripe size again.
+ *
+ * In direct I/O mode the database file is opened with O_DIRECT and page I/O bypasses the OS page cache, which would
+ * otherwise hold a second copy of what the buffer pool caches. Every page buffer must then be aligned to
+ * DIRECT_IO_ALIGNMENT, as the frames of a buffer pool are.
+ *
+ * Pages are allocated from a free space map, a bitmap with a bit per page kept in its own file next to the database
+ * file. Allocation takes the lowest free page, so deleted pages are reused before the file grows and the pages
+ * allocated in a row fill a free extent front to back. The map is written back by Sync, but the bit of a deleted page
+ * that is reused is made durable right away, so that a crash never leaves a page in use marked free. The map stamps the
+ * end of the pages ever allocated, only the pages of the file past it are recovered as allocated on startup. The map's
+ * file starts with a header page that stamps the on-disk format version of the database, a database of another version
+ * is refused when it is opened, and so is a database that has pages but no map.
+ *
+ * The database files are not grown one page write at a time. When a page past the space reserved so far is allocated,
+ * the next extent of db_extent_size bytes of its file is preallocated with fallocate, so that the file system lays it
+ * out in one piece and the writes of new pages do not allocate blocks. The reservation keeps the file size, which
+ * still ends at the last page written.
+ *
+ * The asynchronous page and log I/O goes through an io_uring instance, so that a caller can keep many I/Os in flight
+ * instead of blocking on each. The requests are queued and submitted together by SubmitIO, and a completion thread
+ * runs their callbacks. Where io_uring is not available, the asynchronous calls do their I/O right away and run the
+ * callback before returning.
+ *
+ * Pages can be compressed on disk. Compression is enabled page by page, e.g. for the pages of a compressed table,
+ * and a page it is enabled for is written to and read from a CompressedPageStore next to the database file instead of
+ * the tablespace. The other pages take no detour.
+ *
+ * In read-only mode the files of the tablespace are mapped into memory as they are when the disk manager is created,
+ * and a page is read by copying it out of the mapping, or not copied at all by GetMappedPage. Opening costs no I/O, and
+ * the OS page cache caches the pages for all read-only instances on the host. Everything that would change the
+ * database throws.
  */
 class DiskManager {
  public:
+  /** Called with true once an asynchronous I/O is done, with false if it failed. */
+  using IOCallback = std::function<void(bool)>;
+
+  /** Alignment of the page buffers in direct I/O mode, it covers the logical block size of common devices. */
+  static constexpr size_t DIRECT_IO_ALIGNMENT = PAGE_SIZE;
+
+  /** Version of the on-disk format. Version 2 has 64-bit page ids and LSNs in the page and log record layouts. */
+  static constexpr uint32_t FORMAT_VERSION = 2;
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
+   * @param direct_io true to bypass the OS page cache, the disk manager falls back to buffered I/O if the file
+   * system does not support it
+   * @throws Exception if the database has another format version or page size
+   */
+  explicit DiskManager(const std::string &db_file, bool direct_io = false);
+
+  /**
+   * Creates a new disk manager that stripes the pages over one file per directory.
+   * @param db_file the file name of the database, the log and the free space map are kept next to it and the files
+   * of the tablespace are named after it
+   * @param directories one directory per file of the tablespace, none to keep the pages in db_file
+   * @param direct_io true to bypass the OS page cache, the disk manager falls back to buffered I/O if the file
+   * system does not support it
+   * @param stripe_size size of a stripe in byte, a multiple of PAGE_SIZE
+   * @param mode READ_ONLY to map the existing database read-only, direct_io is ignored then
+   * @throws Exception if the database has another format version, page size or tablespace layout, or if it does not
+   * exist in read-only mode
    */
-  explicit DiskManager(const std::string &db_file);
+  DiskManager(const std::string &db_file, const std::vector<std::string> &directories, bool direct_io = false,
+              size_t stripe_size = TABLESPACE_STRIPE_SIZE, DiskManagerMode mode = DiskManagerMode::READ_WRITE);
 
-  ~DiskManager() = default;
+  /**
+   * Creates a new disk manager for a database file in the given mode.
+   * @param db_file the file name of the database file
+   * @param mode READ_ONLY to map the existing database file read-only
+   * @throws Exception if the database has another format version or page size, or if it does not exist in read-only
+   * mode
+   */
+  DiskManager(const std::string &db_file, DiskManagerMode mode);
+
+  ~DiskManager();
 
   /**
    * Shut down the disk manager and close all the file resources.
    */
   void ShutDown();
 
+  /**
+   * Allocate a page, the lowest free one of the instance. A page that was in use before reads as zeroes again, unless
+   * the caller writes it itself. Reusing a deleted page syncs its bit in the free space map.
+   * @param num_instances number of buffer pool instances sharing the page id space
+   * @param instance_index the page id p of the allocated page has p % num_instances == instance_index
+   * @param zero_fill false if the caller writes the whole page, e.g. a buffer pool writing back a zeroed frame
+   * @return id of the allocated page
+   * @throws Exception in read-only mode
+   */
+  page_id_t AllocatePage(uint32_t num_instances = 1, uint32_t instance_index = 0, bool zero_fill = true);
+
+  /**
+   * Deallocate a page, so that it can be allocated again. Deallocating a free page does nothing.
+   * @param page_id id of the page
+   * @throws Exception in read-only mode
+   */
+  void DeallocatePage(page_id_t page_id);
+
+  /**
+   * @param page_id id of the page
+   * @return true if the page is allocated
+   */
+  bool IsPageAllocated(page_id_t page_id);
+
+  /** @return the number of pages allocated */
+  size_t GetNumAllocatedPages();
+
+  /** @return the space reserved for the database files, in byte, the sum of their sizes if nothing is reserved */
+  int64_t GetReservedSize();
+
+  /**
+   * Enables or disables compression for a page, from its next write on.
+   * @param page_id id of the page
+   * @param compressed true to keep the page compressed on disk
+   * @throws Exception in read-only mode
+   */
+  void SetPageCompression(page_id_t page_id, bool compressed);
+
+  /**
+   * @param page_id id of the page
+   * @return true if compression is enabled for the page
+   */
+  bool IsPageCompressed(page_id_t page_id) { return compressed_store_->IsEnabled(page_id); }
+
+  /** @return the counters of the compressed pages written and read */
+  CompressionStats GetCompressionStats() const { return compressed_store_->GetStats(); }
+
+  /** @return the size of the file of the compressed pages, in byte */
+  int64_t GetCompressedDataSize() { return compressed_store_->GetDataSize(); }
+
+  /** @return the tablespace the pages are stored in */
+  const Tablespace &GetTablespace() const { return *tablespace_; }
+
   /**
    * Write a page to the database file.
    * @param page_id id of the page
    * @param page_data raw page data
+   * @throws Exception if the buffer is not aligned in direct I/O mode, or in read-only mode
    */
   void WritePage(page_id_t page_id, const char *page_data);
 
@@ -52,13 +195,114 @@ class DiskManager {
    * Read a page from the database file.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @throws Exception if the buffer is not aligned in direct I/O mode
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Hands out a page of a read-only database without copying it. The page stays valid and unchanged for the lifetime
+   * of the disk manager, and must not be written to.
+   * @param page_id id of the page
+   * @return the page in the mapping of the database, nullptr if the database is not read-only or the page is past the
+   * end of the database
+   */
+  const char *GetMappedPage(page_id_t page_id) const;
+
+  /**
+   * Tells the OS how a range of pages is about to be accessed, e.g. that a scan reads them in order. Read-only mode
+   * hints the mapping with madvise, the other modes drop the hint, the buffer pool reads ahead on its own.
+   * @param page_id id of the first page, INVALID_PAGE_ID is ignored
+   * @param num_pages number of pages, 0 for all pages from page_id on
+   * @param hint the access pattern
+   */
+  void Advise(page_id_t page_id, size_t num_pages, AccessHint hint) const;
+
+  /**
+   * Read a batch of pages from the database file. The pages are read in page id order, a run of consecutive pages
+   * with one call.
+   * @param page_ids ids of the pages
+   * @param[out] page_data output buffers, one per page id
+   * @return false if a read failed
+   */
+  bool ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data);
+
+  /**
+   * Write a batch of pages to the database file. The pages are written in page id order, a run of consecutive pages
+   * with one call.
+   * @param page_ids ids of the pages
+   * @param page_data raw page data, one buffer per page id
+   * @return false if a write failed
+   * @throws Exception in read-only mode
+   */
+  bool WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data);
+
+  /**
+   * Makes the pages written so far, the free space map and the log durable, e.g. at a checkpoint or at shutdown.
+   */
+  void Sync();
+
+  /**
+   * Queue an asynchronous read of a page. The buffer must stay valid until the callback is run.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @param callback run on the completion thread once the read is done, it must not wait for asynchronous I/O
+   * @throws Exception if the buffer is not aligned in direct I/O mode
+   */
+  void ReadPageAsync(page_id_t page_id, char *page_data, IOCallback callback);
+
+  /**
+   * Queue an asynchronous read of a page. Call SubmitIO before waiting for the future.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer, it must stay valid until the future is ready
+   * @return a future of the success of the read
+   */
+  std::future<bool> ReadPageAsync(page_id_t page_id, char *page_data);
+
+  /**
+   * Queue an asynchronous write of a page. The page data must stay unchanged until the callback is run.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @param callback run on the completion thread once the write is done, it must not wait for asynchronous I/O
+   * @throws Exception if the buffer is not aligned in direct I/O mode, or in read-only mode
+   */
+  void WritePageAsync(page_id_t page_id, const char *page_data, IOCallback callback);
+
+  /**
+   * Queue an asynchronous write of a page. Call SubmitIO before waiting for the future.
+   * @param page_id id of the page
+   * @param page_data raw page data, it must stay unchanged until the future is ready
+   * @return a future of the success of the write
+   */
+  std::future<bool> WritePageAsync(page_id_t page_id, const char *page_data);
+
+  /**
+   * Queue an asynchronous append to the log file. Its place in the log is taken when it is queued, so the log
+   * entries are in the order of the calls whatever order the writes complete in.
+   * @param log_data raw log data, it must stay unchanged until the callback is run
+   * @param size size of the log data
+   * @param callback run on the completion thread once the write is done, it must not wait for asynchronous I/O
+   * @throws Exception in read-only mode
+   */
+  void WriteLogAsync(const char *log_data, int size, IOCallback callback);
+
+  /**
+   * Queue an asynchronous append to the log file. Call SubmitIO before waiting for the future.
+   * @param log_data raw log data, it must stay unchanged until the future is ready
+   * @param size size of the log data
+   * @return a future of the success of the write
+   */
+  std::future<bool> WriteLogAsync(const char *log_data, int size);
+
+  /**
+   * Submits the queued asynchronous I/O to the kernel with one system call.
+   */
+  void SubmitIO();
+
+  /**
+   * Flush the entire log buffer into disk, it is durable once this returns.
    * @param log_data raw log data
    * @param size size of log entry
+   * @throws Exception in read-only mode
    */
   void WriteLog(char *log_data, int size);
 
@@ -69,7 +313,13 @@ class DiskManager {
    * @param offset offset of the log entry in the file
    * @return true if the read was successful, false otherwise
    */
-  bool ReadLog(char *log_data, int size, int offset);
+  bool ReadLog(char *log_data, int size, int64_t offset);
+
+  /** @return true if page I/O bypasses the OS page cache */
+  bool IsDirectIO() const { return direct_io_; }
+
+  /** @return true if the database is mapped read-only */
+  bool IsReadOnly() const { return tablespace_ != nullptr && tablespace_->IsReadOnly(); }
 
   /** @return the number of disk flushes */
   int GetNumFlushes() const;
@@ -90,19 +340,152 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
-  int GetFileSize(const std::string &file_name);
-  // stream to write log file
-  std::fstream log_io_;
+  /** Number of pages whose bits one page of the free space map holds. */
+  static constexpr size_t FSM_BITS_PER_PAGE = PAGE_SIZE * 8;
+
+  /**
+   * Reads the free space map, or starts a new one for a new database file. The pages of the database file past the
+   * end stamped in the map are taken as allocated, e.g. the pages written since the map was last synced.
+   * @param new_db_file true if the database file was just created
+   * @throws Exception if the header page of the map stamps another format version, page size or tablespace layout,
+   * or if a database that is not empty has no map
+   */
+  void LoadFreeSpaceMap(bool new_db_file);
+  /** Sets or clears the bit of a page in the free space map, with fsm_latch_ held. */
+  void SetAllocated(page_id_t page_id, bool allocated);
+  /** Writes the changed pages of the free space map to its file, then stamps the end of the allocated pages. */
+  void WriteFreeSpaceMap();
+  /**
+   * Writes one page of the free space map to its file and syncs it, if it changed since it was last written.
+   * @param index index of the page in the map
+   */
+  void SyncFreeSpaceMapPage(size_t index);
+  /**
+   * Writes the changed pages of the free space map in a range to its file and syncs it, with fsm_write_latch_ held.
+   * The pages are copied with fsm_latch_ held and written without it.
+   * @param first index of the first page in the map
+   * @param last index one past the last page
+   * @return false on an I/O error
+   */
+  bool WriteFreeSpaceMapPages(size_t first, size_t last);
+  /**
+   * Writes the header page of the free space map.
+   * @param end one past the last page allocated, the pages past it are recovered from the file size on startup
+   * @return false on an I/O error
+   */
+  bool WriteFreeSpaceMapHeader(page_id_t end);
+  /** Throws if the database is read-only. */
+  void CheckWritable() const;
+  /** An asynchronous I/O, from queued to completed. */
+  struct AsyncIO;
+  /**
+   * Throws if a page buffer is not aligned in direct I/O mode.
+   * @param page_data the buffers
+   * @param num_pages number of buffers
+   */
+  void CheckAlignment(const char *const *page_data, size_t num_pages) const;
+  /**
+   * Reads a run of consecutive pages, the compressed ones from the compressed page store and the others from the
+   * tablespace.
+   * @param page_id id of the first page
+   * @param[out] page_data output buffers, one per page
+   * @param num_pages number of pages in the run
+   */
+  bool ReadRun(page_id_t page_id, char *const *page_data, size_t num_pages);
+  /**
+   * Writes a run of consecutive pages, the compressed ones to the compressed page store and the others to the
+   * tablespace.
+   * @param page_id id of the first page
+   * @param page_data raw page data, one buffer per page
+   * @param num_pages number of pages in the run
+   */
+  bool WriteRun(page_id_t page_id, const char *const *page_data, size_t num_pages);
+  /**
+   * Reads a run of consecutive pages from the tablespace, with one call per file it spans. The part of the run past
+   * the end of the database reads as zeroes.
+   * @param page_id id of the first page
+   * @param[out] page_data output buffers, one per page
+   * @param num_pages number of pages in the run
+   */
+  bool ReadTablespaceRun(page_id_t page_id, char *const *page_data, size_t num_pages);
+  /**
+   * Writes a run of consecutive pages to the tablespace, with one call per file it spans.
+   * @param page_id id of the first page
+   * @param page_data raw page data, one buffer per page
+   * @param num_pages number of pages in the run
+   */
+  bool WriteTablespaceRun(page_id_t page_id, const char *const *page_data, size_t num_pages);
+  /** Raises the cached size of the database to cover a write ending at end, in byte of the page id space. */
+  void GrowFileSize(int64_t end);
+  /**
+   * Queues an asynchronous I/O, or does it right away if io_uring is not available.
+   * @param io the I/O, owned by the disk manager from here on
+   */
+  void QueueIO(AsyncIO *io);
+  /**
+   * Does an I/O synchronously, runs its callback and deletes it.
+   * @param io the I/O
+   */
+  void RunIO(AsyncIO *io);
+  /**
+   * Submits the queued I/O, with io_mutex_ held. If the submission fails, the queued I/O is taken back from the ring
+   * instead, for the caller to do synchronously with RunIO once it released io_mutex_.
+   * @param[out] failed receives the I/O taken back
+   * @return false if the submission failed
+   */
+  bool SubmitQueuedIO(std::vector<AsyncIO *> *failed);
+  /** Runs on the completion thread, completing the I/O in flight. */
+  void CompleteIO();
+  /** Waits for the asynchronous I/O in flight and stops the completion thread. */
+  void StopAsyncIO();
+  // file descriptor of the log file
+  int log_fd_{-1};
   std::string log_name_;
-  // stream to write db file
-  std::fstream db_io_;
+  // size of the log file, including the asynchronous appends in flight
+  std::atomic<int64_t> log_file_size_{0};
+  // the files the pages are stored in
+  Tablespace *tablespace_{nullptr};
+  // the pages compression is enabled for
+  CompressedPageStore *compressed_store_{nullptr};
+  // true if the tablespace was opened with O_DIRECT
+  bool direct_io_{false};
+  // end of the last page written, in byte of the page id space, kept up to date by the writes
+  std::atomic<int64_t> db_file_size_{0};
+  // file descriptor of the free space map
+  int fsm_fd_{-1};
+  std::string fsm_name_;
+  // protects the free space map
+  std::mutex fsm_latch_;
+  // keeps the writes of the free space map in order, taken before fsm_latch_
+  std::mutex fsm_write_latch_;
+  // bit p % 64 of word p / 64 is set if page p is allocated
+  std::vector<uint64_t> fsm_;
+  // set for the pages of the free space map changed since they were last written
+  std::vector<bool> fsm_dirty_;
+  // no word before this one has a clear bit
+  size_t fsm_first_free_word_{0};
+  // one past the last page ever allocated, a page allocated below it may be free in the map on disk
+  page_id_t fsm_end_{0};
+  // the end stamped in the header of the map on disk, with fsm_write_latch_ held
+  page_id_t fsm_synced_end_{0};
+  size_t num_allocated_pages_{0};
   std::string file_name_;
-  int num_flushes_;
-  int num_writes_;
+  std::atomic<int> num_flushes_;
+  std::atomic<int> num_writes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
-  // With multiple buffer pool instances, need to protect file access
-  // std::mutex db_io_latch_;
+  // the io_uring instance and its completion thread, started by the first asynchronous I/O
+  std::once_flag async_io_started_;
+  IoUring *io_uring_{nullptr};
+  std::thread *io_thread_{nullptr};
+  // protects the submission side of io_uring_ and the counts below
+  std::mutex io_mutex_;
+  std::condition_variable io_cv_;
+  std::condition_variable io_space_cv_;
+  // the I/O prepared but not submitted, and submitted but not completed
+  size_t io_queued_{0};
+  size_t io_in_flight_{0};
+  bool io_stop_{false};
 };
 
 }  // namespace bustub
\ No newline at end of file
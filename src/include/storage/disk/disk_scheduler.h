@@ -0,0 +1,190 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.h
+//
+// Identification: src/include/storage/disk/disk_scheduler.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <condition_variable>  // NOLINT
+#include <cstdint>
+#include <deque>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/config.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+/** Foreground requests, e.g. the read of a page a query waits for, are served before background ones. */
+enum class DiskRequestPriority { FOREGROUND = 0, BACKGROUND, NUM_PRIORITIES };
+
+/**
+ * A read or write of one page, scheduled with the DiskScheduler.
+ */
+struct DiskRequest {
+  /** True for a write, false for a read. */
+  bool is_write_;
+  /** The page buffer, it must stay valid (and unchanged for a write) until the request completes. */
+  char *data_;
+  /** Id of the page. */
+  page_id_t page_id_;
+  /** Set to true once the I/O is done, to false if it failed. */
+  std::promise<bool> callback_;
+  /** Requests of a priority are only served once no request of a higher one is waiting. */
+  DiskRequestPriority priority_{DiskRequestPriority::FOREGROUND};
+};
+
+/** Counters of a DiskScheduler. */
+struct DiskSchedulerStats {
+  /** Requests scheduled. */
+  uint64_t requests_{0};
+  /** Requests served together with an adjacent one, in one system call. */
+  uint64_t merged_requests_{0};
+  /** Requests waiting or in service right now. */
+  size_t queue_depth_{0};
+  /** The largest queue depth seen. */
+  size_t max_queue_depth_{0};
+};
+
+/**
+ * DiskScheduler sits between the buffer pool and the DiskManager. Requests go into a queue per priority and a pool
+ * of worker threads serves them, so that the caller decides whether and when to wait for the I/O.
+ *
+ * There is one set of queues per file of the tablespace, each with its own workers, so that the files of a striped
+ * tablespace are busy at the same time and a slow device does not hold up the requests for the others.
+ *
+ * A worker takes the oldest request of the highest priority waiting for its file, together with the waiting requests
+ * of the same priority and kind for the pages adjacent to it, and serves them with one vectored call.
+ *
+ * Requests for the same page may be served in any order, the caller waits for a write before it reads the page back.
+ */
+class DiskScheduler {
+ public:
+  /**
+   * Creates a new disk scheduler and starts its workers.
+   * @param disk_manager the disk manager doing the I/O
+   * @param num_workers number of worker threads, at least one. They are spread over the files of the tablespace, and
+   * each file gets one at least
+   */
+  DiskScheduler(DiskManager *disk_manager, size_t num_workers);
+
+  /**
+   * Serves the requests still waiting and stops the workers.
+   */
+  ~DiskScheduler();
+
+  /**
+   * Schedules a request.
+   * @param request the request
+   */
+  void Schedule(DiskRequest request);
+
+  /**
+   * Schedules a batch of requests at once, so that adjacent pages among them are merged.
+   * @param requests the requests, moved out of the vector
+   */
+  void Schedule(std::vector<DiskRequest> *requests);
+
+  /**
+   * Schedules the read of a page.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @param priority priority of the read
+   * @return a future of the success of the read
+   */
+  std::future<bool> ScheduleRead(page_id_t page_id, char *page_data,
+                                 DiskRequestPriority priority = DiskRequestPriority::FOREGROUND);
+
+  /**
+   * Schedules the write of a page.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @param priority priority of the write
+   * @return a future of the success of the write
+   */
+  std::future<bool> ScheduleWrite(page_id_t page_id, const char *page_data,
+                                  DiskRequestPriority priority = DiskRequestPriority::FOREGROUND);
+
+  /**
+   * Reads a page and waits for it, as a foreground request. If nothing is waiting, the calling thread reads the page
+   * itself instead of handing the read to a worker.
+   * @param page_id id of the page
+   * @param[out] page_data output buffer
+   * @return false if the read failed
+   */
+  bool ReadPage(page_id_t page_id, char *page_data);
+
+  /**
+   * Writes a page and waits for it, as a foreground request. If nothing is waiting, the calling thread writes the
+   * page itself instead of handing the write to a worker.
+   * @param page_id id of the page
+   * @param page_data raw page data
+   * @return false if the write failed
+   */
+  bool WritePage(page_id_t page_id, const char *page_data);
+
+  /** @return the number of requests waiting or in service */
+  size_t GetQueueDepth();
+
+  /** @return the counters of the scheduler */
+  DiskSchedulerStats GetStats();
+
+ private:
+  /** The requests waiting for one file of the tablespace. */
+  struct FileQueue {
+    std::array<std::deque<DiskRequest>, static_cast<size_t>(DiskRequestPriority::NUM_PRIORITIES)> by_priority_;
+    size_t num_waiting_{0};
+    std::condition_variable cv_;
+  };
+
+  /**
+   * Puts a request into the queue of its file, with latch_ held.
+   * @param request the request
+   * @return the queue
+   */
+  FileQueue *Enqueue(DiskRequest request);
+
+  /**
+   * Serves a request in the calling thread if nothing is waiting for its file, otherwise schedules it and waits.
+   * @param request the request
+   * @return the success of the I/O
+   */
+  bool ServeInline(DiskRequest request);
+
+  /**
+   * Runs on each worker thread, serving requests until the scheduler is destroyed.
+   * @param queue the queue of the file the worker serves
+   */
+  void RunWorker(FileQueue *queue);
+
+  /**
+   * Takes the next request and the waiting requests adjacent to it out of a queue, with latch_ held.
+   * @param queue the queue
+   * @param[out] run the requests to serve together
+   */
+  void TakeRun(FileQueue *queue, std::vector<DiskRequest> *run);
+
+  DiskManager *disk_manager_;
+  /** Protects everything below. */
+  std::mutex latch_;
+  /** One per file of the tablespace, it never changes size after construction. */
+  std::vector<FileQueue> queues_;
+  size_t num_waiting_{0};
+  size_t num_in_service_{0};
+  bool stop_{false};
+  DiskSchedulerStats stats_;
+  std::vector<std::thread> workers_;
+};
+
+}  // namespace bustub
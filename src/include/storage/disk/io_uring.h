@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.h
+//
+// Identification: src/include/storage/disk/io_uring.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <linux/io_uring.h>
+#include <sys/types.h>
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * IoUring is a minimal io_uring instance, set up and driven through the raw system calls so that it needs no
+ * library. Operations are prepared into the submission queue, submitted in batches with one system call, and their
+ * completions are taken from the completion queue without a system call when they are already there.
+ *
+ * The submission side (Prepare/Submit) must be serialized by the caller, and there must be a single consumer of the
+ * completion side (WaitCompletion/PopCompletion). The two sides may run concurrently. The caller also keeps the
+ * number of operations in flight within GetCompletionQueueSize(), so that no completion is dropped.
+ */
+class IoUring {
+ public:
+  /**
+   * Sets up a new io_uring instance. IsValid() tells whether it worked, e.g. the kernel may not support io_uring or
+   * it may be disabled.
+   * @param num_entries the size of the submission queue, rounded up to a power of two by the kernel
+   */
+  explicit IoUring(unsigned num_entries);
+
+  ~IoUring();
+
+  IoUring(const IoUring &) = delete;
+  IoUring &operator=(const IoUring &) = delete;
+
+  /** @return true if the instance is set up */
+  bool IsValid() const { return ring_fd_ >= 0; }
+
+  /** @return the number of completions the completion queue holds */
+  unsigned GetCompletionQueueSize() const { return cq_entries_; }
+
+  /**
+   * Queues a read or write of a buffer at a file offset. It is started by the next Submit.
+   * @param opcode IORING_OP_READ or IORING_OP_WRITE
+   * @param fd the file
+   * @param buffer the buffer
+   * @param size number of bytes
+   * @param offset offset in the file
+   * @param user_data handed back with the completion
+   * @return false if the submission queue is full
+   */
+  bool Prepare(uint8_t opcode, int fd, void *buffer, uint32_t size, off_t offset, uint64_t user_data);
+
+  /**
+   * Submits the queued operations with one system call.
+   * @return the number of operations submitted, or -errno
+   */
+  int Submit();
+
+  /**
+   * Takes back the last operation prepared and not submitted yet, e.g. because submitting keeps failing.
+   * @param[out] user_data the user data of the operation
+   * @return false if every prepared operation was submitted
+   */
+  bool Unprepare(uint64_t *user_data);
+
+  /**
+   * Waits until at least one completion is in the completion queue.
+   * @return 0, or -errno
+   */
+  int WaitCompletion();
+
+  /**
+   * Takes the next completion out of the completion queue.
+   * @param[out] user_data the user data of the operation
+   * @param[out] result the number of bytes transferred, or -errno
+   * @return false if the completion queue is empty
+   */
+  bool PopCompletion(uint64_t *user_data, int32_t *result);
+
+ private:
+  int ring_fd_{-1};
+  void *sq_ring_{nullptr};
+  size_t sq_ring_size_{0};
+  void *cq_ring_{nullptr};
+  size_t cq_ring_size_{0};
+  io_uring_sqe *sqes_{nullptr};
+  size_t sqes_size_{0};
+  unsigned *sq_head_{nullptr};
+  unsigned *sq_tail_{nullptr};
+  unsigned *sq_array_{nullptr};
+  unsigned sq_mask_{0};
+  unsigned sq_entries_{0};
+  unsigned *cq_head_{nullptr};
+  unsigned *cq_tail_{nullptr};
+  io_uring_cqe *cqes_{nullptr};
+  unsigned cq_mask_{0};
+  unsigned cq_entries_{0};
+  /** Operations prepared but not submitted yet. */
+  unsigned num_prepared_{0};
+};
+
+}  // namespace bustub
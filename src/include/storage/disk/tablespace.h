@@ -0,0 +1,182 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace.h
+//
+// Identification: src/include/storage/disk/tablespace.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <sys/types.h>
+
+#include <mutex>  // NOLINT
+#include <string>
+#include <vector>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/** How the pages of a range are about to be accessed, a hint for the OS page cache. */
+enum class AccessHint {
+  /** No particular order, the default. */
+  NORMAL,
+  /** In page id order, the OS reads ahead more and drops the pages read sooner. */
+  SEQUENTIAL,
+  /** Soon, the OS starts reading them in the background. */
+  WILLNEED,
+};
+
+/**
+ * Tablespace is the set of data files the pages of a database are stored in, and the mapping of page ids to them.
+ *
+ * A tablespace of one file keeps page p at offset p * PAGE_SIZE of the database file. A striped tablespace has one
+ * file per directory, e.g. one per device. The page id space is cut into stripes of stripe_size bytes, and the stripes
+ * are dealt out to the files round-robin. A run of pages within a stripe stays in one file at consecutive offsets, so
+ * it is still read or written with one call, while a scan or a flush spreads its I/O over all the files.
+ *
+ * Each file is preallocated in extents on its own, as the pages striped to it are allocated.
+ *
+ * A read-only tablespace maps its files into memory instead, as they are when it is opened, and the pages are read
+ * from the mappings. Nothing is read when it is opened, the OS page cache loads and caches the pages as they are used.
+ */
+class Tablespace {
+ public:
+  /**
+   * Opens the files of a tablespace, and creates those that do not exist.
+   * @param db_file the database file, it is the only file if no directories are given. Otherwise the file of directory
+   * i is named after it, e.g. dir/test.0.db for test.db
+   * @param directories one directory per file of a striped tablespace, none for a single file
+   * @param stripe_size size of a stripe in byte, a multiple of PAGE_SIZE
+   * @param direct_io true to open the files with O_DIRECT, the tablespace falls back to buffered I/O if the file
+   * system does not support it. It is ignored if read_only is set
+   * @param read_only true to open the existing files read-only and map them into memory
+   * @throws Exception if a file cannot be opened or mapped
+   */
+  Tablespace(const std::string &db_file, const std::vector<std::string> &directories, size_t stripe_size,
+             bool direct_io, bool read_only = false);
+
+  ~Tablespace();
+
+  /** Unmaps and closes the files. */
+  void Close();
+
+  /** @return the number of files */
+  size_t GetNumFiles() const { return files_.size(); }
+
+  /** @return the size of a stripe, in byte */
+  size_t GetStripeSize() const { return stripe_pages_ * PAGE_SIZE; }
+
+  /** @return true if none of the files existed before */
+  bool IsNew() const { return is_new_; }
+
+  /** @return true if the files were opened with O_DIRECT */
+  bool IsDirectIO() const { return direct_io_; }
+
+  /** @return true if the files are mapped read-only */
+  bool IsReadOnly() const { return read_only_; }
+
+  /**
+   * @param file index of the file
+   * @return the name of the file
+   */
+  const std::string &GetFileName(size_t file) const { return files_[file].name_; }
+
+  /**
+   * @param file index of the file
+   * @return the file descriptor of the file, -1 once the tablespace is closed
+   */
+  int GetFd(size_t file) const { return files_[file].fd_; }
+
+  /**
+   * @param page_id id of the page
+   * @return the index of the file holding the page
+   */
+  size_t GetFileIndex(page_id_t page_id) const;
+
+  /**
+   * @param page_id id of the page
+   * @return the offset of the page in its file
+   */
+  off_t GetFileOffset(page_id_t page_id) const;
+
+  /**
+   * @param page_id id of the first page of a run
+   * @param num_pages number of pages in the run
+   * @return how many pages of the run, at least one, are in the same file at consecutive offsets
+   */
+  size_t GetRunLength(page_id_t page_id, size_t num_pages) const;
+
+  /**
+   * @param page_id id of the page
+   * @return the page in the mapping of its file, nullptr if the tablespace is not read-only or the page is past the
+   * end of the file
+   */
+  const char *GetMappedPage(page_id_t page_id) const;
+
+  /**
+   * Tells the OS how a range of pages is about to be accessed. The hint goes to the mappings of a read-only
+   * tablespace, it is dropped otherwise.
+   * @param page_id id of the first page
+   * @param num_pages number of pages, 0 for all pages from page_id on
+   * @param hint the access pattern
+   */
+  void Advise(page_id_t page_id, size_t num_pages, AccessHint hint) const;
+
+  /** @return the end of the last page stored in any of the files, in byte of the page id space */
+  int64_t GetSize() const;
+
+  /**
+   * Preallocates the file holding a page up to the end of the extent of extent_size bytes the page is in.
+   * @param page_id id of the page
+   * @param extent_size size of an extent in byte, 0 to not preallocate
+   */
+  void Reserve(page_id_t page_id, size_t extent_size);
+
+  /** @return the space reserved for the files, in byte, the sum of their sizes if nothing is reserved */
+  int64_t GetReservedSize();
+
+  /**
+   * Makes what was written to the files durable.
+   * @return false if a file could not be synced
+   */
+  bool Sync();
+
+ private:
+  struct DataFile {
+    std::string name_;
+    int fd_;
+    // size of the file when it was opened
+    int64_t size_;
+    // the file is preallocated up to here
+    int64_t reserved_size_;
+    // the first size_ bytes of the file, read-only, nullptr if the tablespace is not read-only or the file is empty
+    char *mapping_;
+  };
+
+  /**
+   * Opens all files.
+   * @param direct_io true to open them with O_DIRECT
+   * @param read_only true to open the existing files read-only
+   * @return false if O_DIRECT is not supported, the files are closed again then
+   * @throws Exception if a file cannot be opened
+   */
+  bool Open(bool direct_io, bool read_only);
+
+  std::vector<DataFile> files_;
+  size_t stripe_pages_;
+  bool is_new_{true};
+  bool direct_io_{false};
+  bool read_only_;
+  // protects the reservations
+  std::mutex latch_;
+  // false once fallocate turned out to be unsupported
+  bool preallocate_{true};
+};
+
+}  // namespace bustub
@@ -10,6 +10,7 @@
 //===----------------------------------------------------------------------===//
 #pragma once
 
+#include <fstream>
 #include <queue>
 #include <string>
 #include <vector>
@@ -90,8 +91,13 @@ class BPlusTree {
   void ReleaseAllLatch(Transaction *transaction, bool is_write);
   BPlusTreePage *AcquireReadLatch(const KeyType &key, Transaction *transaction);
   BPlusTreePage *AcquireWriteLatch(const KeyType &key, Transaction *transaction);
+  // Same result as AcquireReadLatch, but internal pages are read optimistically instead of being latched.
+  BPlusTreePage *AcquireOptimisticReadLatch(const KeyType &key, Transaction *transaction);
 
  private:
+  // Optimistic descents that a concurrent writer invalidates before falling back to AcquireReadLatch.
+  static constexpr int OPTIMISTIC_READ_RETRIES = 3;
+
   bool StartNewTree(const KeyType &key, const ValueType &value);
 
   bool InsertIntoLeaf(const KeyType &key, const ValueType &value, Transaction *transaction);
@@ -19,7 +19,7 @@
 namespace bustub {
 
 #define B_PLUS_TREE_LEAF_PAGE_TYPE BPlusTreeLeafPage<KeyType, ValueType, KeyComparator>
-#define LEAF_PAGE_HEADER_SIZE 28
+#define LEAF_PAGE_HEADER_SIZE 48
 #define LEAF_PAGE_SIZE ((PAGE_SIZE - LEAF_PAGE_HEADER_SIZE) / sizeof(MappingType))
 
 /**
@@ -32,12 +32,12 @@ namespace bustub {
  * | HEADER | KEY(1) + RID(1) | KEY(2) + RID(2) | ... | KEY(n) + RID(n)
  *  ----------------------------------------------------------------------
  *
- *  Header format (size in byte, 28 bytes in total):
+ *  Header format (size in byte, 48 bytes in total):
  *  ---------------------------------------------------------------------
- * | PageType (4) | LSN (4) | CurrentSize (4) | MaxSize (4) |
+ * | PageType (4) | CurrentSize (4) | LSN (8) | MaxSize (4) | Unused (4) |
  *  ---------------------------------------------------------------------
  *  -----------------------------------------------
- * | ParentPageId (4) | PageId (4) | NextPageId (4)
+ * | ParentPageId (8) | PageId (8) | NextPageId (8)
  *  -----------------------------------------------
  */
 INDEX_TEMPLATE_ARGUMENTS
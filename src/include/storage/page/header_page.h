@@ -23,7 +23,7 @@ namespace bustub {
  *
  * Format (size in byte):
  *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
+ * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (8) | ... |
  *  -----------------------------------------------------------------
  */
 class HeaderPage : public Page {
@@ -47,5 +47,9 @@ class HeaderPage : public Page {
   int FindRecord(const std::string &name);
 
   void SetRecordCount(int record_count);
+
+  static constexpr size_t OFFSET_RECORDS = 4;
+  static constexpr size_t SIZE_NAME = 32;
+  static constexpr size_t SIZE_RECORD = SIZE_NAME + sizeof(page_id_t);
 };
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <cstring>
 #include <iostream>
 #include <sstream>
@@ -26,6 +27,9 @@ namespace bustub {
  * wrapper for actual data pages being held in main memory. Page also contains
  * book-keeping information that is used by the buffer pool manager, e.g. pin
  * count, dirty flag, page id, etc.
+ *
+ * The page data itself lives in the buffer pool's frame arena, so that the array
+ * of Page objects only holds the book-keeping information and stays dense.
  */
 class Page {
   // There is book-keeping information inside the page that should only be
@@ -33,8 +37,8 @@ class Page {
   friend class BufferPoolManager;
 
  public:
-  /** Constructor. Zeros out the page data. */
-  Page() { ResetMemory(); }
+  /** Constructor. The buffer pool manager attaches the page to a frame of its arena. */
+  Page() = default;
 
   /** Default destructor. */
   ~Page() = default;
@@ -46,17 +50,29 @@ class Page {
   inline page_id_t GetPageId() { return page_id_; }
 
   /** @return the pin count of this page */
-  inline int GetPinCount() { return pin_count_; }
+  inline int GetPinCount() {
+    int pin_count = pin_count_;
+    // A negative count marks a free frame or one being reassigned by the buffer pool manager.
+    return pin_count < 0 ? 0 : pin_count;
+  }
 
   /** @return true if the page in memory has been modified from the page on
    * disk, false otherwise */
   inline bool IsDirty() { return is_dirty_; }
 
   /** Acquire the page write latch. */
-  inline void WLatch() { rwlatch_.WLock(true); }
+  inline void WLatch() {
+    rwlatch_.WLock(true);
+    // The version is odd while the page is write latched.
+    version_.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_release);
+  }
 
   /** Release the page write latch. */
-  inline void WUnlatch() { rwlatch_.WUnlock(); }
+  inline void WUnlatch() {
+    version_.fetch_add(1, std::memory_order_release);
+    rwlatch_.WUnlock();
+  }
 
   /** Acquire the page read latch. */
   inline void RLatch() { rwlatch_.RLock(); }
@@ -66,6 +82,23 @@ class Page {
 
   inline bool IsWriteLatch() { return rwlatch_.IsWriteLock(); }
 
+  /**
+   * Starts an optimistic read. The page is then read without any latch, and the result may only be used once
+   * ValidateVersion confirms that no writer latched the page in the meantime. The caller must hold a pin.
+   * @return the current page version
+   */
+  inline uint64_t ReadVersion() { return version_.load(std::memory_order_acquire); }
+
+  /**
+   * Ends an optimistic read.
+   * @param version the version ReadVersion returned
+   * @return true if the page was not write latched at or since ReadVersion, i.e. what was read is consistent
+   */
+  inline bool ValidateVersion(uint64_t version) {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return (version & 1) == 0 && version_.load(std::memory_order_relaxed) == version;
+  }
+
   /** @return the page LSN. */
   inline lsn_t GetLSN() { return *reinterpret_cast<lsn_t *>(GetData() + OFFSET_LSN); }
 
@@ -84,28 +117,31 @@ class Page {
   }
 
  protected:
-  static_assert(sizeof(page_id_t) == 4);
-  static_assert(sizeof(lsn_t) == 4);
+  static_assert(sizeof(page_id_t) == 8);
+  static_assert(sizeof(lsn_t) == 8);
 
-  static constexpr size_t SIZE_PAGE_HEADER = 8;
+  static constexpr size_t SIZE_PAGE_HEADER = 16;
   static constexpr size_t OFFSET_PAGE_START = 0;
-  static constexpr size_t OFFSET_LSN = 4;
+  static constexpr size_t OFFSET_LSN = 8;
 
  private:
   /** Zeroes out the data that is held within the page. */
   inline void ResetMemory() { memset(data_, OFFSET_PAGE_START, PAGE_SIZE); }
 
-  /** The actual data that is stored within a page. */
-  char data_[PAGE_SIZE]{};
+  /** The actual data that is stored within a page, PAGE_SIZE bytes in the frame arena. */
+  char *data_{nullptr};
   /** The ID of this page. */
   page_id_t page_id_ = INVALID_PAGE_ID;
-  /** The pin count of this page. */
-  int pin_count_ = 0;
+  /** The pin count of this page. The buffer pool manager pins pages found in its page table without holding its latch,
+   * and sets the count to -1 while the frame is free or being reassigned so that such a pin fails. */
+  std::atomic<int> pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding
    * page on disk. */
-  bool is_dirty_ = false;
+  std::atomic<bool> is_dirty_ = false;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
+  /** Bumped when the write latch is taken and again when it is released, for optimistic readers. */
+  std::atomic<uint64_t> version_{0};
 };
 
 }  // namespace bustub
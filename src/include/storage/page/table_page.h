@@ -34,7 +34,7 @@ namespace bustub {
  *
  *  Header format (size in bytes):
  *  ----------------------------------------------------------------------------
- *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
+ *  | PageId (8)| LSN (8)| PrevPageId (8)| NextPageId (8)| FreeSpacePointer(4) |
  *  ----------------------------------------------------------------------------
  *  ----------------------------------------------------------------
  *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
@@ -141,16 +141,16 @@ class TablePage : public Page {
   bool GetNextTupleRid(const RID &cur_rid, RID *next_rid);
 
  private:
-  static_assert(sizeof(page_id_t) == 4);
+  static_assert(sizeof(page_id_t) == 8);
 
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 40;
   static constexpr size_t SIZE_TUPLE = 8;
-  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
-  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
-  static constexpr size_t OFFSET_FREE_SPACE = 16;
-  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 16;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 24;
+  static constexpr size_t OFFSET_FREE_SPACE = 32;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 36;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 40;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = 44;
 
   /** @return pointer to the end of the current free space, see header comment
    */
@@ -15,7 +15,7 @@ namespace bustub {
  * TmpTuplePage format:
  *
  * Sizes are in bytes.
- * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 |
+ * | PageId (8) | LSN (8) | FreeSpace (4) | (free space) | TupleSize2 |
  * TupleData2 | TupleSize1 | TupleData1 |
  *
  * We choose this format because DeserializeExpression expects to read Size
@@ -30,7 +30,7 @@ class TmpTuplePage : public Page {
   bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
 
  private:
-  static_assert(sizeof(page_id_t) == 4);
+  static_assert(sizeof(page_id_t) == 8);
 };
 
 }  // namespace bustub
@@ -31,7 +31,7 @@ class TableHeap {
   ~TableHeap() = default;
 
   /**
-   * Create a table heap without a transaction. (open table)
+   * Create a table heap without a transaction. (open table) The table is compressed if its first page is.
    * @param buffer_pool_manager the buffer pool manager
    * @param lock_manager the lock manager
    * @param log_manager the log manager
@@ -46,9 +46,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param compressed true to keep the pages of the table compressed on disk
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, bool compressed = false);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size),
@@ -56,9 +57,10 @@ class TableHeap {
    * @param tuple tuple to insert
    * @param[out] rid the rid of the inserted tuple
    * @param txn the transaction performing the insert
+   * @param strategy access strategy of a bulk load, nullptr to go through the whole buffer pool
    * @return true iff the insert is successful
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /**
    * Mark the tuple as deleted. The actual delete will occur when ApplyDelete is
@@ -102,8 +104,12 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
-  /** @return the begin iterator of this table */
-  TableIterator Begin(Transaction *txn);
+  /**
+   * @param txn the transaction performing the scan
+   * @param strategy access strategy of the scan, nullptr to go through the whole buffer pool
+   * @return the begin iterator of this table
+   */
+  TableIterator Begin(Transaction *txn, BufferAccessStrategy *strategy = nullptr);
 
   /** @return the end iterator of this table */
   TableIterator End();
@@ -111,11 +117,21 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return true if the pages of this table are kept compressed on disk */
+  inline bool IsCompressed() const { return compressed_; }
+
  private:
+  /** Fetches a page of this table, through the strategy's ring if there is one. */
+  Page *FetchPage(page_id_t page_id, BufferAccessStrategy *strategy);
+
+  /** Creates a new page for this table, in the strategy's ring if there is one, compressed if the table is. */
+  Page *NewPage(page_id_t *page_id, BufferAccessStrategy *strategy);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  bool compressed_;
 };
 
 }  // namespace bustub
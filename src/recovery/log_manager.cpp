@@ -36,10 +36,10 @@ void LogManager::StopFlushThread() {}
  *
  *
  * example below
- * // First, serialize the must have fields(20 bytes in total)
+ * // First, serialize the must have fields(28 bytes in total)
  * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
+ * memcpy(log_buffer_ + offset_, &log_record, 28);
+ * int pos = offset_ + 28;
  *
  * if (log_record.log_record_type_ == LogRecordType::INSERT) {
  *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
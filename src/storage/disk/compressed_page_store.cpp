@@ -0,0 +1,387 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_store.cpp
+//
+// Identification: src/storage/disk/compressed_page_store.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>  // NOLINT
+#include <cstring>
+#include <string>
+#include <utility>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "common/util/lz_codec.h"
+#include "storage/disk/compressed_page_store.h"
+
+namespace bustub {
+
+// "BUSTUBCM", the first bytes of a page-to-slot map file.
+static constexpr uint64_t MAP_MAGIC = 0x4d43425554535542ULL;
+
+// The first page of the map file, the pages of the map follow it.
+struct CompressedPageMapHeader {
+  uint64_t magic_;
+  uint32_t format_version_;
+  uint32_t page_size_;
+  uint32_t slot_size_;
+};
+
+// A slot starts with the size of the compressed page, PAGE_SIZE for a page that is kept as it is.
+using SlotHeader = uint32_t;
+
+// Most units a slot has, that of a page that does not compress.
+static constexpr size_t MAX_SLOT_UNITS =
+    (sizeof(SlotHeader) + PAGE_SIZE + CompressedPageStore::SLOT_SIZE - 1) / CompressedPageStore::SLOT_SIZE;
+
+/**
+ * Reads or writes size bytes at the given file offset, going on after interrupted and short transfers. A read stops
+ * at the end of the file.
+ * @return the number of bytes transferred, -1 on an I/O error
+ */
+static ssize_t Transfer(int fd, char *data, size_t size, off_t offset, bool write) {
+  size_t total = 0;
+  while (total < size) {
+    ssize_t n = write ? pwrite(fd, data + total, size - total, offset + total)
+                      : pread(fd, data + total, size - total, offset + total);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return n < 0 ? -1 : static_cast<ssize_t>(total);
+    }
+    total += n;
+  }
+  return static_cast<ssize_t>(total);
+}
+
+static uint64_t ElapsedNanos(std::chrono::steady_clock::time_point start) {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+CompressedPageStore::CompressedPageStore(std::string map_file, std::string data_file, bool read_only, bool discard)
+    : map_name_(std::move(map_file)), data_name_(std::move(data_file)), read_only_(read_only) {
+  if (discard && !read_only_) {
+    unlink(map_name_.c_str());
+    unlink(data_name_.c_str());
+    return;
+  }
+  struct stat stat_buf;
+  if (stat(map_name_.c_str(), &stat_buf) == 0) {
+    std::lock_guard<std::mutex> guard(latch_);
+    Open(false);
+  }
+}
+
+CompressedPageStore::~CompressedPageStore() { Close(); }
+
+void CompressedPageStore::Close() {
+  if (!InUse()) {
+    return;
+  }
+  Sync();
+  std::lock_guard<std::mutex> guard(latch_);
+  close(map_fd_);
+  close(data_fd_);
+  map_fd_ = data_fd_ = -1;
+  in_use_ = false;
+}
+
+void CompressedPageStore::Open(bool create) {
+  int flags = read_only_ ? O_RDONLY : O_RDWR | (create ? O_CREAT | O_TRUNC : 0);
+  map_fd_ = open(map_name_.c_str(), flags, 0644);
+  data_fd_ = open(data_name_.c_str(), flags, 0644);
+  if (map_fd_ < 0 || data_fd_ < 0) {
+    if (map_fd_ >= 0) {
+      close(map_fd_);
+    }
+    if (data_fd_ >= 0) {
+      close(data_fd_);
+    }
+    throw Exception("can't open compressed page store");
+  }
+  char header_page[PAGE_SIZE] = {};
+  auto *header = reinterpret_cast<CompressedPageMapHeader *>(header_page);
+  if (create) {
+    *header = {MAP_MAGIC, FORMAT_VERSION, PAGE_SIZE, SLOT_SIZE};
+    if (Transfer(map_fd_, header_page, PAGE_SIZE, 0, true) < static_cast<ssize_t>(PAGE_SIZE)) {
+      LOG_DEBUG("I/O error while writing the compressed page map");
+    }
+  } else if (Transfer(map_fd_, header_page, PAGE_SIZE, 0, false) < 0 || header->magic_ != MAP_MAGIC ||
+             header->format_version_ != FORMAT_VERSION || header->page_size_ != PAGE_SIZE ||
+             header->slot_size_ != SLOT_SIZE) {
+    close(map_fd_);
+    close(data_fd_);
+    map_fd_ = data_fd_ = -1;
+    throw Exception("unsupported compressed page store format, expected version " + std::to_string(FORMAT_VERSION));
+  }
+  struct stat stat_buf;
+  auto map_file_size = fstat(map_fd_, &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+  size_t num_map_pages = map_file_size > PAGE_SIZE ? map_file_size / PAGE_SIZE - 1 : 0;
+  map_.assign(num_map_pages * ENTRIES_PER_PAGE, 0);
+  map_dirty_.assign(num_map_pages, false);
+  auto map_size = static_cast<ssize_t>(map_.size() * sizeof(uint64_t));
+  if (Transfer(map_fd_, reinterpret_cast<char *>(map_.data()), map_size, PAGE_SIZE, false) < map_size) {
+    LOG_DEBUG("I/O error while reading the compressed page map");
+  }
+  auto data_file_size = fstat(data_fd_, &stat_buf) == 0 ? static_cast<uint64_t>(stat_buf.st_size) : 0;
+  data_units_ = (data_file_size + SLOT_SIZE - 1) / SLOT_SIZE;
+
+  // The gaps between the slots in use are free.
+  std::vector<std::pair<uint64_t, uint64_t>> slots;
+  for (uint64_t entry : map_) {
+    if ((entry & UNITS_MASK) != 0) {
+      slots.emplace_back((entry & ~ENABLED_BIT) >> UNIT_BITS, entry & UNITS_MASK);
+    }
+  }
+  std::sort(slots.begin(), slots.end());
+  free_slots_.assign(MAX_SLOT_UNITS + 1, {});
+  released_slots_.clear();
+  uint64_t end = 0;
+  for (const auto &slot : slots) {
+    for (uint64_t units; end < slot.first; end += units) {
+      units = std::min<uint64_t>(slot.first - end, MAX_SLOT_UNITS);
+      free_slots_[units].push_back(end);
+    }
+    end = std::max(end, slot.first + slot.second);
+  }
+  data_units_ = std::max(data_units_, end);
+  in_use_ = true;
+}
+
+uint64_t CompressedPageStore::GetEntry(page_id_t page_id) const {
+  auto index = static_cast<size_t>(page_id);
+  return page_id >= 0 && index < map_.size() ? map_[index] : 0;
+}
+
+void CompressedPageStore::SetEntry(page_id_t page_id, uint64_t entry) {
+  auto index = static_cast<size_t>(page_id);
+  if (index >= map_.size()) {
+    if (entry == 0) {
+      return;
+    }
+    // The map grows by whole pages of its file.
+    size_t num_map_pages = index / ENTRIES_PER_PAGE + 1;
+    map_.resize(num_map_pages * ENTRIES_PER_PAGE, 0);
+    map_dirty_.resize(num_map_pages, false);
+  }
+  if (map_[index] != entry) {
+    map_[index] = entry;
+    map_dirty_[index / ENTRIES_PER_PAGE] = true;
+  }
+}
+
+void CompressedPageStore::SetEnabled(page_id_t page_id, bool enabled) {
+  if (page_id < 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  if (!InUse()) {
+    if (!enabled) {
+      return;
+    }
+    if (read_only_) {
+      throw Exception("the database is opened read-only");
+    }
+    Open(true);
+  }
+  uint64_t entry = GetEntry(page_id);
+  SetEntry(page_id, enabled ? entry | ENABLED_BIT : entry & ~ENABLED_BIT);
+}
+
+bool CompressedPageStore::IsEnabled(page_id_t page_id) {
+  if (!InUse()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  return (GetEntry(page_id) & ENABLED_BIT) != 0;
+}
+
+bool CompressedPageStore::IsStored(page_id_t page_id) {
+  if (!InUse()) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  return (GetEntry(page_id) & UNITS_MASK) != 0;
+}
+
+uint64_t CompressedPageStore::AllocateSlot(uint64_t units) {
+  // The smallest free slot that is large enough, the rest of it stays free.
+  for (uint64_t slot_units = units; slot_units < free_slots_.size(); ++slot_units) {
+    auto &free_slots = free_slots_[slot_units];
+    if (free_slots.empty()) {
+      continue;
+    }
+    uint64_t offset = free_slots.back();
+    free_slots.pop_back();
+    if (slot_units > units) {
+      free_slots_[slot_units - units].push_back(offset + units);
+    }
+    return offset;
+  }
+  uint64_t offset = data_units_;
+  data_units_ += units;
+  return offset;
+}
+
+bool CompressedPageStore::Read(page_id_t page_id, char *page_data) {
+  uint64_t entry;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    entry = GetEntry(page_id);
+  }
+  uint64_t units = entry & UNITS_MASK;
+  uint64_t offset = (entry & ~ENABLED_BIT) >> UNIT_BITS;
+  if (units == 0) {
+    return false;
+  }
+  char slot[MAX_SLOT_UNITS * SLOT_SIZE];
+  size_t slot_size = units * SLOT_SIZE;
+  if (Transfer(data_fd_, slot, slot_size, static_cast<off_t>(offset * SLOT_SIZE), false) <
+      static_cast<ssize_t>(slot_size)) {
+    LOG_DEBUG("I/O error while reading a compressed page");
+    return false;
+  }
+  SlotHeader size;
+  memcpy(&size, slot, sizeof(size));
+  pages_read_++;
+  if (size == PAGE_SIZE) {
+    memcpy(page_data, slot + sizeof(SlotHeader), PAGE_SIZE);
+    return true;
+  }
+  auto start = std::chrono::steady_clock::now();
+  bool success = size <= slot_size - sizeof(SlotHeader) &&
+                 LZCodec::Decompress(slot + sizeof(SlotHeader), size, page_data, PAGE_SIZE) == PAGE_SIZE;
+  decompress_ns_ += ElapsedNanos(start);
+  if (!success) {
+    LOG_DEBUG("corrupt compressed page");
+  }
+  return success;
+}
+
+bool CompressedPageStore::Write(page_id_t page_id, const char *page_data) {
+  char slot[MAX_SLOT_UNITS * SLOT_SIZE];
+  auto start = std::chrono::steady_clock::now();
+  // Only a page that compresses to less than a page is kept compressed.
+  auto size =
+      static_cast<SlotHeader>(LZCodec::Compress(page_data, PAGE_SIZE, slot + sizeof(SlotHeader), PAGE_SIZE - 1));
+  compress_ns_ += ElapsedNanos(start);
+  if (size == 0) {
+    size = PAGE_SIZE;
+    memcpy(slot + sizeof(SlotHeader), page_data, PAGE_SIZE);
+  }
+  memcpy(slot, &size, sizeof(size));
+  uint64_t units = (sizeof(SlotHeader) + size + SLOT_SIZE - 1) / SLOT_SIZE;
+  size_t slot_size = units * SLOT_SIZE;
+  memset(slot + sizeof(SlotHeader) + size, 0, slot_size - sizeof(SlotHeader) - size);
+  uint64_t offset;
+  bool moved;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    uint64_t entry = GetEntry(page_id);
+    // The page fits into its slot again, else it moves to a new one.
+    moved = (entry & UNITS_MASK) != units;
+    offset = moved ? AllocateSlot(units) : (entry & ~ENABLED_BIT) >> UNIT_BITS;
+  }
+  bool success = Transfer(data_fd_, slot, slot_size, static_cast<off_t>(offset * SLOT_SIZE), true) >=
+                 static_cast<ssize_t>(slot_size);
+  if (moved) {
+    // The map points at the new slot only once it holds the page, until then the old one keeps the last good copy.
+    std::lock_guard<std::mutex> guard(latch_);
+    if (!success) {
+      // Nothing refers to the new slot, it is free again right away.
+      free_slots_[units].push_back(offset);
+    } else {
+      uint64_t entry = GetEntry(page_id);
+      if ((entry & UNITS_MASK) != 0) {
+        released_slots_.emplace_back((entry & ~ENABLED_BIT) >> UNIT_BITS, entry & UNITS_MASK);
+      }
+      SetEntry(page_id, (entry & ENABLED_BIT) | offset << UNIT_BITS | units);
+    }
+  }
+  if (!success) {
+    LOG_DEBUG("I/O error while writing a compressed page");
+    return false;
+  }
+  pages_written_++;
+  stored_bytes_ += slot_size;
+  return true;
+}
+
+void CompressedPageStore::Free(page_id_t page_id) {
+  if (!InUse()) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  uint64_t entry = GetEntry(page_id);
+  if ((entry & UNITS_MASK) != 0) {
+    released_slots_.emplace_back((entry & ~ENABLED_BIT) >> UNIT_BITS, entry & UNITS_MASK);
+  }
+  SetEntry(page_id, 0);
+}
+
+void CompressedPageStore::Sync() {
+  if (!InUse() || read_only_) {
+    return;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  // The slots the map points at are durable before the map is.
+  if (fdatasync(data_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing the compressed pages");
+    return;
+  }
+  WriteMap();
+  for (const auto &slot : released_slots_) {
+    free_slots_[slot.second].push_back(slot.first);
+  }
+  released_slots_.clear();
+}
+
+void CompressedPageStore::WriteMap() {
+  bool written = false;
+  for (size_t i = 0; i < map_dirty_.size(); ++i) {
+    if (!map_dirty_[i]) {
+      continue;
+    }
+    // The header page comes first.
+    if (Transfer(map_fd_, reinterpret_cast<char *>(&map_[i * ENTRIES_PER_PAGE]), PAGE_SIZE,
+                 static_cast<off_t>(i + 1) * PAGE_SIZE, true) < static_cast<ssize_t>(PAGE_SIZE)) {
+      LOG_DEBUG("I/O error while writing the compressed page map");
+      continue;
+    }
+    map_dirty_[i] = false;
+    written = true;
+  }
+  if (written && fdatasync(map_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing the compressed page map");
+  }
+}
+
+int64_t CompressedPageStore::GetDataSize() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return static_cast<int64_t>(data_units_ * SLOT_SIZE);
+}
+
+CompressionStats CompressedPageStore::GetStats() const {
+  CompressionStats stats;
+  stats.pages_written_ = pages_written_;
+  stats.pages_read_ = pages_read_;
+  stats.raw_bytes_ = stats.pages_written_ * PAGE_SIZE;
+  stats.stored_bytes_ = stored_bytes_;
+  stats.compress_ns_ = compress_ns_;
+  stats.decompress_ns_ = decompress_ns_;
+  return stats;
+}
+
+}  // namespace bustub
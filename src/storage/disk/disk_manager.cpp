@@ -10,27 +10,109 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <fcntl.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#include <algorithm>
 #include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
 #include <cstring>
 #include <iostream>
-#include <mutex>  // NOLINT
+#include <memory>
+#include <numeric>
 #include <string>
 #include <thread>  // NOLINT
 
 #include "common/exception.h"
 #include "common/logger.h"
 #include "storage/disk/disk_manager.h"
+#include "storage/disk/io_uring.h"
 
 namespace bustub {
 
 static char *buffer_used;
 
+// A freshly allocated page that was in use before is overwritten with this, aligned for direct I/O.
+alignas(DiskManager::DIRECT_IO_ALIGNMENT) static const char zero_page[PAGE_SIZE] = {};
+
+// Number of free space map words in one page of its file.
+static constexpr size_t FSM_WORDS_PER_PAGE = PAGE_SIZE / sizeof(uint64_t);
+
+// "BUSTUBDB", the first bytes of a free space map file.
+static constexpr uint64_t FSM_MAGIC = 0x4244425554535542ULL;
+
+// The first page of the free space map file, the pages of the bitmap follow it.
+struct FreeSpaceMapHeader {
+  uint64_t magic_;
+  uint32_t format_version_;
+  uint32_t page_size_;
+  // layout of the tablespace
+  uint32_t num_files_;
+  uint32_t stripe_size_;
+  // one past the last page ever allocated when the map was written, the pages past it are recovered from the file size
+  page_id_t end_;
+};
+
+struct DiskManager::AsyncIO {
+  IOCallback callback_;
+  char *data_;
+  uint32_t size_;
+  // offset in the log file, or in the file of the tablespace holding the page
+  off_t offset_;
+  page_id_t page_id_;
+  bool write_;
+  // true for a log write, false for page I/O
+  bool log_;
+};
+
+/**
+ * Reads or writes a run of buffers at the given file offset, going on after interrupted and short transfers. A read
+ * stops at the end of the file.
+ * @return the number of bytes transferred, -1 on an I/O error
+ */
+static ssize_t TransferRun(int fd, off_t offset, std::vector<iovec> *iov, bool write) {
+  ssize_t total = 0;
+  size_t first = 0;
+  while (first < iov->size()) {
+    int count = static_cast<int>(std::min<size_t>(iov->size() - first, IOV_MAX));
+    ssize_t n = write ? pwritev(fd, &(*iov)[first], count, offset + total)
+                      : preadv(fd, &(*iov)[first], count, offset + total);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return n < 0 ? -1 : total;
+    }
+    total += n;
+    // Skip the buffers that are done, and the part of the next one that is.
+    for (; first < iov->size() && n >= static_cast<ssize_t>((*iov)[first].iov_len); ++first) {
+      n -= static_cast<ssize_t>((*iov)[first].iov_len);
+    }
+    if (n > 0) {
+      (*iov)[first].iov_base = static_cast<char *>((*iov)[first].iov_base) + n;
+      (*iov)[first].iov_len -= n;
+    }
+  }
+  return total;
+}
+
 /**
  * Constructor: open/create a single database file & log file
  * @input db_file: database file name
  */
-DiskManager::DiskManager(const std::string &db_file)
+DiskManager::DiskManager(const std::string &db_file, bool direct_io) : DiskManager(db_file, {}, direct_io) {}
+
+DiskManager::DiskManager(const std::string &db_file, DiskManagerMode mode)
+    : DiskManager(db_file, {}, false, TABLESPACE_STRIPE_SIZE, mode) {}
+
+/**
+ * Constructor: open/create the files of a striped tablespace & log file
+ */
+DiskManager::DiskManager(const std::string &db_file, const std::vector<std::string> &directories, bool direct_io,
+                         size_t stripe_size, DiskManagerMode mode)
     : file_name_(db_file), num_flushes_(0), num_writes_(0), flush_log_(false), flush_log_f_(nullptr) {
   std::string::size_type n = file_name_.rfind('.');
   if (n == std::string::npos) {
@@ -38,95 +120,777 @@ DiskManager::DiskManager(const std::string &db_file)
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  fsm_name_ = file_name_.substr(0, n) + ".fsm";
+
+  bool read_only = mode == DiskManagerMode::READ_ONLY;
+  // The log is appended at offsets taken from log_file_size_, so that asynchronous appends keep their order. A
+  // read-only database may come without its log.
+  log_fd_ = open(log_name_.c_str(), read_only ? O_RDONLY : O_RDWR | O_CREAT, 0644);
+  if (log_fd_ < 0 && !read_only) {
+    throw Exception("can't open dblog file");
+  }
+  struct stat stat_buf;
+  log_file_size_ = log_fd_ >= 0 && fstat(log_fd_, &stat_buf) == 0 ? static_cast<int64_t>(stat_buf.st_size) : 0;
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
-
-  // std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-  // directory or file does not exist
-  if (!db_io_.is_open()) {
-    db_io_.clear();
-    // create a new file
-    db_io_.open(db_file, std::ios::binary | std::ios::trunc | std::ios::out);
-    db_io_.close();
-    // reopen with original mode
-    db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
-    if (!db_io_.is_open()) {
-      throw Exception("can't open db file");
+  try {
+    tablespace_ = new Tablespace(db_file, directories, stripe_size, direct_io, read_only);
+  } catch (...) {
+    if (log_fd_ >= 0) {
+      close(log_fd_);
+    }
+    throw;
+  }
+  direct_io_ = tablespace_->IsDirectIO();
+  db_file_size_ = tablespace_->GetSize();
+  // A free space map left behind by a database that is gone describes nothing.
+  LoadFreeSpaceMap(tablespace_->IsNew());
+  try {
+    compressed_store_ = new CompressedPageStore(file_name_.substr(0, n) + ".cmap", file_name_.substr(0, n) + ".cdat",
+                                                read_only, tablespace_->IsNew());
+  } catch (...) {
+    if (fsm_fd_ >= 0) {
+      close(fsm_fd_);
+    }
+    delete tablespace_;
+    if (log_fd_ >= 0) {
+      close(log_fd_);
     }
+    throw;
   }
   buffer_used = nullptr;
 }
 
+DiskManager::~DiskManager() {
+  StopAsyncIO();
+  if (fsm_fd_ >= 0) {
+    WriteFreeSpaceMap();
+    close(fsm_fd_);
+  }
+  delete compressed_store_;
+  delete tablespace_;
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+  }
+}
+
 /**
  * Close all file streams
  */
 void DiskManager::ShutDown() {
+  StopAsyncIO();
+  if (tablespace_ != nullptr) {
+    Sync();
+    tablespace_->Close();
+    compressed_store_->Close();
+  }
+  if (fsm_fd_ >= 0) {
+    close(fsm_fd_);
+    fsm_fd_ = -1;
+  }
+  if (log_fd_ >= 0) {
+    close(log_fd_);
+    log_fd_ = -1;
+  }
+}
+
+/**
+ * Allocate the lowest free page with the instance's residue
+ */
+page_id_t DiskManager::AllocatePage(uint32_t num_instances, uint32_t instance_index, bool zero_fill) {
+  CheckWritable();
+  page_id_t page_id = INVALID_PAGE_ID;
+  bool reused;
   {
-    // std::scoped_lock scoped_db_io_latch(db_io_latch_);
-    db_io_.close();
+    std::lock_guard<std::mutex> guard(fsm_latch_);
+    for (size_t word = fsm_first_free_word_; word < fsm_.size() && page_id == INVALID_PAGE_ID; ++word) {
+      for (uint64_t free_bits = ~fsm_[word]; free_bits != 0; free_bits &= free_bits - 1) {
+        auto candidate = static_cast<page_id_t>(word * 64 + __builtin_ctzll(free_bits));
+        if (candidate % num_instances == instance_index) {
+          page_id = candidate;
+          break;
+        }
+      }
+    }
+    if (page_id == INVALID_PAGE_ID) {
+      // The map is full, take the first page of the instance past its end.
+      auto end = static_cast<page_id_t>(fsm_.size() * 64);
+      page_id = end + (instance_index + num_instances - end % num_instances) % num_instances;
+    }
+    reused = page_id < fsm_end_;
+    SetAllocated(page_id, true);
+    while (fsm_first_free_word_ < fsm_.size() && fsm_[fsm_first_free_word_] == ~uint64_t{0}) {
+      fsm_first_free_word_++;
+    }
+  }
+  // The map on disk may still show a deleted page as free, and after a crash it would be handed out again while in
+  // use. Its bit is made durable before the page is handed out. A page past the end is recovered as allocated once it
+  // is written. Both the sync and the reservation wait for the device, they are done without fsm_latch_ so that the
+  // lookups of the map, e.g. by a buffer pool under its latch, do not wait behind them.
+  if (reused) {
+    SyncFreeSpaceMapPage(static_cast<size_t>(page_id) / 64 / FSM_WORDS_PER_PAGE);
   }
-  log_io_.close();
+  tablespace_->Reserve(page_id, db_extent_size);
+  // A page of the file that was deallocated still holds its old content.
+  if (zero_fill && page_id * PAGE_SIZE < db_file_size_) {
+    const char *page_data = zero_page;
+    WriteRun(page_id, &page_data, 1);
+  }
+  return page_id;
 }
 
 /**
- * Write the contents of the specified page into disk file
+ * Give a page back to the free space map
  */
-void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
-  // std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
-  // set write cursor to offset
-  num_writes_ += 1;
-  db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
-  // check for I/O error
-  if (db_io_.bad()) {
-    LOG_DEBUG("I/O error while writing");
+void DiskManager::DeallocatePage(page_id_t page_id) {
+  CheckWritable();
+  if (page_id < 0) {
     return;
   }
-  // needs to flush to keep disk file in sync
-  db_io_.flush();
+  compressed_store_->Free(page_id);
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  SetAllocated(page_id, false);
+}
+
+bool DiskManager::IsPageAllocated(page_id_t page_id) {
+  if (page_id < 0) {
+    return false;
+  }
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  auto word = static_cast<size_t>(page_id) / 64;
+  return word < fsm_.size() && (fsm_[word] >> (page_id % 64) & 1) != 0;
 }
 
+size_t DiskManager::GetNumAllocatedPages() {
+  std::lock_guard<std::mutex> guard(fsm_latch_);
+  return num_allocated_pages_;
+}
+
+int64_t DiskManager::GetReservedSize() { return tablespace_->GetReservedSize(); }
+
+void DiskManager::SetPageCompression(page_id_t page_id, bool compressed) {
+  CheckWritable();
+  compressed_store_->SetEnabled(page_id, compressed);
+}
+
+/**
+ * Write the contents of the specified page into disk file
+ */
+void DiskManager::WritePage(page_id_t page_id, const char *page_data) { WriteRun(page_id, &page_data, 1); }
+
 /**
  * Read the contents of the specified page into the given memory area
  */
-void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  // std::scoped_lock scoped_db_io_latch(db_io_latch_);
-  int offset = page_id * PAGE_SIZE;
+void DiskManager::ReadPage(page_id_t page_id, char *page_data) { ReadRun(page_id, &page_data, 1); }
+
+const char *DiskManager::GetMappedPage(page_id_t page_id) const {
+  // The copy of a compressed page in the tablespace is stale.
+  return page_id < 0 || compressed_store_->IsStored(page_id) ? nullptr : tablespace_->GetMappedPage(page_id);
+}
+
+void DiskManager::Advise(page_id_t page_id, size_t num_pages, AccessHint hint) const {
+  tablespace_->Advise(page_id, num_pages, hint);
+}
+
+/**
+ * Read the contents of a batch of pages, in page id order
+ */
+bool DiskManager::ReadPages(const std::vector<page_id_t> &page_ids, const std::vector<char *> &page_data) {
+  assert(page_ids.size() == page_data.size());
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  std::vector<char *> run;
+  bool success = true;
+  for (size_t begin = 0, end; begin < order.size(); begin = end) {
+    run.assign(1, page_data[order[begin]]);
+    for (end = begin + 1; end < order.size() && page_ids[order[end]] == page_ids[order[end - 1]] + 1; ++end) {
+      run.push_back(page_data[order[end]]);
+    }
+    success = ReadRun(page_ids[order[begin]], run.data(), run.size()) && success;
+  }
+  return success;
+}
+
+/**
+ * Write the contents of a batch of pages, in page id order
+ */
+bool DiskManager::WritePages(const std::vector<page_id_t> &page_ids, const std::vector<const char *> &page_data) {
+  assert(page_ids.size() == page_data.size());
+  std::vector<size_t> order(page_ids.size());
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return page_ids[a] < page_ids[b]; });
+  std::vector<const char *> run;
+  bool success = true;
+  for (size_t begin = 0, end; begin < order.size(); begin = end) {
+    run.assign(1, page_data[order[begin]]);
+    for (end = begin + 1; end < order.size() && page_ids[order[end]] == page_ids[order[end - 1]] + 1; ++end) {
+      run.push_back(page_data[order[end]]);
+    }
+    success = WriteRun(page_ids[order[begin]], run.data(), run.size()) && success;
+  }
+  return success;
+}
+
+/**
+ * Queue an asynchronous read of the specified page
+ */
+void DiskManager::ReadPageAsync(page_id_t page_id, char *page_data, IOCallback callback) {
+  CheckAlignment(&page_data, 1);
+  if (IsReadOnly() || compressed_store_->IsStored(page_id)) {
+    // A copy out of the mapping does not block on the disk, unless the page has to be faulted in. A compressed page
+    // is read and decompressed right away.
+    callback(ReadRun(page_id, &page_data, 1));
+    return;
+  }
+  QueueIO(new AsyncIO{std::move(callback), page_data, PAGE_SIZE, tablespace_->GetFileOffset(page_id), page_id, false,
+                      false});
+}
+
+std::future<bool> DiskManager::ReadPageAsync(page_id_t page_id, char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  ReadPageAsync(page_id, page_data, [promise](bool success) { promise->set_value(success); });
+  return promise->get_future();
+}
+
+/**
+ * Queue an asynchronous write of the specified page
+ */
+void DiskManager::WritePageAsync(page_id_t page_id, const char *page_data, IOCallback callback) {
+  CheckWritable();
+  CheckAlignment(&page_data, 1);
+  if (compressed_store_->IsEnabled(page_id) || compressed_store_->IsStored(page_id)) {
+    callback(WriteRun(page_id, &page_data, 1));
+    return;
+  }
+  QueueIO(new AsyncIO{std::move(callback), const_cast<char *>(page_data), PAGE_SIZE,  // NOLINT
+                      tablespace_->GetFileOffset(page_id), page_id, true, false});
+}
+
+std::future<bool> DiskManager::WritePageAsync(page_id_t page_id, const char *page_data) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  WritePageAsync(page_id, page_data, [promise](bool success) { promise->set_value(success); });
+  return promise->get_future();
+}
+
+/**
+ * Queue an asynchronous append to the log, at the end of the log so far
+ */
+void DiskManager::WriteLogAsync(const char *log_data, int size, IOCallback callback) {
+  CheckWritable();
+  num_flushes_ += 1;
+  off_t offset = log_file_size_.fetch_add(size);
+  QueueIO(new AsyncIO{std::move(callback), const_cast<char *>(log_data), static_cast<uint32_t>(size),  // NOLINT
+                      offset, INVALID_PAGE_ID, true, true});
+}
+
+std::future<bool> DiskManager::WriteLogAsync(const char *log_data, int size) {
+  auto promise = std::make_shared<std::promise<bool>>();
+  WriteLogAsync(log_data, size, [promise](bool success) { promise->set_value(success); });
+  return promise->get_future();
+}
+
+/**
+ * Submit the queued asynchronous I/O
+ */
+void DiskManager::SubmitIO() {
+  std::vector<AsyncIO *> failed;
+  {
+    std::lock_guard<std::mutex> guard(io_mutex_);
+    SubmitQueuedIO(&failed);
+  }
+  for (AsyncIO *io : failed) {
+    RunIO(io);
+  }
+}
+
+/**
+ * Flush the pages and the log written so far to stable storage
+ */
+void DiskManager::Sync() {
+  WriteFreeSpaceMap();
+  compressed_store_->Sync();
+  if (!tablespace_->Sync()) {
+    LOG_DEBUG("I/O error while syncing");
+  }
+  // Also the log appended asynchronously, its writes complete without a sync.
+  if (log_fd_ >= 0 && !IsReadOnly() && fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+  }
+}
+
+/**
+ * Private helper function to read the free space map at startup
+ */
+void DiskManager::LoadFreeSpaceMap(bool new_db_file) {
+  if (IsReadOnly()) {
+    // Only an empty database may come without a map.
+    fsm_fd_ = open(fsm_name_.c_str(), O_RDONLY);
+  } else {
+    fsm_fd_ = open(fsm_name_.c_str(), O_RDWR | O_CREAT | (new_db_file ? O_TRUNC : 0), 0644);
+    if (fsm_fd_ < 0) {
+      delete tablespace_;
+      close(log_fd_);
+      throw Exception("can't open free space map file");
+    }
+  }
+  struct stat stat_buf;
+  auto fsm_file_size = fsm_fd_ >= 0 && fstat(fsm_fd_, &stat_buf) == 0 ? static_cast<size_t>(stat_buf.st_size) : 0;
+  char header_page[PAGE_SIZE] = {};
+  auto *header = reinterpret_cast<FreeSpaceMapHeader *>(header_page);
+  std::vector<iovec> iov{{header_page, PAGE_SIZE}};
+  auto num_files = static_cast<uint32_t>(tablespace_->GetNumFiles());
+  auto stripe_size = static_cast<uint32_t>(tablespace_->GetStripeSize());
+  if (fsm_file_size == 0 && db_file_size_ > 0) {
+    // The format version is stamped in the map only. A database written without one, e.g. by format version 1, would
+    // be misread.
+    if (fsm_fd_ >= 0) {
+      close(fsm_fd_);
+    }
+    delete tablespace_;
+    if (log_fd_ >= 0) {
+      close(log_fd_);
+    }
+    throw Exception("database without a free space map, it may be of another format version than " +
+                    std::to_string(FORMAT_VERSION));
+  } else if (fsm_file_size == 0 && IsReadOnly()) {
+    // Nothing to check, and nothing to write.
+  } else if (fsm_file_size == 0) {
+    WriteFreeSpaceMapHeader(0);
+  } else if (TransferRun(fsm_fd_, 0, &iov, false) < 0 || header->magic_ != FSM_MAGIC ||
+             header->format_version_ != FORMAT_VERSION || header->page_size_ != PAGE_SIZE) {
+    close(fsm_fd_);
+    delete tablespace_;
+    if (log_fd_ >= 0) {
+      close(log_fd_);
+    }
+    throw Exception("unsupported database format, expected version " + std::to_string(FORMAT_VERSION) +
+                    " with pages of " + std::to_string(PAGE_SIZE) + " bytes");
+  } else if (header->num_files_ != num_files || (num_files > 1 && header->stripe_size_ != stripe_size)) {
+    // The pages would be looked for in the wrong places.
+    close(fsm_fd_);
+    delete tablespace_;
+    if (log_fd_ >= 0) {
+      close(log_fd_);
+    }
+    throw Exception("tablespace layout mismatch, the database has " + std::to_string(header->num_files_) +
+                    " files with stripes of " + std::to_string(header->stripe_size_) + " bytes");
+  }
+  size_t num_fsm_pages = fsm_file_size > PAGE_SIZE ? fsm_file_size / PAGE_SIZE - 1 : 0;
+  fsm_.assign(num_fsm_pages * FSM_WORDS_PER_PAGE, 0);
+  fsm_dirty_.assign(num_fsm_pages, false);
+  iov = {{fsm_.data(), fsm_.size() * sizeof(uint64_t)}};
+  if (TransferRun(fsm_fd_, PAGE_SIZE, &iov, false) < static_cast<ssize_t>(fsm_.size() * sizeof(uint64_t))) {
+    LOG_DEBUG("I/O error while reading the free space map");
+  }
+  num_allocated_pages_ = 0;
+  // A crash may leave the bits of the pages past the end stamped in the header on disk without the header.
+  fsm_end_ = fsm_file_size == 0 ? 0 : header->end_;
+  for (size_t word = 0; word < fsm_.size(); ++word) {
+    if (fsm_[word] != 0) {
+      num_allocated_pages_ += __builtin_popcountll(fsm_[word]);
+      fsm_end_ = std::max(fsm_end_, static_cast<page_id_t>(word * 64 + 64 - __builtin_clzll(fsm_[word])));
+    }
+  }
+  fsm_synced_end_ = fsm_end_;
+  // The pages below the end are in the map, those freed at the end of the file stay free.
+  auto num_file_pages = static_cast<page_id_t>((db_file_size_ + PAGE_SIZE - 1) / PAGE_SIZE);
+  for (page_id_t page_id = fsm_end_; page_id < num_file_pages; ++page_id) {
+    SetAllocated(page_id, true);
+  }
+  fsm_first_free_word_ = 0;
+  while (fsm_first_free_word_ < fsm_.size() && fsm_[fsm_first_free_word_] == ~uint64_t{0}) {
+    fsm_first_free_word_++;
+  }
+}
+
+void DiskManager::SetAllocated(page_id_t page_id, bool allocated) {
+  auto word = static_cast<size_t>(page_id) / 64;
+  uint64_t mask = uint64_t{1} << (page_id % 64);
+  if (word >= fsm_.size()) {
+    if (!allocated) {
+      return;
+    }
+    // The map grows by whole pages of its file.
+    size_t num_fsm_pages = word / FSM_WORDS_PER_PAGE + 1;
+    fsm_.resize(num_fsm_pages * FSM_WORDS_PER_PAGE, 0);
+    fsm_dirty_.resize(num_fsm_pages, false);
+  }
+  if (allocated) {
+    fsm_end_ = std::max(fsm_end_, page_id + 1);
+  }
+  if (((fsm_[word] & mask) != 0) == allocated) {
+    return;
+  }
+  fsm_[word] ^= mask;
+  fsm_dirty_[word / FSM_WORDS_PER_PAGE] = true;
+  if (allocated) {
+    num_allocated_pages_++;
+  } else {
+    num_allocated_pages_--;
+    fsm_first_free_word_ = std::min(fsm_first_free_word_, word);
+  }
+}
+
+void DiskManager::WriteFreeSpaceMap() {
+  // A read-only map only changes by taking the pages it does not cover as allocated, that is not written back.
+  if (fsm_fd_ < 0 || IsReadOnly()) {
+    return;
+  }
+  std::lock_guard<std::mutex> write_guard(fsm_write_latch_);
+  page_id_t end;
+  {
+    std::lock_guard<std::mutex> guard(fsm_latch_);
+    end = fsm_end_;
+  }
+  WriteFreeSpaceMapPages(0, SIZE_MAX);
+  // The header moves the end only once the bits below it are durable, else a crash would leave the pages allocated
+  // since the last sync free in the map.
+  if (end != fsm_synced_end_ && WriteFreeSpaceMapHeader(end)) {
+    if (fdatasync(fsm_fd_) != 0) {
+      LOG_DEBUG("I/O error while syncing the free space map");
+    }
+    fsm_synced_end_ = end;
+  }
+}
+
+void DiskManager::SyncFreeSpaceMapPage(size_t index) {
+  std::lock_guard<std::mutex> write_guard(fsm_write_latch_);
+  WriteFreeSpaceMapPages(index, index + 1);
+}
+
+bool DiskManager::WriteFreeSpaceMapPages(size_t first, size_t last) {
+  std::vector<size_t> indexes;
+  std::vector<uint64_t> words;
+  {
+    std::lock_guard<std::mutex> guard(fsm_latch_);
+    for (size_t i = first; i < std::min(last, fsm_dirty_.size()); ++i) {
+      if (fsm_dirty_[i]) {
+        indexes.push_back(i);
+        words.insert(words.end(), fsm_.begin() + i * FSM_WORDS_PER_PAGE, fsm_.begin() + (i + 1) * FSM_WORDS_PER_PAGE);
+        fsm_dirty_[i] = false;
+      }
+    }
+  }
+  if (indexes.empty()) {
+    // A page written before fsm_write_latch_ was taken is synced already.
+    return true;
+  }
+  bool success = true;
+  for (size_t i = 0; i < indexes.size(); ++i) {
+    std::vector<iovec> iov{{&words[i * FSM_WORDS_PER_PAGE], PAGE_SIZE}};
+    // The header page comes first.
+    if (TransferRun(fsm_fd_, static_cast<off_t>(indexes[i] + 1) * PAGE_SIZE, &iov, true) < PAGE_SIZE) {
+      LOG_DEBUG("I/O error while writing the free space map");
+      std::lock_guard<std::mutex> guard(fsm_latch_);
+      fsm_dirty_[indexes[i]] = true;
+      success = false;
+    }
+  }
+  if (fdatasync(fsm_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing the free space map");
+    success = false;
+  }
+  return success;
+}
+
+bool DiskManager::WriteFreeSpaceMapHeader(page_id_t end) {
+  char header_page[PAGE_SIZE] = {};
+  auto num_files = static_cast<uint32_t>(tablespace_->GetNumFiles());
+  auto stripe_size = static_cast<uint32_t>(tablespace_->GetStripeSize());
+  // A new map is stamped with the format of the pages that will be written, and where they will be written.
+  *reinterpret_cast<FreeSpaceMapHeader *>(header_page) = {FSM_MAGIC, FORMAT_VERSION, PAGE_SIZE, num_files, stripe_size,
+                                                          end};
+  std::vector<iovec> iov{{header_page, PAGE_SIZE}};
+  if (TransferRun(fsm_fd_, 0, &iov, true) < PAGE_SIZE) {
+    LOG_DEBUG("I/O error while writing the free space map");
+    return false;
+  }
+  return true;
+}
+
+/**
+ * Private helper function to reject changes to a read-only database
+ */
+void DiskManager::CheckWritable() const {
+  if (IsReadOnly()) {
+    throw Exception("the database is opened read-only");
+  }
+}
+
+/**
+ * Private helper function to reject a page buffer direct I/O cannot use
+ */
+void DiskManager::CheckAlignment(const char *const *page_data, size_t num_pages) const {
+  if (!direct_io_) {
+    return;
+  }
+  for (size_t i = 0; i < num_pages; ++i) {
+    if (reinterpret_cast<uintptr_t>(page_data[i]) % DIRECT_IO_ALIGNMENT != 0) {
+      throw Exception("unaligned page buffer for direct I/O");
+    }
+  }
+}
+
+bool DiskManager::ReadRun(page_id_t page_id, char *const *page_data, size_t num_pages) {
+  if (!compressed_store_->InUse()) {
+    return ReadTablespaceRun(page_id, page_data, num_pages);
+  }
+  bool success = true;
+  // The pieces of the run between the compressed pages are read from the tablespace as runs still.
+  for (size_t done = 0, count; done < num_pages; done += count) {
+    page_id_t first = page_id + done;
+    if (compressed_store_->IsStored(first)) {
+      count = 1;
+      success = compressed_store_->Read(first, page_data[done]) && success;
+      continue;
+    }
+    for (count = 1; done + count < num_pages && !compressed_store_->IsStored(first + count); ++count) {
+    }
+    success = ReadTablespaceRun(first, page_data + done, count) && success;
+  }
+  return success;
+}
+
+bool DiskManager::WriteRun(page_id_t page_id, const char *const *page_data, size_t num_pages) {
+  CheckWritable();
+  num_writes_ += static_cast<int>(num_pages);
+  if (!compressed_store_->InUse()) {
+    return WriteTablespaceRun(page_id, page_data, num_pages);
+  }
+  bool success = true;
+  for (size_t done = 0, count; done < num_pages; done += count) {
+    page_id_t first = page_id + done;
+    if (compressed_store_->IsEnabled(first)) {
+      count = 1;
+      success = compressed_store_->Write(first, page_data[done]) && success;
+      continue;
+    }
+    for (count = 1; done + count < num_pages && !compressed_store_->IsEnabled(first + count); ++count) {
+    }
+    if (!WriteTablespaceRun(first, page_data + done, count)) {
+      success = false;
+      continue;
+    }
+    // A page compression was disabled for leaves the store once it is in the tablespace.
+    for (size_t i = 0; i < count; ++i) {
+      compressed_store_->Free(first + static_cast<page_id_t>(i));
+    }
+  }
+  return success;
+}
+
+bool DiskManager::ReadTablespaceRun(page_id_t page_id, char *const *page_data, size_t num_pages) {
+  CheckAlignment(page_data, num_pages);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (page_id * PAGE_SIZE > db_file_size_) {
     LOG_DEBUG("I/O error reading past end of file");
-    // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
-    db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
+    return false;
+  }
+  if (IsReadOnly()) {
+    for (size_t i = 0; i < num_pages; ++i) {
+      const char *page = tablespace_->GetMappedPage(page_id + static_cast<page_id_t>(i));
+      if (page == nullptr) {
+        memset(page_data[i], 0, PAGE_SIZE);
+      } else {
+        memcpy(page_data[i], page, PAGE_SIZE);
+      }
+    }
+    return true;
+  }
+  std::vector<iovec> iov;
+  // One read per piece of the run that is in one file.
+  for (size_t done = 0, count; done < num_pages; done += count) {
+    page_id_t first = page_id + done;
+    count = tablespace_->GetRunLength(first, num_pages - done);
+    iov.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      iov[i] = {page_data[done + i], PAGE_SIZE};
+    }
+    int fd = tablespace_->GetFd(tablespace_->GetFileIndex(first));
+    ssize_t read_count = TransferRun(fd, tablespace_->GetFileOffset(first), &iov, false);
+    if (read_count < 0) {
       LOG_DEBUG("I/O error while reading");
-      return;
+      return false;
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
+    // if file ends before reading the whole piece
+    if (read_count < static_cast<ssize_t>(count * PAGE_SIZE)) {
       LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+      for (size_t i = read_count / PAGE_SIZE; i < count; ++i) {
+        size_t page_done = std::max<ssize_t>(read_count - static_cast<ssize_t>(i * PAGE_SIZE), 0);
+        memset(page_data[done + i] + page_done, 0, PAGE_SIZE - page_done);
+      }
     }
   }
+  return true;
+}
+
+bool DiskManager::WriteTablespaceRun(page_id_t page_id, const char *const *page_data, size_t num_pages) {
+  CheckAlignment(page_data, num_pages);
+  std::vector<iovec> iov;
+  // One write per piece of the run that is in one file.
+  for (size_t done = 0, count; done < num_pages; done += count) {
+    page_id_t first = page_id + done;
+    count = tablespace_->GetRunLength(first, num_pages - done);
+    iov.resize(count);
+    for (size_t i = 0; i < count; ++i) {
+      iov[i] = {const_cast<char *>(page_data[done + i]), PAGE_SIZE};  // NOLINT
+    }
+    int fd = tablespace_->GetFd(tablespace_->GetFileIndex(first));
+    ssize_t write_count = TransferRun(fd, tablespace_->GetFileOffset(first), &iov, true);
+    // check for I/O error
+    if (write_count < static_cast<ssize_t>(count * PAGE_SIZE)) {
+      LOG_DEBUG("I/O error while writing");
+      return false;
+    }
+    GrowFileSize((first + static_cast<page_id_t>(count)) * PAGE_SIZE);
+  }
+  return true;
+}
+
+void DiskManager::GrowFileSize(int64_t end) {
+  // Concurrent writes past the end race to raise the cached file size.
+  int64_t file_size = db_file_size_.load();
+  while (file_size < end && !db_file_size_.compare_exchange_weak(file_size, end)) {
+  }
+}
+
+void DiskManager::QueueIO(AsyncIO *io) {
+  std::call_once(async_io_started_, [&] {
+    if (!enable_io_uring) {
+      return;
+    }
+    io_uring_ = new IoUring(IO_URING_ENTRIES);
+    if (!io_uring_->IsValid()) {
+      LOG_WARN("io_uring is not available, asynchronous I/O is done synchronously");
+      return;
+    }
+    io_thread_ = new std::thread(&DiskManager::CompleteIO, this);
+  });
+  if (io_thread_ == nullptr) {
+    RunIO(io);
+    return;
+  }
+  std::vector<AsyncIO *> failed;
+  {
+    std::unique_lock<std::mutex> lock(io_mutex_);
+    // Every I/O in the ring must find room in the completion queue. Submit what is queued so that it can complete,
+    // then wait for completions. A failed submission empties the queue, so there is I/O in flight to wait for.
+    while (io_queued_ + io_in_flight_ >= io_uring_->GetCompletionQueueSize()) {
+      SubmitQueuedIO(&failed);
+      if (io_queued_ + io_in_flight_ >= io_uring_->GetCompletionQueueSize()) {
+        io_space_cv_.wait(lock);
+      }
+    }
+    int fd = io->log_ ? log_fd_ : tablespace_->GetFd(tablespace_->GetFileIndex(io->page_id_));
+    uint8_t opcode = io->write_ ? IORING_OP_WRITE : IORING_OP_READ;
+    // The submission queue is full, submitting or taking back what is queued makes room.
+    while (!io_uring_->Prepare(opcode, fd, io->data_, io->size_, io->offset_, reinterpret_cast<uint64_t>(io))) {
+      SubmitQueuedIO(&failed);
+    }
+    io_queued_++;
+  }
+  // Done without io_mutex_, the callbacks may queue more I/O.
+  for (AsyncIO *failed_io : failed) {
+    RunIO(failed_io);
+  }
+}
+
+void DiskManager::RunIO(AsyncIO *io) {
+  bool success;
+  if (io->log_) {
+    std::vector<iovec> iov{{io->data_, io->size_}};
+    success = TransferRun(log_fd_, io->offset_, &iov, true) == static_cast<ssize_t>(io->size_);
+  } else {
+    success = io->write_ ? WriteRun(io->page_id_, &io->data_, 1) : ReadRun(io->page_id_, &io->data_, 1);
+  }
+  io->callback_(success);
+  delete io;
+}
+
+bool DiskManager::SubmitQueuedIO(std::vector<AsyncIO *> *failed) {
+  if (io_queued_ == 0) {
+    return true;
+  }
+  int submitted = io_uring_->Submit();
+  if (submitted <= 0) {
+    // Nothing was taken by the kernel, retrying may fail forever. The I/O is done synchronously instead.
+    LOG_DEBUG("I/O error while submitting, falling back to synchronous I/O");
+    uint64_t user_data;
+    while (io_uring_->Unprepare(&user_data)) {
+      failed->push_back(reinterpret_cast<AsyncIO *>(user_data));
+    }
+    io_queued_ = 0;
+    return false;
+  }
+  io_queued_ -= submitted;
+  io_in_flight_ += submitted;
+  io_cv_.notify_one();
+  return true;
+}
+
+void DiskManager::CompleteIO() {
+  std::unique_lock<std::mutex> lock(io_mutex_);
+  while (true) {
+    io_cv_.wait(lock, [&] { return io_in_flight_ > 0 || io_stop_; });
+    if (io_in_flight_ == 0) {
+      return;
+    }
+    // Wait and run the callbacks without the latch, so that the callers can queue more I/O meanwhile.
+    lock.unlock();
+    if (io_uring_->WaitCompletion() < 0) {
+      LOG_DEBUG("I/O error while waiting for completions");
+    }
+    size_t num_completed = 0;
+    uint64_t user_data;
+    int32_t result;
+    while (io_uring_->PopCompletion(&user_data, &result)) {
+      auto *io = reinterpret_cast<AsyncIO *>(user_data);
+      bool success = result >= 0 && (!io->write_ || result == static_cast<int32_t>(io->size_));
+      if (success && !io->write_ && result < static_cast<int32_t>(io->size_)) {
+        // The file ends before the page does.
+        memset(io->data_ + result, 0, io->size_ - result);
+      }
+      if (io->write_ && !io->log_) {
+        // Counted here rather than when queued, a write that falls back to synchronous I/O is counted by WriteRun.
+        num_writes_ += 1;
+        if (success) {
+          GrowFileSize(io->page_id_ * PAGE_SIZE + result);
+        }
+      }
+      if (!success) {
+        LOG_DEBUG("I/O error in asynchronous I/O");
+      }
+      io->callback_(success);
+      delete io;
+      num_completed++;
+    }
+    lock.lock();
+    io_in_flight_ -= num_completed;
+    io_space_cv_.notify_all();
+  }
+}
+
+void DiskManager::StopAsyncIO() {
+  if (io_thread_ != nullptr) {
+    std::vector<AsyncIO *> failed;
+    {
+      std::unique_lock<std::mutex> lock(io_mutex_);
+      // Nothing queued may be left behind.
+      while (io_queued_ > 0) {
+        SubmitQueuedIO(&failed);
+      }
+      io_stop_ = true;
+      io_cv_.notify_one();
+    }
+    for (AsyncIO *io : failed) {
+      RunIO(io);
+    }
+    io_thread_->join();
+    delete io_thread_;
+    io_thread_ = nullptr;
+  }
+  delete io_uring_;
+  io_uring_ = nullptr;
 }
 
 /**
@@ -134,6 +898,7 @@ void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
  * Only return when sync is done, and only perform sequence write
  */
 void DiskManager::WriteLog(char *log_data, int size) {
+  CheckWritable();
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
@@ -151,15 +916,19 @@ void DiskManager::WriteLog(char *log_data, int size) {
 
   num_flushes_ += 1;
   // sequence write
-  log_io_.write(log_data, size);
+  std::vector<iovec> iov{{log_data, static_cast<size_t>(size)}};
+  ssize_t write_count = TransferRun(log_fd_, log_file_size_.fetch_add(size), &iov, true);
 
   // check for I/O error
-  if (log_io_.bad()) {
+  if (write_count < size) {
     LOG_DEBUG("I/O error while writing log");
     return;
   }
-  // needs to flush to keep disk file in sync
-  log_io_.flush();
+  // The flush is only done once the log is durable.
+  if (fdatasync(log_fd_) != 0) {
+    LOG_DEBUG("I/O error while syncing log");
+    return;
+  }
   flush_log_ = false;
 }
 
@@ -168,23 +937,21 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * Always read from the beginning and perform sequence read
  * @return: false means already reach the end
  */
-bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
+bool DiskManager::ReadLog(char *log_data, int size, int64_t offset) {
+  if (offset >= log_file_size_) {
     // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+    // LOG_DEBUG("file size is %d", log_file_size_.load());
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
+  std::vector<iovec> iov{{log_data, static_cast<size_t>(size)}};
+  ssize_t read_count = TransferRun(log_fd_, offset, &iov, false);
 
-  if (log_io_.bad()) {
+  if (read_count < 0) {
     LOG_DEBUG("I/O error while reading log");
     return false;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
   if (read_count < size) {
-    log_io_.clear();
     memset(log_data + read_count, 0, size - read_count);
   }
 
@@ -206,13 +973,4 @@ int DiskManager::GetNumWrites() const { return num_writes_; }
  */
 bool DiskManager::GetFlushState() const { return flush_log_; }
 
-/**
- * Private helper function to get disk file size
- */
-int DiskManager::GetFileSize(const std::string &file_name) {
-  struct stat stat_buf;
-  int rc = stat(file_name.c_str(), &stat_buf);
-  return rc == 0 ? static_cast<int>(stat_buf.st_size) : -1;
-}
-
 }  // namespace bustub
\ No newline at end of file
@@ -0,0 +1,213 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler.cpp
+//
+// Identification: src/storage/disk/disk_scheduler.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <exception>
+#include <utility>
+
+#include "common/logger.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+DiskScheduler::DiskScheduler(DiskManager *disk_manager, size_t num_workers)
+    : disk_manager_(disk_manager), queues_(disk_manager->GetTablespace().GetNumFiles()) {
+  CHECK(num_workers > 0) << "Expected at least one disk scheduler worker.";
+  for (size_t i = 0; i < std::max(num_workers, queues_.size()); ++i) {
+    workers_.emplace_back(&DiskScheduler::RunWorker, this, &queues_[i % queues_.size()]);
+  }
+}
+
+DiskScheduler::~DiskScheduler() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    stop_ = true;
+  }
+  for (auto &queue : queues_) {
+    queue.cv_.notify_all();
+  }
+  for (auto &worker : workers_) {
+    worker.join();
+  }
+}
+
+DiskScheduler::FileQueue *DiskScheduler::Enqueue(DiskRequest request) {
+  auto *queue = &queues_[disk_manager_->GetTablespace().GetFileIndex(request.page_id_)];
+  queue->by_priority_[static_cast<size_t>(request.priority_)].push_back(std::move(request));
+  queue->num_waiting_++;
+  num_waiting_++;
+  stats_.requests_++;
+  stats_.max_queue_depth_ = std::max(stats_.max_queue_depth_, num_waiting_ + num_in_service_);
+  return queue;
+}
+
+void DiskScheduler::Schedule(DiskRequest request) {
+  std::lock_guard<std::mutex> guard(latch_);
+  Enqueue(std::move(request))->cv_.notify_one();
+}
+
+void DiskScheduler::Schedule(std::vector<DiskRequest> *requests) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    for (auto &request : *requests) {
+      Enqueue(std::move(request));
+    }
+  }
+  requests->clear();
+  for (auto &queue : queues_) {
+    queue.cv_.notify_all();
+  }
+}
+
+std::future<bool> DiskScheduler::ScheduleRead(page_id_t page_id, char *page_data, DiskRequestPriority priority) {
+  DiskRequest request{false, page_data, page_id, std::promise<bool>(), priority};
+  auto future = request.callback_.get_future();
+  Schedule(std::move(request));
+  return future;
+}
+
+std::future<bool> DiskScheduler::ScheduleWrite(page_id_t page_id, const char *page_data,
+                                               DiskRequestPriority priority) {
+  DiskRequest request{true, const_cast<char *>(page_data), page_id, std::promise<bool>(), priority};  // NOLINT
+  auto future = request.callback_.get_future();
+  Schedule(std::move(request));
+  return future;
+}
+
+bool DiskScheduler::ReadPage(page_id_t page_id, char *page_data) {
+  return ServeInline(DiskRequest{false, page_data, page_id, std::promise<bool>()});
+}
+
+bool DiskScheduler::WritePage(page_id_t page_id, const char *page_data) {
+  return ServeInline(DiskRequest{true, const_cast<char *>(page_data), page_id, std::promise<bool>()});  // NOLINT
+}
+
+size_t DiskScheduler::GetQueueDepth() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return num_waiting_ + num_in_service_;
+}
+
+DiskSchedulerStats DiskScheduler::GetStats() {
+  std::lock_guard<std::mutex> guard(latch_);
+  DiskSchedulerStats stats = stats_;
+  stats.queue_depth_ = num_waiting_ + num_in_service_;
+  return stats;
+}
+
+void DiskScheduler::TakeRun(FileQueue *file_queue, std::vector<DiskRequest> *run) {
+  auto queue = std::find_if(file_queue->by_priority_.begin(), file_queue->by_priority_.end(),
+                            [](const auto &queue) { return !queue.empty(); });
+  run->clear();
+  run->push_back(std::move(queue->front()));
+  queue->pop_front();
+  bool is_write = run->front().is_write_;
+  page_id_t first = run->front().page_id_;
+  page_id_t last = first;
+  // Grow the run at both ends until no waiting request extends it, up to the size of one flush batch.
+  const size_t max_run_size = FLUSH_BATCH_SIZE / PAGE_SIZE;
+  bool extended = true;
+  while (extended && run->size() < max_run_size) {
+    extended = false;
+    for (auto it = queue->begin(); it != queue->end() && run->size() < max_run_size;) {
+      if (it->is_write_ != is_write || (it->page_id_ != first - 1 && it->page_id_ != last + 1)) {
+        ++it;
+        continue;
+      }
+      first = std::min(first, it->page_id_);
+      last = std::max(last, it->page_id_);
+      run->push_back(std::move(*it));
+      it = queue->erase(it);
+      extended = true;
+    }
+  }
+}
+
+bool DiskScheduler::ServeInline(DiskRequest request) {
+  {
+    std::unique_lock<std::mutex> lock(latch_);
+    if (queues_[disk_manager_->GetTablespace().GetFileIndex(request.page_id_)].num_waiting_ > 0) {
+      // Queue up behind the requests of the same or a higher priority for the file.
+      auto future = request.callback_.get_future();
+      Enqueue(std::move(request))->cv_.notify_one();
+      lock.unlock();
+      return future.get();
+    }
+    // Nothing to overtake, a hand-off to a worker would only add a context switch.
+    num_in_service_++;
+    stats_.requests_++;
+    stats_.max_queue_depth_ = std::max(stats_.max_queue_depth_, num_in_service_);
+  }
+  bool success;
+  try {
+    success = request.is_write_ ? disk_manager_->WritePages({request.page_id_}, {request.data_})
+                                : disk_manager_->ReadPages({request.page_id_}, {request.data_});
+  } catch (...) {
+    std::lock_guard<std::mutex> guard(latch_);
+    num_in_service_--;
+    throw;
+  }
+  std::lock_guard<std::mutex> guard(latch_);
+  num_in_service_--;
+  return success;
+}
+
+void DiskScheduler::RunWorker(FileQueue *queue) {
+  std::vector<DiskRequest> run;
+  std::vector<page_id_t> page_ids;
+  std::vector<char *> read_data;
+  std::vector<const char *> write_data;
+  std::unique_lock<std::mutex> lock(latch_);
+  while (true) {
+    queue->cv_.wait(lock, [&] { return stop_ || queue->num_waiting_ > 0; });
+    if (queue->num_waiting_ == 0) {
+      // Stopped, and nothing is left to serve.
+      return;
+    }
+    TakeRun(queue, &run);
+    queue->num_waiting_ -= run.size();
+    num_waiting_ -= run.size();
+    num_in_service_ += run.size();
+    stats_.merged_requests_ += run.size() - 1;
+    lock.unlock();
+
+    page_ids.clear();
+    read_data.clear();
+    write_data.clear();
+    for (auto &request : run) {
+      page_ids.push_back(request.page_id_);
+      read_data.push_back(request.data_);
+      write_data.push_back(request.data_);
+    }
+    bool success = false;
+    std::exception_ptr exception;
+    try {
+      success = run.front().is_write_ ? disk_manager_->WritePages(page_ids, write_data)
+                                      : disk_manager_->ReadPages(page_ids, read_data);
+    } catch (...) {
+      // E.g. an unaligned buffer in direct I/O mode, the waiting callers see the exception.
+      exception = std::current_exception();
+    }
+
+    lock.lock();
+    // The requests leave the queue depth before their callers wake up.
+    num_in_service_ -= run.size();
+    for (auto &request : run) {
+      if (exception != nullptr) {
+        request.callback_.set_exception(exception);
+      } else {
+        request.callback_.set_value(success);
+      }
+    }
+  }
+}
+
+}  // namespace bustub
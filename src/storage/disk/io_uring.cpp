@@ -0,0 +1,158 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// io_uring.cpp
+//
+// Identification: src/storage/disk/io_uring.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "storage/disk/io_uring.h"
+
+namespace bustub {
+
+IoUring::IoUring(unsigned num_entries) {
+  io_uring_params params;
+  memset(&params, 0, sizeof(params));
+  int ring_fd = static_cast<int>(syscall(__NR_io_uring_setup, num_entries, &params));
+  if (ring_fd < 0) {
+    return;
+  }
+  sq_ring_size_ = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  cq_ring_size_ = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+  // Since Linux 5.4 both rings live in one mapping.
+  bool single_mmap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+  if (single_mmap) {
+    sq_ring_size_ = cq_ring_size_ = std::max(sq_ring_size_, cq_ring_size_);
+  }
+  sq_ring_ = mmap(nullptr, sq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                  IORING_OFF_SQ_RING);
+  cq_ring_ = single_mmap || sq_ring_ == MAP_FAILED
+                 ? sq_ring_
+                 : mmap(nullptr, cq_ring_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd,
+                        IORING_OFF_CQ_RING);
+  sqes_size_ = params.sq_entries * sizeof(io_uring_sqe);
+  void *sqes = mmap(nullptr, sqes_size_, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring_fd, IORING_OFF_SQES);
+  if (sq_ring_ == MAP_FAILED || cq_ring_ == MAP_FAILED || sqes == MAP_FAILED) {
+    if (sqes != MAP_FAILED) {
+      munmap(sqes, sqes_size_);
+    }
+    if (cq_ring_ != MAP_FAILED && cq_ring_ != sq_ring_) {
+      munmap(cq_ring_, cq_ring_size_);
+    }
+    if (sq_ring_ != MAP_FAILED) {
+      munmap(sq_ring_, sq_ring_size_);
+    }
+    sq_ring_ = cq_ring_ = nullptr;
+    close(ring_fd);
+    return;
+  }
+  auto *sq = static_cast<char *>(sq_ring_);
+  sq_head_ = reinterpret_cast<unsigned *>(sq + params.sq_off.head);
+  sq_tail_ = reinterpret_cast<unsigned *>(sq + params.sq_off.tail);
+  sq_array_ = reinterpret_cast<unsigned *>(sq + params.sq_off.array);
+  sq_mask_ = *reinterpret_cast<unsigned *>(sq + params.sq_off.ring_mask);
+  sq_entries_ = params.sq_entries;
+  auto *cq = static_cast<char *>(cq_ring_);
+  cq_head_ = reinterpret_cast<unsigned *>(cq + params.cq_off.head);
+  cq_tail_ = reinterpret_cast<unsigned *>(cq + params.cq_off.tail);
+  cqes_ = reinterpret_cast<io_uring_cqe *>(cq + params.cq_off.cqes);
+  cq_mask_ = *reinterpret_cast<unsigned *>(cq + params.cq_off.ring_mask);
+  cq_entries_ = params.cq_entries;
+  sqes_ = static_cast<io_uring_sqe *>(sqes);
+  ring_fd_ = ring_fd;
+}
+
+IoUring::~IoUring() {
+  if (ring_fd_ < 0) {
+    return;
+  }
+  munmap(sqes_, sqes_size_);
+  if (cq_ring_ != sq_ring_) {
+    munmap(cq_ring_, cq_ring_size_);
+  }
+  munmap(sq_ring_, sq_ring_size_);
+  close(ring_fd_);
+}
+
+bool IoUring::Prepare(uint8_t opcode, int fd, void *buffer, uint32_t size, off_t offset, uint64_t user_data) {
+  // Only the kernel moves the head, only we move the tail.
+  unsigned tail = *sq_tail_;
+  if (tail - __atomic_load_n(sq_head_, __ATOMIC_ACQUIRE) >= sq_entries_) {
+    return false;
+  }
+  unsigned index = tail & sq_mask_;
+  io_uring_sqe *sqe = &sqes_[index];
+  memset(sqe, 0, sizeof(*sqe));
+  sqe->opcode = opcode;
+  sqe->fd = fd;
+  sqe->addr = reinterpret_cast<uint64_t>(buffer);
+  sqe->len = size;
+  sqe->off = static_cast<uint64_t>(offset);
+  sqe->user_data = user_data;
+  sq_array_[index] = index;
+  // Publish the entry to the kernel only once it is filled in.
+  __atomic_store_n(sq_tail_, tail + 1, __ATOMIC_RELEASE);
+  num_prepared_++;
+  return true;
+}
+
+int IoUring::Submit() {
+  while (true) {
+    int submitted = static_cast<int>(syscall(__NR_io_uring_enter, ring_fd_, num_prepared_, 0, 0, nullptr, 0));
+    if (submitted >= 0) {
+      num_prepared_ -= static_cast<unsigned>(submitted);
+      return submitted;
+    }
+    if (errno != EINTR) {
+      return -errno;
+    }
+  }
+}
+
+bool IoUring::Unprepare(uint64_t *user_data) {
+  if (num_prepared_ == 0) {
+    return false;
+  }
+  // The kernel only reads the submission queue during Submit, an entry it did not take is still ours.
+  unsigned tail = *sq_tail_ - 1;
+  *user_data = sqes_[tail & sq_mask_].user_data;
+  __atomic_store_n(sq_tail_, tail, __ATOMIC_RELEASE);
+  num_prepared_--;
+  return true;
+}
+
+int IoUring::WaitCompletion() {
+  while (__atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE) == *cq_head_) {
+    if (syscall(__NR_io_uring_enter, ring_fd_, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0) < 0 && errno != EINTR) {
+      return -errno;
+    }
+  }
+  return 0;
+}
+
+bool IoUring::PopCompletion(uint64_t *user_data, int32_t *result) {
+  // Only the kernel moves the tail, only we move the head.
+  unsigned head = *cq_head_;
+  if (head == __atomic_load_n(cq_tail_, __ATOMIC_ACQUIRE)) {
+    return false;
+  }
+  io_uring_cqe *cqe = &cqes_[head & cq_mask_];
+  *user_data = cqe->user_data;
+  *result = cqe->res;
+  // Hand the entry back to the kernel only once it is read.
+  __atomic_store_n(cq_head_, head + 1, __ATOMIC_RELEASE);
+  return true;
+}
+
+}  // namespace bustub
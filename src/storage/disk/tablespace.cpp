@@ -0,0 +1,236 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tablespace.cpp
+//
+// Identification: src/storage/disk/tablespace.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <string>
+
+#include "common/exception.h"
+#include "common/logger.h"
+#include "storage/disk/tablespace.h"
+
+namespace bustub {
+
+Tablespace::Tablespace(const std::string &db_file, const std::vector<std::string> &directories, size_t stripe_size,
+                       bool direct_io, bool read_only)
+    : stripe_pages_(std::max<size_t>(stripe_size / PAGE_SIZE, 1)), read_only_(read_only) {
+  if (directories.empty()) {
+    files_.push_back(DataFile{db_file, -1, 0, 0, nullptr});
+  } else {
+    // dir/test.0.db, dir/test.1.db, ... for test.db, so that no two files share a name even in the same directory.
+    std::string::size_type slash = db_file.rfind('/');
+    std::string base_name = slash == std::string::npos ? db_file : db_file.substr(slash + 1);
+    std::string::size_type dot = base_name.rfind('.');
+    std::string stem = dot == std::string::npos ? base_name : base_name.substr(0, dot);
+    std::string extension = dot == std::string::npos ? "" : base_name.substr(dot);
+    for (size_t i = 0; i < directories.size(); ++i) {
+      files_.push_back(DataFile{directories[i] + "/" + stem + "." + std::to_string(i) + extension, -1, 0, 0, nullptr});
+    }
+  }
+  struct stat stat_buf;
+  for (const auto &file : files_) {
+    is_new_ = is_new_ && stat(file.name_.c_str(), &stat_buf) != 0;
+  }
+  // The mappings go through the OS page cache, O_DIRECT would be of no use.
+  direct_io_ = direct_io && !read_only_ && Open(true, false);
+  if (!direct_io_) {
+    Open(false, read_only_);
+  }
+  for (auto &file : files_) {
+    file.size_ = fstat(file.fd_, &stat_buf) == 0 ? static_cast<int64_t>(stat_buf.st_size) : 0;
+    // What was preallocated past the end of the file before is not known, it is reserved again as pages are allocated.
+    file.reserved_size_ = file.size_;
+    if (!read_only_ || file.size_ == 0) {
+      continue;
+    }
+    void *mapping = mmap(nullptr, file.size_, PROT_READ, MAP_SHARED, file.fd_, 0);
+    if (mapping == MAP_FAILED) {
+      Close();
+      throw Exception("can't map db file");
+    }
+    file.mapping_ = static_cast<char *>(mapping);
+  }
+}
+
+Tablespace::~Tablespace() { Close(); }
+
+void Tablespace::Close() {
+  for (auto &file : files_) {
+    if (file.mapping_ != nullptr) {
+      munmap(file.mapping_, file.size_);
+      file.mapping_ = nullptr;
+    }
+    if (file.fd_ >= 0) {
+      close(file.fd_);
+      file.fd_ = -1;
+    }
+  }
+}
+
+bool Tablespace::Open(bool direct_io, bool read_only) {
+  int flags = (read_only ? O_RDONLY : O_RDWR | O_CREAT) | (direct_io ? O_DIRECT : 0);
+  for (size_t i = 0; i < files_.size(); ++i) {
+    files_[i].fd_ = open(files_[i].name_.c_str(), flags, 0644);
+    if (files_[i].fd_ >= 0) {
+      continue;
+    }
+    bool unsupported = direct_io && errno == EINVAL;
+    Close();
+    if (unsupported) {
+      LOG_WARN("direct I/O is not supported for %s, falling back to buffered I/O", files_[i].name_.c_str());
+      return false;
+    }
+    throw Exception("can't open db file");
+  }
+  return true;
+}
+
+size_t Tablespace::GetFileIndex(page_id_t page_id) const {
+  return static_cast<size_t>(page_id) / stripe_pages_ % files_.size();
+}
+
+off_t Tablespace::GetFileOffset(page_id_t page_id) const {
+  auto stripe = static_cast<size_t>(page_id) / stripe_pages_;
+  auto local_page = stripe / files_.size() * stripe_pages_ + static_cast<size_t>(page_id) % stripe_pages_;
+  return static_cast<off_t>(local_page) * PAGE_SIZE;
+}
+
+size_t Tablespace::GetRunLength(page_id_t page_id, size_t num_pages) const {
+  if (files_.size() == 1) {
+    return num_pages;
+  }
+  return std::min(num_pages, stripe_pages_ - static_cast<size_t>(page_id) % stripe_pages_);
+}
+
+const char *Tablespace::GetMappedPage(page_id_t page_id) const {
+  const auto &file = files_[GetFileIndex(page_id)];
+  off_t offset = GetFileOffset(page_id);
+  if (file.mapping_ == nullptr || offset + PAGE_SIZE > file.size_) {
+    return nullptr;
+  }
+  return file.mapping_ + offset;
+}
+
+/**
+ * Passes a hint for a piece of one file on to its mapping
+ * @param length length of the piece, 0 for up to the end of the file
+ */
+static void AdviseMapping(char *mapping, int64_t size, off_t offset, off_t length, AccessHint hint) {
+  if (mapping == nullptr) {
+    return;
+  }
+  static const int madvice[] = {MADV_NORMAL, MADV_SEQUENTIAL, MADV_WILLNEED};
+  int64_t end = length == 0 ? size : std::min<int64_t>(offset + length, size);
+  // madvise wants the range to start at a page of the OS.
+  static const off_t os_page_size = sysconf(_SC_PAGESIZE);
+  offset -= offset % os_page_size;
+  if (offset < end) {
+    madvise(mapping + offset, end - offset, madvice[static_cast<int>(hint)]);
+  }
+}
+
+void Tablespace::Advise(page_id_t page_id, size_t num_pages, AccessHint hint) const {
+  // Only the mappings take a hint for a range. posix_fadvise applies POSIX_FADV_SEQUENTIAL and POSIX_FADV_NORMAL to
+  // the whole open file on Linux, a scan ending would reset the hint of another one.
+  if (page_id < 0 || !read_only_) {
+    return;
+  }
+  if (num_pages == 0) {
+    // Each file from its first page at or past page_id on, that is in the stripe of page_id or in a later one.
+    auto stripe = static_cast<size_t>(page_id) / stripe_pages_;
+    for (size_t i = 0; i < files_.size(); ++i) {
+      auto file_stripe = stripe + (i + files_.size() - stripe % files_.size()) % files_.size();
+      auto first_local_page = file_stripe / files_.size() * stripe_pages_;
+      off_t offset = file_stripe == stripe ? GetFileOffset(page_id) : static_cast<off_t>(first_local_page * PAGE_SIZE);
+      AdviseMapping(files_[i].mapping_, files_[i].size_, offset, 0, hint);
+    }
+    return;
+  }
+  for (size_t done = 0, count; done < num_pages; done += count) {
+    page_id_t first = page_id + done;
+    count = GetRunLength(first, num_pages - done);
+    const auto &file = files_[GetFileIndex(first)];
+    AdviseMapping(file.mapping_, file.size_, GetFileOffset(first), static_cast<off_t>(count * PAGE_SIZE), hint);
+  }
+}
+
+int64_t Tablespace::GetSize() const {
+  if (files_.size() == 1) {
+    return files_[0].size_;
+  }
+  int64_t size = 0;
+  for (size_t i = 0; i < files_.size(); ++i) {
+    if (files_[i].size_ == 0) {
+      continue;
+    }
+    // Map the last page of the file back to its page id.
+    auto last_local_page = static_cast<size_t>((files_[i].size_ - 1) / PAGE_SIZE);
+    auto stripe = last_local_page / stripe_pages_ * files_.size() + i;
+    auto page_id = static_cast<int64_t>(stripe * stripe_pages_ + last_local_page % stripe_pages_);
+    size = std::max(size, (page_id + 1) * PAGE_SIZE);
+  }
+  return size;
+}
+
+void Tablespace::Reserve(page_id_t page_id, size_t extent_size) {
+  auto extent = static_cast<int64_t>(extent_size / PAGE_SIZE * PAGE_SIZE);
+  std::lock_guard<std::mutex> guard(latch_);
+  auto &file = files_[GetFileIndex(page_id)];
+  int64_t end = GetFileOffset(page_id) + PAGE_SIZE;
+  if (end <= file.reserved_size_ || !preallocate_ || extent == 0 || file.fd_ < 0) {
+    return;
+  }
+  // Extents start at multiples of the extent size, a reservation that was cut short is completed first.
+  int64_t new_reserved_size = (end + extent - 1) / extent * extent;
+  int result;
+  do {
+    result = fallocate(file.fd_, FALLOC_FL_KEEP_SIZE, file.reserved_size_, new_reserved_size - file.reserved_size_);
+  } while (result != 0 && errno == EINTR);
+  if (result != 0) {
+    if (errno == EOPNOTSUPP || errno == ENOSYS) {
+      LOG_WARN("preallocation is not supported for %s, the file grows page by page", file.name_.c_str());
+      preallocate_ = false;
+    } else {
+      LOG_DEBUG("I/O error while preallocating");
+    }
+    return;
+  }
+  file.reserved_size_ = new_reserved_size;
+}
+
+int64_t Tablespace::GetReservedSize() {
+  std::lock_guard<std::mutex> guard(latch_);
+  int64_t reserved_size = 0;
+  for (const auto &file : files_) {
+    reserved_size += file.reserved_size_;
+  }
+  return reserved_size;
+}
+
+bool Tablespace::Sync() {
+  if (read_only_) {
+    return true;
+  }
+  bool success = true;
+  for (const auto &file : files_) {
+    if (file.fd_ >= 0 && fdatasync(file.fd_) != 0) {
+      success = false;
+    }
+  }
+  return success;
+}
+
+}  // namespace bustub
@@ -45,7 +45,7 @@ bool BPLUSTREE_TYPE::IsEmpty() const {
  */
 INDEX_TEMPLATE_ARGUMENTS
 bool BPLUSTREE_TYPE::GetValue(const KeyType &key, std::vector<ValueType> *result, Transaction *transaction) {
-  BPlusTreePage *curr = AcquireReadLatch(key, transaction);
+  BPlusTreePage *curr = AcquireOptimisticReadLatch(key, transaction);
   if (!curr) {
     return false;
   }
@@ -203,6 +203,68 @@ BPlusTreePage *BPLUSTREE_TYPE::AcquireReadLatch(const KeyType &key, Transaction
   return curr;
 }
 
+/*
+ * Optimistic lock coupling: an internal page is only pinned, its version is
+ * read before and validated after looking up the child. The parent is
+ * validated again once the child's version (or, for the leaf, its latch) is
+ * taken, which proves the parent still pointed to that child. Any failed
+ * validation restarts from the root, and after OPTIMISTIC_READ_RETRIES
+ * restarts we fall back to latching every page on the way down.
+ * Only the leaf ends up in the page set, write latched as in AcquireReadLatch.
+ */
+INDEX_TEMPLATE_ARGUMENTS
+BPlusTreePage *BPLUSTREE_TYPE::AcquireOptimisticReadLatch(const KeyType &key, Transaction *transaction) {
+  for (int attempt = 0; attempt < OPTIMISTIC_READ_RETRIES; attempt++) {
+    page_id_t root_id = GetRootPageID();
+    if (root_id == INVALID_PAGE_ID) {
+      return nullptr;
+    }
+    Page *parent_page = nullptr;
+    uint64_t parent_version = 0;
+    Page *curr_page = buffer_pool_manager_->FetchPage(root_id);
+    while (1) {
+      BPlusTreePage *curr = reinterpret_cast<BPlusTreePage *>(curr_page->GetData());
+      if (curr->IsLeafPage()) {
+        curr_page->WLatch();
+        bool valid = curr->IsLeafPage() && (parent_page == nullptr ? root_id == GetRootPageID()
+                                                                     : parent_page->ValidateVersion(parent_version));
+        if (parent_page) {
+          buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), false);
+        }
+        if (valid) {
+          transaction->AddIntoPageSet(curr_page);
+          return curr;
+        }
+        curr_page->WUnlatch();
+        buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+        break;
+      }
+      uint64_t version = curr_page->ReadVersion();
+      bool valid = curr_page->ValidateVersion(version) &&
+                   (parent_page == nullptr ? root_id == GetRootPageID() : parent_page->ValidateVersion(parent_version));
+      if (parent_page) {
+        buffer_pool_manager_->UnpinPage(parent_page->GetPageId(), false);
+        parent_page = nullptr;
+      }
+      page_id_t child = INVALID_PAGE_ID;
+      if (valid) {
+        child = reinterpret_cast<InternalPage *>(curr)->Lookup(key, comparator_);
+        // Never follow a child id read from a page that changed underneath us.
+        valid = curr_page->ValidateVersion(version);
+      }
+      if (!valid) {
+        buffer_pool_manager_->UnpinPage(curr_page->GetPageId(), false);
+        break;
+      }
+      parent_page = curr_page;
+      parent_version = version;
+      curr_page = buffer_pool_manager_->FetchPage(child);
+      CHECK(curr_page) << "Expected child page " << child << " to be fetched.";
+    }
+  }
+  return AcquireReadLatch(key, transaction);
+}
+
 INDEX_TEMPLATE_ARGUMENTS
 BPlusTreePage *BPLUSTREE_TYPE::AcquireWriteLatch(const KeyType &key, Transaction *transaction) {
   // TODO: no need to acquire all locks from root to leaf, can release some
@@ -335,7 +397,7 @@ template <typename N>
 N *BPLUSTREE_TYPE::Split(N *node) {
   page_id_t new_page_id;
   Page *new_page = buffer_pool_manager_->NewPage(&new_page_id);
-  N *new_node = reinterpret_cast<N *>(new_page);
+  N *new_node = reinterpret_cast<N *>(new_page->GetData());
   CHECK(new_page_id >= 0);
   new_node->SetPageId(new_page_id);
   new_node->SetParentPageId(node->GetParentPageId());
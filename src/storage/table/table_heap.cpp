@@ -22,13 +22,17 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      compressed_(buffer_pool_manager->IsPageCompressed(first_page_id)) {}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+                     Transaction *txn, bool compressed)
+    : buffer_pool_manager_(buffer_pool_manager),
+      lock_manager_(lock_manager),
+      log_manager_(log_manager),
+      compressed_(compressed) {
   // Initialize the first table page.
-  auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
+  auto first_page = reinterpret_cast<TablePage *>(NewPage(&first_page_id_, nullptr));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
   first_page->WLatch();
   first_page->Init(first_page_id_, PAGE_SIZE, INVALID_LSN, log_manager_, txn);
@@ -36,13 +40,13 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
   buffer_pool_manager_->UnpinPage(first_page_id_, true);
 }
 
-bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
+bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, BufferAccessStrategy *strategy) {
   if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
 
-  auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
+  auto cur_page = static_cast<TablePage *>(FetchPage(first_page_id_, strategy));
   if (cur_page == nullptr) {
     txn->SetState(TransactionState::ABORTED);
     return false;
@@ -60,11 +64,11 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       cur_page->WUnlatch();
       buffer_pool_manager_->UnpinPage(cur_page->GetTablePageId(), false);
       // And repeat the process with the next page.
-      cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(next_page_id));
+      cur_page = static_cast<TablePage *>(FetchPage(next_page_id, strategy));
       cur_page->WLatch();
     } else {
       // Otherwise we have run out of valid pages. We need to create a new page.
-      auto new_page = static_cast<TablePage *>(buffer_pool_manager_->NewPage(&next_page_id));
+      auto new_page = static_cast<TablePage *>(NewPage(&next_page_id, strategy));
       // If we could not create a new page,
       if (new_page == nullptr) {
         // Then life sucks and we abort the transaction.
@@ -170,18 +174,24 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   return res;
 }
 
-TableIterator TableHeap::Begin(Transaction *txn) {
+TableIterator TableHeap::Begin(Transaction *txn, BufferAccessStrategy *strategy) {
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to
   // handle this.
   RID rid;
   auto page_id = first_page_id_;
+  // A scan reads the pages from the first one on, mostly in order as they were allocated in order.
+  buffer_pool_manager_->AdviseAccess(first_page_id_, 0, AccessHint::SEQUENTIAL);
   while (page_id != INVALID_PAGE_ID) {
-    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    auto page = static_cast<TablePage *>(FetchPage(page_id, strategy));
     page->RLatch();
     // If this fails because there is no tuple, then RID will be the
     // default-constructed value, which means EOF.
     auto found_tuple = page->GetFirstTupleRid(&rid);
+    if (found_tuple) {
+      // The iterator moves on to the next page once this one is scanned, start reading it now.
+      buffer_pool_manager_->PrefetchPage(page->GetNextPageId());
+    }
     page->RUnlatch();
     buffer_pool_manager_->UnpinPage(page_id, false);
     if (found_tuple) {
@@ -189,7 +199,22 @@ TableIterator TableHeap::Begin(Transaction *txn) {
     }
     page_id = page->GetNextPageId();
   }
-  return TableIterator(this, rid, txn);
+  return TableIterator(this, rid, txn, strategy);
+}
+
+Page *TableHeap::FetchPage(page_id_t page_id, BufferAccessStrategy *strategy) {
+  return strategy == nullptr ? buffer_pool_manager_->FetchPage(page_id)
+                             : buffer_pool_manager_->FetchPage(page_id, *strategy);
+}
+
+Page *TableHeap::NewPage(page_id_t *page_id, BufferAccessStrategy *strategy) {
+  Page *page = strategy == nullptr ? buffer_pool_manager_->NewPage(page_id)
+                                   : buffer_pool_manager_->NewPage(page_id, *strategy);
+  // The page is pinned, it is not written before it is marked.
+  if (page != nullptr && compressed_) {
+    buffer_pool_manager_->SetPageCompression(*page_id, true);
+  }
+  return page;
 }
 
 TableIterator TableHeap::End() { return TableIterator(this, RID(INVALID_PAGE_ID, 0), nullptr); }
@@ -0,0 +1,114 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// arc_replacer_test.cpp
+//
+// Identification: test/buffer/arc_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "../test/buffer/replacer_trace.h"
+#include "buffer/arc_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(ARCReplacerTest, SampleTest) {
+  ARCReplacer arc_replacer(4);
+
+  // Scenario: pages 10..13 are accessed once and land in T1, then page 10 is
+  // accessed again and moves to T2.
+  for (frame_id_t frame_id = 0; frame_id < 4; ++frame_id) {
+    arc_replacer.RecordAccess(frame_id, 10 + frame_id);
+    arc_replacer.Unpin(frame_id);
+  }
+  arc_replacer.Pin(0);
+  arc_replacer.RecordAccess(0, 10);
+  arc_replacer.Unpin(0);
+  EXPECT_EQ(4, arc_replacer.Size());
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+
+  // Scenario: with a target of 0 for T1, victims come from T1 in LRU order.
+  int value;
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+
+  // Scenario: page 11 comes back. It hits the B1 ghost list, which raises the
+  // target of T1, and it is now frequent.
+  arc_replacer.RecordAccess(1, 11);
+  arc_replacer.Unpin(1);
+  EXPECT_EQ(1, arc_replacer.GetB1Hits());
+  EXPECT_EQ(0, arc_replacer.GetB2Hits());
+  EXPECT_EQ(1, arc_replacer.GetTarget());
+
+  // Scenario: T1 only holds page 13 now, which does not exceed the target, so
+  // the LRU page of T2 (page 10) is the victim and becomes a B2 ghost.
+  arc_replacer.Pin(3);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(0, value);
+  arc_replacer.RecordAccess(0, 10);
+  arc_replacer.Unpin(0);
+  EXPECT_EQ(1, arc_replacer.GetB2Hits());
+  EXPECT_EQ(0, arc_replacer.GetTarget());
+
+  // Scenario: pinned frames are never victims.
+  EXPECT_EQ(2, arc_replacer.Size());
+  arc_replacer.Victim(&value);
+  arc_replacer.Victim(&value);
+  EXPECT_FALSE(arc_replacer.Victim(&value));
+  arc_replacer.Unpin(3);
+  arc_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+
+  // Scenario: a forgotten page, e.g. a deleted one, is no ghost hit when its id
+  // is used again, and the counters can be reset.
+  arc_replacer.Forget(13);
+  arc_replacer.RecordAccess(3, 13);
+  EXPECT_EQ(1, arc_replacer.GetB1Hits());
+  EXPECT_EQ(1, arc_replacer.GetB2Hits());
+  arc_replacer.ResetHits();
+  EXPECT_EQ(0, arc_replacer.GetB1Hits());
+  EXPECT_EQ(0, arc_replacer.GetB2Hits());
+}
+
+// Compares hit ratios while the workload shifts from a looping recency-heavy phase
+// to Zipfian point lookups mixed with a large scan.
+TEST(ARCReplacerTest, HitRatioBenchmark) {
+  const size_t num_frames = 256;
+  std::vector<TraceAccess> trace;
+  // Recency phase: a loop over a working set that fits in the pool.
+  for (size_t i = 0; i < 50000; ++i) {
+    trace.push_back({static_cast<page_id_t>(100000 + i % 200), false});
+  }
+  auto mixed = MakeScanZipfianTrace(100000, 1024, 16384, 15445);
+  trace.insert(trace.end(), mixed.begin(), mixed.end());
+
+  LRUReplacer lru_replacer(num_frames);
+  LRUKReplacer lru_k_replacer(num_frames, 2);
+  ARCReplacer arc_replacer(num_frames);
+  auto lru = ReplayTrace(&lru_replacer, num_frames, trace);
+  auto lru_k = ReplayTrace(&lru_k_replacer, num_frames, trace);
+  auto arc = ReplayTrace(&arc_replacer, num_frames, trace);
+
+  std::cout << "replacer  lookup hit ratio  overall hit ratio" << std::endl;
+  for (auto &[name, result] : {std::make_pair("lru", lru), std::make_pair("lru-2", lru_k),
+                               std::make_pair("arc", arc)}) {
+    printf("%-8s  %16.4f  %17.4f\n", name, result.LookupHitRatio(), result.HitRatio());
+  }
+  std::cout << "arc target: " << arc_replacer.GetTarget() << " b1 hits: " << arc_replacer.GetB1Hits()
+            << " b2 hits: " << arc_replacer.GetB2Hits() << std::endl;
+  EXPECT_GT(arc.LookupHitRatio(), lru.LookupHitRatio());
+}
+
+}  // namespace bustub
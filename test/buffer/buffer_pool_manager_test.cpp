@@ -11,16 +11,48 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <cinttypes>
 #include <cstdio>
+#include <iostream>
+#include <memory>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "common/config_guard.h"
 #include "gtest/gtest.h"
 
 namespace bustub {
 
+/** Exposes whether a page is cached, to tell hits from misses. */
+class ResidencyBufferPoolManager : public BufferPoolManager {
+ public:
+  using BufferPoolManager::BufferPoolManager;
+  using BufferPoolManager::Exist;
+};
+
+class BufferPoolManagerTest : public ::testing::Test {
+ protected:
+  // A test that failed half-way leaves its files behind, the next one must not open them.
+  void SetUp() override { RemoveFiles(); }
+
+  void TearDown() override { RemoveFiles(); }
+
+  static void RemoveFiles() {
+    remove("test.db");
+    remove("test.log");
+    remove("test.fsm");
+    remove("test.cmap");
+    remove("test.cdat");
+  }
+};
+
 // NOLINTNEXTLINE
 // Check whether pages containing terminal characters can be recovered
-TEST(BufferPoolManagerTest, BinaryDataTest) {
+TEST_F(BufferPoolManagerTest, BinaryDataTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -79,16 +111,16 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   EXPECT_EQ(0, memcmp(page0->GetData(), random_binary_data, PAGE_SIZE));
   EXPECT_EQ(true, bpm->UnpinPage(0, true));
 
+  delete bpm;
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
 
-  delete bpm;
   delete disk_manager;
 }
 
 // NOLINTNEXTLINE
-TEST(BufferPoolManagerTest, SampleTest) {
+TEST_F(BufferPoolManagerTest, SampleTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 10;
 
@@ -137,15 +169,15 @@ TEST(BufferPoolManagerTest, SampleTest) {
   EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
   EXPECT_EQ(nullptr, bpm->FetchPage(0));
 
+  delete bpm;
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
 
-  delete bpm;
   delete disk_manager;
 }
 
-TEST(BufferPoolManagerTest, FlushTest) {
+TEST_F(BufferPoolManagerTest, FlushTest) {
   const std::string db_name = "test.db";
   const size_t buffer_pool_size = 1;
 
@@ -175,12 +207,1008 @@ TEST(BufferPoolManagerTest, FlushTest) {
   page0 = bpm->FetchPage(0);
   EXPECT_EQ(0, strcmp(page0->GetData(), "Hello"));
 
+  delete bpm;
   // Shutdown the disk manager and remove the temporary file we created.
   disk_manager->ShutDown();
   remove("test.db");
 
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, UnpinDoesNotWriteTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  // Keep the background writer idle.
+  ConfigGuard bg_flush_interval_guard(&bg_flush_interval, std::chrono::milliseconds(10000));
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  page_id_t page_id_temp;
+  auto *page0 = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page0);
+  snprintf(page0->GetData(), PAGE_SIZE, "Hello");
+
+  // Scenario: Unpinning a dirty page keeps it dirty in the pool instead of writing it.
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+  EXPECT_TRUE(page0->IsDirty());
+
+  // Scenario: A later clean unpin must not lose the dirty flag.
+  ASSERT_EQ(page0, bpm->FetchPage(page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_TRUE(page0->IsDirty());
+
+  // Scenario: Flushing writes it and marks it clean.
+  EXPECT_EQ(true, bpm->FlushPage(page_id_temp));
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  EXPECT_FALSE(page0->IsDirty());
+
   delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, BackgroundWriterTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  // Write back every dirty page quickly and keep two clean frames in reserve.
+  ConfigGuard bg_flush_interval_guard(&bg_flush_interval, std::chrono::milliseconds(10));
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 0.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 2);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(static_cast<page_id_t>(i), page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %zu", i);
+  }
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(i, true));
+  }
+
+  // Scenario: The background writer eventually writes back every dirty page.
+  for (int retry = 0; retry < 200 && disk_manager->GetNumWrites() < static_cast<int>(buffer_pool_size); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+
+  // Scenario: New pages evict the clean frames without writing them again. The new pages are dirty, the background
+  // writer writes each of them back once.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  for (int retry = 0; retry < 200 && disk_manager->GetNumWrites() < static_cast<int>(2 * buffer_pool_size); ++retry) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_EQ(static_cast<int>(2 * buffer_pool_size), disk_manager->GetNumWrites());
+
+  // Scenario: The data written behind can be fetched back.
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    auto *page = bpm->FetchPage(i);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Hello " + std::to_string(i), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(i, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, DirtyVictimTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+
+  // The background writer only runs when it is asked to.
+  ConfigGuard bg_flush_interval_guard(&bg_flush_interval, std::chrono::milliseconds(10000));
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %zu", i);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  EXPECT_EQ(0, disk_manager->GetNumWrites());
+
+  // Scenario: With every frame dirty, a new page waits for the background writer to write back and free a victim.
+  page_id_t page_id_temp;
+  auto *page = bpm->NewPage(&page_id_temp);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(static_cast<page_id_t>(buffer_pool_size), page_id_temp);
+  EXPECT_EQ(1, disk_manager->GetNumWrites());
+  BufferPoolStats stats = bpm->GetStats();
+  EXPECT_EQ(1U, stats.dirty_write_backs_);
+  EXPECT_EQ(1U, stats.evictions_);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+
+  // Scenario: The victim is read back as it was written.
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("Hello 0", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  EXPECT_EQ(2, disk_manager->GetNumWrites());
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, ReplacerTypeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K, ReplacerType::ARC}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, replacer_type);
+
+    // Scenario: Fill the pool, unpin everything and cycle twice as many pages through it.
+    for (size_t i = 0; i < buffer_pool_size * 3; ++i) {
+      page_id_t page_id_temp;
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    // Scenario: Every page can be fetched back, and a fully pinned pool rejects new pages.
+    for (size_t i = 0; i < buffer_pool_size * 3; ++i) {
+      auto page_id = static_cast<page_id_t>(i);
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("Hello " + std::to_string(page_id), std::string(page->GetData()));
+      if (i < buffer_pool_size * 2) {
+        EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+      }
+    }
+    page_id_t page_id_temp;
+    EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+    delete bpm;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, LRUKScanResistanceTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const page_id_t num_hot_pages = 5;
+  const page_id_t num_pages = 40;
+  // Keep the background writer and read-ahead from evicting pages on their own.
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ResidencyBufferPoolManager(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU_K);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+  for (int round = 0; round < 3; ++round) {
+    for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  // Scenario: A scan fetches each of its pages once per tuple, the way TableIterator and TableHeap::GetTuple do, while
+  // the hot pages keep being referenced. The repeated fetches count as one reference, the hot pages stay cached.
+  for (page_id_t page_id = num_hot_pages; page_id < num_pages; ++page_id) {
+    for (int tuple = 0; tuple < 4; ++tuple) {
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+    auto hot_page_id = page_id % num_hot_pages;
+    ASSERT_NE(nullptr, bpm->FetchPage(hot_page_id));
+    EXPECT_TRUE(bpm->UnpinPage(hot_page_id, false));
+  }
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    EXPECT_TRUE(bpm->Exist(page_id)) << "hot page " << page_id << " was evicted by the scan";
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, ReadAheadTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 10;
+  const size_t num_pages = 30;
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 4);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  auto wait_for_read_ahead = [&](uint64_t num_read_ahead) {
+    for (int i = 0; i < 100 && bpm->GetNumReadAheadPages() < num_read_ahead; ++i) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    return bpm->GetNumReadAheadPages() >= num_read_ahead;
+  };
+  // Let the background writer refill the free frame reserve, read-ahead only uses free frames.
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+  // Scenario: A hinted page is read in the background and can then be fetched.
+  EXPECT_EQ(0, bpm->GetNumReadAheadPages());
+  bpm->PrefetchPage(5);
+  EXPECT_TRUE(wait_for_read_ahead(1));
+
+  // Scenario: Two misses on consecutive pages start a sequential run, pages after them are read ahead.
+  for (page_id_t page_id = 0; page_id < 2; ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_TRUE(wait_for_read_ahead(2));
+
+  // Scenario: Whatever was read ahead, a scan over all pages sees the right content.
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Hello " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const page_id_t num_pages = 16;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  bpm->FlushAllPages();
+  ASSERT_NE(nullptr, bpm->FetchPage(15));
+  EXPECT_EQ(true, bpm->UnpinPage(15, false));
+
+  // Scenario: A batch of cached and missing pages, with a duplicate, comes back pinned in order.
+  std::vector<page_id_t> page_ids{15, 3, 1, 2, 3};
+  std::vector<Page *> pages;
+  EXPECT_TRUE(bpm->FetchPages(page_ids, &pages));
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ(page_ids[i], pages[i]->GetPageId());
+    EXPECT_EQ("Hello " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+  }
+  EXPECT_EQ(pages[1], pages[4]);
+  EXPECT_EQ(2, pages[1]->GetPinCount());
+
+  // Scenario: A batch larger than what is left of the pool gets as many pages as there are frames.
+  std::vector<page_id_t> more_page_ids{4, 5, 6, 7, 8, 9, 10};
+  std::vector<Page *> more_pages;
+  EXPECT_FALSE(bpm->FetchPages(more_page_ids, &more_pages));
+  size_t num_fetched = 0;
+  for (size_t i = 0; i < more_page_ids.size(); ++i) {
+    if (more_pages[i] != nullptr) {
+      num_fetched++;
+      EXPECT_EQ("Hello " + std::to_string(more_page_ids[i]), std::string(more_pages[i]->GetData()));
+      EXPECT_EQ(true, bpm->UnpinPage(more_page_ids[i], false));
+    }
+  }
+  EXPECT_EQ(buffer_pool_size - 4, num_fetched);
+
+  // Scenario: Every pin of the batch can be dropped.
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+  EXPECT_EQ(0, pages[1]->GetPinCount());
+
+  // Scenario: Overlapping batches race with each other and with single fetches of the same pages. Every page is read
+  // into one frame only, and comes back with its content.
+  std::atomic<int> num_failures{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < 4; ++tid) {
+    threads.emplace_back([&, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+      for (int i = 0; i < 500; ++i) {
+        std::vector<page_id_t> batch_page_ids{page_dist(rng), page_dist(rng)};
+        std::vector<Page *> batch_pages;
+        if (tid % 2 == 0) {
+          bpm->FetchPages(batch_page_ids, &batch_pages);
+        } else {
+          for (page_id_t page_id : batch_page_ids) {
+            batch_pages.push_back(bpm->FetchPage(page_id));
+          }
+        }
+        for (size_t j = 0; j < batch_page_ids.size(); ++j) {
+          if (batch_pages[j] == nullptr) {
+            continue;
+          }
+          if (std::string(batch_pages[j]->GetData()) != "Hello " + std::to_string(batch_page_ids[j])) {
+            num_failures++;
+          }
+          bpm->UnpinPage(batch_page_ids[j], false);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, num_failures.load());
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  // More than one flush batch, so that several I/O threads get some.
+  const size_t buffer_pool_size = 3 * FLUSH_BATCH_SIZE / PAGE_SIZE;
+  // Keep the background writer from writing pages back before the flush does.
+  ConfigGuard bg_flush_interval_guard(&bg_flush_interval, std::chrono::milliseconds(10000));
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  ConfigGuard flush_io_threads_guard(&flush_io_threads, 4);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+  ASSERT_NE(nullptr, bpm->FetchPage(7));
+
+  // Scenario: Every dirty page is written, a pinned one too, and it stays pinned.
+  int num_writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().dirty_write_backs_);
+  EXPECT_EQ(1, bpm->GetPages()[7].GetPinCount());
+  EXPECT_EQ(true, bpm->UnpinPage(7, false));
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(buffer_pool_size); ++page_id) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ("Hello " + std::to_string(page_id), std::string(data));
+  }
+
+  // Scenario: Clean pages are not written again, only the page dirtied since.
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + static_cast<int>(buffer_pool_size), disk_manager->GetNumWrites());
+  auto *page = bpm->FetchPage(5);
+  snprintf(page->GetData(), PAGE_SIZE, "Hello again");
+  EXPECT_EQ(true, bpm->UnpinPage(5, true));
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + static_cast<int>(buffer_pool_size) + 1, disk_manager->GetNumWrites());
+  disk_manager->ReadPage(5, data);
+  EXPECT_EQ("Hello again", std::string(data));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, DeletePageReuseTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const int num_pages = 16;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(i, page_id_temp);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Deleted pages, cached or not, are handed out again before the file grows.
+  EXPECT_TRUE(bpm->DeletePage(3));
+  EXPECT_TRUE(bpm->DeletePage(num_pages - 1));
+  EXPECT_TRUE(bpm->DeletePage(8));
+  EXPECT_EQ(static_cast<size_t>(num_pages - 3), disk_manager->GetNumAllocatedPages());
+  for (page_id_t expected : {3, 8, num_pages - 1, num_pages}) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(expected, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+
+  // Scenario: A reused page does not show what the deleted page held, even once it was evicted.
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  auto *page = bpm->FetchPage(8);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, page->GetData()[0]);
+  EXPECT_EQ(true, bpm->UnpinPage(8, false));
+  page = bpm->FetchPage(9);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("Hello 9", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(9, false));
+
+  // Scenario: A pinned page is not deleted.
+  ASSERT_NE(nullptr, bpm->FetchPage(9));
+  EXPECT_EQ(false, bpm->DeletePage(9));
+  EXPECT_TRUE(disk_manager->IsPageAllocated(9));
+
+  // Scenario: A full pool allocates no page, the next page is the one that would have been handed out.
+  for (page_id_t page_id = 10; page_id < 10 + static_cast<page_id_t>(buffer_pool_size) - 1; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+  }
+  size_t num_allocated_pages = disk_manager->GetNumAllocatedPages();
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(num_allocated_pages, disk_manager->GetNumAllocatedPages());
+  for (page_id_t page_id = 10; page_id < 10 + static_cast<page_id_t>(buffer_pool_size) - 1; ++page_id) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(static_cast<page_id_t>(num_allocated_pages), page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_EQ(true, bpm->UnpinPage(9, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, LargePageIdTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const page_id_t large_page_id = (page_id_t{1} << 31) + 5;
+  const lsn_t large_lsn = (lsn_t{1} << 40) + 1;
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  char data[PAGE_SIZE] = {0};
+  snprintf(data, sizeof(data), "Hello %" PRId64, large_page_id);
+  disk_manager->WritePage(large_page_id, data);
+
+  // Scenario: A page past the 8TiB a 32-bit page id could address is fetched from its own offset.
+  auto *page = bpm->FetchPage(large_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(large_page_id, page->GetPageId());
+  EXPECT_EQ(std::string(data), std::string(page->GetData()));
+
+  // Scenario: A 64-bit LSN survives the write back and the fetch after the eviction.
+  page->SetLSN(large_lsn);
+  EXPECT_EQ(true, bpm->UnpinPage(large_page_id, true));
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  page = bpm->FetchPage(large_page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(large_lsn, page->GetLSN());
+  EXPECT_EQ(true, bpm->UnpinPage(large_page_id, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, ConcurrentFetchTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const int num_pages = 32;
+  const int num_threads = 4;
+  const int num_iterations = 5000;
+
+  for (auto replacer_type : {ReplacerType::LRU, ReplacerType::CLOCK, ReplacerType::LRU_K, ReplacerType::ARC}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager, nullptr, replacer_type);
+    for (int i = 0; i < num_pages; ++i) {
+      page_id_t page_id_temp;
+      auto *page = bpm->NewPage(&page_id_temp);
+      ASSERT_NE(nullptr, page);
+      snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+
+    // Scenario: Threads hammer a few hot pages, which stay cached and take the lock-free path, while the cold ones
+    // keep evicting frames underneath them. Every fetch must return the page that was asked for.
+    std::atomic<int> num_failures{0};
+    std::vector<std::thread> threads;
+    for (int tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        std::default_random_engine rng(tid);
+        std::uniform_int_distribution<int> hot_dist(0, 3);
+        std::uniform_int_distribution<int> cold_dist(0, num_pages - 1);
+        for (int i = 0; i < num_iterations; ++i) {
+          page_id_t page_id = i % 4 == 0 ? cold_dist(rng) : hot_dist(rng);
+          auto *page = bpm->FetchPage(page_id);
+          if (page == nullptr || page->GetPageId() != page_id ||
+              std::string(page->GetData()) != "Hello " + std::to_string(page_id)) {
+            num_failures++;
+          }
+          if (page != nullptr) {
+            bpm->UnpinPage(page_id, i % 8 == 0);
+          }
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    EXPECT_EQ(0, num_failures.load());
+
+    // Scenario: No pin leaked, so the whole pool can be filled with new pages again. Give pending read-ahead, which
+    // holds a frame while it reads, time to finish first.
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    for (size_t i = 0; i < buffer_pool_size; ++i) {
+      page_id_t page_id_temp;
+      EXPECT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    }
+
+    delete bpm;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, ConcurrentMissTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const int num_threads = 8;
+  // Keep read-ahead from bringing the pages in first.
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ResidencyBufferPoolManager(buffer_pool_size, disk_manager);
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_threads; ++page_id) {
+    snprintf(data, sizeof(data), "Hello %" PRId64, page_id);
+    disk_manager->WritePage(page_id, data);
+  }
+
+  // Scenario: Threads miss on the same page at once, it is read once and they all get the same frame.
+  std::vector<Page *> pages(num_threads);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] { pages[tid] = bpm->FetchPage(0); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int tid = 0; tid < num_threads; ++tid) {
+    ASSERT_EQ(pages[0], pages[tid]);
+  }
+  EXPECT_EQ("Hello 0", std::string(pages[0]->GetData()));
+  EXPECT_EQ(num_threads, pages[0]->GetPinCount());
+  EXPECT_EQ(1U, bpm->GetStats().misses_);
+  for (int tid = 0; tid < num_threads; ++tid) {
+    EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  }
+
+  // Scenario: Threads miss on different pages at once, each gets its own.
+  threads.clear();
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] { pages[tid] = bpm->FetchPage(tid); });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int tid = 0; tid < num_threads; ++tid) {
+    ASSERT_NE(nullptr, pages[tid]);
+    EXPECT_EQ("Hello " + std::to_string(tid), std::string(pages[tid]->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(tid, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  const size_t max_pool_size = 8;
+  // Keep the background threads from evicting or retiring frames behind the test's back.
+  ConfigGuard bg_flush_interval_guard(&bg_flush_interval, std::chrono::milliseconds(10000));
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ResidencyBufferPoolManager(buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU,
+                                             max_pool_size);
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(max_pool_size, bpm->GetMaxPoolSize());
+  EXPECT_FALSE(bpm->Resize(0));
+  EXPECT_FALSE(bpm->Resize(max_pool_size + 1));
+  page_id_t page_id_temp;
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: Growing makes room for more pinned pages, up to the new size.
+  EXPECT_TRUE(bpm->Resize(max_pool_size));
+  EXPECT_EQ(max_pool_size, bpm->GetPoolSize());
+  for (size_t i = buffer_pool_size; i < max_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  }
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+    if (page_id != 6) {
+      EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+    }
+  }
+
+  // Scenario: Shrinking evicts the pages past the new size, except the pinned one, and writes them back.
+  EXPECT_FALSE(bpm->Resize(buffer_pool_size));
+  EXPECT_EQ(buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(0U, bpm->GetStats().free_frames_);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    EXPECT_EQ(page_id < static_cast<page_id_t>(buffer_pool_size) || page_id == 6, bpm->Exist(page_id)) << page_id;
+  }
+  auto *page = bpm->FetchPage(5);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("Hello 5", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(5, false));
+
+  // Scenario: Once unpinned, resizing to the same size retires the frame the shrink left behind.
+  EXPECT_EQ(true, bpm->UnpinPage(6, false));
+  EXPECT_TRUE(bpm->Resize(buffer_pool_size));
+  EXPECT_FALSE(bpm->Exist(6));
+  page = bpm->FetchPage(6);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ("Hello 6", std::string(page->GetData()));
+  EXPECT_EQ(true, bpm->UnpinPage(6, false));
+
+  // Scenario: After the shrink only the new size can be pinned at once, growing again brings back every frame.
+  std::vector<page_id_t> page_ids;
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    if (bpm->FetchPage(page_id) != nullptr) {
+      page_ids.push_back(page_id);
+    }
+  }
+  EXPECT_EQ(buffer_pool_size, page_ids.size());
+  EXPECT_TRUE(bpm->Resize(max_pool_size));
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    if (std::find(page_ids.begin(), page_ids.end(), page_id) == page_ids.end()) {
+      page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      EXPECT_EQ("Hello " + std::to_string(page_id), std::string(page->GetData()));
+    }
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, ConcurrentResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const size_t max_pool_size = 64;
+  const int num_pages = 128;
+  const int num_threads = 4;
+  const int num_iterations = 5000;
+
+  // Owned so that a failed assertion still stops the pool before its disk manager goes away.
+  auto disk_manager = std::make_unique<DiskManager>(db_name);
+  auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get(), nullptr, ReplacerType::LRU,
+                                                 max_pool_size);
+  for (int i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The pool keeps growing and shrinking while threads fetch and dirty pages. Every fetch returns the page
+  // that was asked for, with its content.
+  std::atomic<bool> done{false};
+  std::thread resizer([&] {
+    std::default_random_engine rng(15445);
+    std::uniform_int_distribution<size_t> size_dist(2 * num_threads, max_pool_size);
+    while (!done) {
+      bpm->Resize(size_dist(rng));
+      std::this_thread::yield();
+    }
+  });
+  std::atomic<int> num_failures{0};
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      std::default_random_engine rng(tid);
+      std::uniform_int_distribution<int> page_dist(0, num_pages - 1);
+      for (int i = 0; i < num_iterations; ++i) {
+        page_id_t page_id = page_dist(rng);
+        auto *page = bpm->FetchPage(page_id);
+        if (page == nullptr) {
+          // The pool never shrinks below two frames per thread, enough for every pin and the background writer's.
+          num_failures++;
+          continue;
+        }
+        if (page->GetPageId() != page_id || std::string(page->GetData()) != "Hello " + std::to_string(page_id)) {
+          num_failures++;
+        }
+        bpm->UnpinPage(page_id, i % 4 == 0);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  resizer.join();
+  EXPECT_EQ(0, num_failures.load());
+
+  // Scenario: Back at the largest size, no frame was lost and every one of them can be pinned. The background
+  // writer and the read-ahead thread may hold a frame for a moment, a fetch that finds none is retried until they
+  // let go of it.
+  EXPECT_TRUE(bpm->Resize(max_pool_size));
+  auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(max_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    while (page == nullptr && std::chrono::steady_clock::now() < deadline) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      page = bpm->FetchPage(page_id);
+    }
+    ASSERT_NE(nullptr, page) << page_id;
+    EXPECT_EQ("Hello " + std::to_string(page_id), std::string(page->GetData()));
+  }
+
+  bpm.reset();
+  disk_manager->ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, BufferRingTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 16;
+  const page_id_t num_hot_pages = 8;
+  const page_id_t num_pages = 64;
+  // Keep the background writer from pinning ring frames while it writes them back, the ring then falls back to a
+  // regular victim.
+  ConfigGuard bg_flush_interval_guard(&bg_flush_interval, std::chrono::milliseconds(10000));
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ResidencyBufferPoolManager(buffer_pool_size, disk_manager);
+  BufferAccessStrategy load_strategy(4 * PAGE_SIZE);
+  EXPECT_EQ(4U, load_strategy.GetNumFrames());
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id_temp;
+    auto *page = i < num_hot_pages ? bpm->NewPage(&page_id_temp) : bpm->NewPage(&page_id_temp, load_strategy);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: A bulk load recycles its own ring, the pages created before it stay cached.
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    EXPECT_TRUE(bpm->Exist(page_id)) << page_id;
+  }
+
+  // Scenario: So does a scan, and it sees what the bulk load wrote back when recycling its frames.
+  BufferAccessStrategy scan_strategy(4 * PAGE_SIZE);
+  for (page_id_t page_id = num_hot_pages; page_id < num_pages; ++page_id) {
+    auto *page = bpm->FetchPage(page_id, scan_strategy);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Hello " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+    EXPECT_TRUE(bpm->Exist(page_id)) << page_id;
+  }
+
+  // Scenario: A ring frame that is still pinned is not recycled, the scan takes a regular victim instead.
+  BufferAccessStrategy pinned_strategy(PAGE_SIZE);
+  ASSERT_NE(nullptr, bpm->FetchPage(num_hot_pages, pinned_strategy));
+  ASSERT_NE(nullptr, bpm->FetchPage(num_hot_pages + 1, pinned_strategy));
+  EXPECT_TRUE(bpm->Exist(num_hot_pages));
+  EXPECT_EQ(true, bpm->UnpinPage(num_hot_pages, false));
+  EXPECT_EQ(true, bpm->UnpinPage(num_hot_pages + 1, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// Measures the hit ratio of point lookups on a hot set that fits in the pool, while another thread scans a table
+// much larger than the pool. The lookups are paced to one per scanned page. Read-ahead and the free frame reserve of
+// the background writer are off: they take frames for the scan outside the ring at a rate that depends on the load of
+// the machine, which would make the comparison depend on it, too.
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, BufferRingHitRatioBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 256;
+  const page_id_t num_hot_pages = 160;
+  const page_id_t num_cold_pages = 2048;
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  auto run = [&](bool use_ring) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new ResidencyBufferPoolManager(buffer_pool_size, disk_manager);
+    for (page_id_t i = 0; i < num_hot_pages + num_cold_pages; ++i) {
+      page_id_t page_id_temp;
+      auto *page = bpm->NewPage(&page_id_temp);
+      EXPECT_NE(nullptr, page);
+      EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+    }
+    for (page_id_t page_id = 0; page_id < num_hot_pages; ++page_id) {
+      bpm->FetchPage(page_id);
+      bpm->UnpinPage(page_id, false);
+    }
+
+    std::atomic<page_id_t> num_scanned{0};
+    std::thread scan([&] {
+      BufferAccessStrategy strategy;
+      for (page_id_t page_id = num_hot_pages; page_id < num_hot_pages + num_cold_pages; ++page_id) {
+        auto *page = use_ring ? bpm->FetchPage(page_id, strategy) : bpm->FetchPage(page_id);
+        EXPECT_NE(nullptr, page);
+        bpm->UnpinPage(page_id, false);
+        num_scanned++;
+      }
+    });
+    size_t num_hits = 0;
+    std::default_random_engine rng(15445);
+    std::uniform_int_distribution<page_id_t> hot_dist(0, num_hot_pages - 1);
+    for (page_id_t i = 0; i < num_cold_pages; ++i) {
+      while (num_scanned.load() <= i) {
+        std::this_thread::yield();
+      }
+      page_id_t page_id = hot_dist(rng);
+      num_hits += bpm->Exist(page_id) ? 1 : 0;
+      EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    scan.join();
+
+    delete bpm;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    return static_cast<double>(num_hits) / num_cold_pages;
+  };
+
+  double plain = run(false);
+  double ring = run(true);
+  std::cout << "scan          lookup hit ratio" << std::endl;
+  printf("%-12s  %16.4f\n", "replacer", plain);
+  printf("%-12s  %16.4f\n", "buffer ring", ring);
+  EXPECT_GT(ring, plain);
+}
+
+// Compares random fetches over a dataset larger than the pool with buffered and with direct I/O. With direct I/O
+// every miss goes to the device instead of the OS page cache, which no longer holds a second copy of the data.
+// NOLINTNEXTLINE
+TEST_F(BufferPoolManagerTest, DirectIOBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 64;
+  const page_id_t num_pages = 2048;
+  const int num_fetches = 10000;
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  // The dataset is written once, the pages hold their own id.
+  {
+    DiskManager disk_manager(db_name);
+    char data[PAGE_SIZE] = {0};
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      snprintf(data, sizeof(data), "Hello %" PRId64, page_id);
+      disk_manager.WritePage(page_id, data);
+    }
+    disk_manager.ShutDown();
+  }
+
+  auto run = [&](bool direct_io, const char *name) {
+    DiskManager disk_manager(db_name, direct_io);
+    if (disk_manager.IsDirectIO() != direct_io) {
+      std::cout << name << ": not supported here, skipping" << std::endl;
+      disk_manager.ShutDown();
+      return;
+    }
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, &disk_manager);
+    std::default_random_engine rng(15445);
+    std::uniform_int_distribution<page_id_t> page_dist(0, num_pages - 1);
+    int num_failures = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_fetches; ++i) {
+      page_id_t page_id = page_dist(rng);
+      auto *page = bpm->FetchPage(page_id);
+      if (page == nullptr || std::string(page->GetData()) != "Hello " + std::to_string(page_id)) {
+        num_failures++;
+      }
+      if (page != nullptr) {
+        bpm->UnpinPage(page_id, false);
+      }
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    EXPECT_EQ(0, num_failures);
+    auto stats = bpm->GetStats();
+    printf("%-10s  %12.0f  %10.4f  %12" PRIu64 "  %12" PRIu64 "\n", name, num_fetches / elapsed.count(),
+           stats.HitRatio(), stats.miss_latency_.GetPercentile(50), stats.miss_latency_.GetPercentile(99));
+    bpm.reset();
+    disk_manager.ShutDown();
+  };
+
+  std::cout << "mode        fetches/s     hit ratio   p50 miss ns   p99 miss ns" << std::endl;
+  run(false, "buffered");
+  run(true, "direct");
+  remove("test.db");
+}
+
 }  // namespace bustub
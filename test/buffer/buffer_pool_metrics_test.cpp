@@ -0,0 +1,272 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// buffer_pool_metrics_test.cpp
+//
+// Identification: test/buffer/buffer_pool_metrics_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/buffer_pool_metrics.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/config_guard.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(BufferPoolMetricsTest, HistogramTest) {
+  // Scenario: Buckets cover the whole range without gaps, small values are exact and every value falls within the
+  // precision of its bucket.
+  EXPECT_EQ(0U, LatencyHistogram::BucketLowerBound(0));
+  for (size_t bucket = 1; bucket < LatencyHistogram::NUM_BUCKETS; ++bucket) {
+    EXPECT_EQ(LatencyHistogram::BucketUpperBound(bucket - 1) + 1, LatencyHistogram::BucketLowerBound(bucket));
+  }
+  EXPECT_EQ(UINT64_MAX, LatencyHistogram::BucketUpperBound(LatencyHistogram::NUM_BUCKETS - 1));
+  for (uint64_t value = 0; value < 2 * LatencyHistogram::SUB_BUCKETS; ++value) {
+    EXPECT_EQ(value, LatencyHistogram::BucketOf(value));
+  }
+  std::default_random_engine rng(15445);
+  for (int i = 0; i < 10000; ++i) {
+    uint64_t value = rng() >> (rng() % 32);
+    size_t bucket = LatencyHistogram::BucketOf(value);
+    EXPECT_LE(LatencyHistogram::BucketLowerBound(bucket), value);
+    EXPECT_GE(LatencyHistogram::BucketUpperBound(bucket), value);
+    uint64_t width = LatencyHistogram::BucketUpperBound(bucket) - LatencyHistogram::BucketLowerBound(bucket);
+    EXPECT_LE(width, LatencyHistogram::BucketLowerBound(bucket) / LatencyHistogram::SUB_BUCKETS);
+  }
+
+  // Scenario: Percentiles of 1..1000 are within the bucket precision, merging adds up the counts.
+  LatencyHistogram histogram;
+  EXPECT_EQ(0U, histogram.GetPercentile(50));
+  for (uint64_t value = 1; value <= 1000; ++value) {
+    histogram.Record(value);
+  }
+  EXPECT_EQ(1000U, histogram.GetCount());
+  EXPECT_EQ(1000U, histogram.GetMax());
+  EXPECT_DOUBLE_EQ(500.5, histogram.GetMean());
+  EXPECT_EQ(1U, histogram.GetPercentile(0));
+  EXPECT_EQ(1000U, histogram.GetPercentile(100));
+  for (double percentile : {50.0, 90.0, 99.0}) {
+    auto exact = static_cast<uint64_t>(percentile * 10);
+    EXPECT_GE(histogram.GetPercentile(percentile), exact);
+    EXPECT_LE(histogram.GetPercentile(percentile), exact + exact / LatencyHistogram::SUB_BUCKETS);
+  }
+  LatencyHistogram other;
+  other.Record(5000);
+  histogram.Merge(other);
+  EXPECT_EQ(1001U, histogram.GetCount());
+  EXPECT_EQ(5000U, histogram.GetMax());
+  EXPECT_EQ(5000U, histogram.GetPercentile(100));
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolMetricsTest, ShardedCounterTest) {
+  const int num_threads = 8;
+  const int num_iterations = 10000;
+  BufferPoolMetrics metrics;
+
+  // Scenario: More threads than shards count concurrently while another thread scrapes, nothing is lost.
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&] {
+      for (int i = 0; i < num_iterations; ++i) {
+        metrics.Add(BufferPoolMetrics::Counter::HIT);
+        if (i % 10 == 0) {
+          metrics.Add(BufferPoolMetrics::Counter::MISS);
+          metrics.RecordMissLatency(static_cast<uint64_t>(i));
+        }
+      }
+    });
+  }
+  BufferPoolStats stats;
+  for (int i = 0; i < 100; ++i) {
+    metrics.GetStats(&stats);
+    EXPECT_GE(stats.hits_, stats.misses_);
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  metrics.GetStats(&stats);
+  EXPECT_EQ(static_cast<uint64_t>(num_threads * num_iterations), stats.hits_);
+  EXPECT_EQ(static_cast<uint64_t>(num_threads * num_iterations / 10), stats.misses_);
+  EXPECT_EQ(stats.misses_, stats.miss_latency_.GetCount());
+  EXPECT_EQ(static_cast<uint64_t>(num_iterations - 10), stats.miss_latency_.GetMax());
+  EXPECT_DOUBLE_EQ(10.0 / 11, stats.HitRatio());
+
+  // Scenario: A reset takes everything out.
+  metrics.Reset();
+  metrics.GetStats(&stats);
+  EXPECT_EQ(0U, stats.hits_);
+  EXPECT_EQ(0U, stats.misses_);
+  EXPECT_EQ(0U, stats.miss_latency_.GetCount());
+  EXPECT_EQ(0U, stats.miss_latency_.GetMax());
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolMetricsTest, BufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 4;
+  // Keep the background threads out of the counts.
+  ConfigGuard bg_flush_interval_guard(&bg_flush_interval, std::chrono::milliseconds(10000));
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  EXPECT_EQ(buffer_pool_size, bpm->GetStats().free_frames_);
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: A cached page is a hit.
+  ASSERT_NE(nullptr, bpm->FetchPage(0));
+  EXPECT_EQ(true, bpm->UnpinPage(0, false));
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(1U, stats.hits_);
+  EXPECT_EQ(0U, stats.misses_);
+  EXPECT_EQ(0U, stats.evictions_);
+  EXPECT_EQ(0U, stats.free_frames_);
+
+  // Scenario: A new page evicts the least recently used one, page 1, which is written back.
+  page_id_t page_id_temp;
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1U, stats.evictions_);
+  EXPECT_EQ(1U, stats.dirty_write_backs_);
+
+  // Scenario: Fetching page 1 again is a miss with a recorded service time, and evicts page 2.
+  ASSERT_NE(nullptr, bpm->FetchPage(1));
+  EXPECT_EQ(true, bpm->UnpinPage(1, false));
+  stats = bpm->GetStats();
+  EXPECT_EQ(1U, stats.hits_);
+  EXPECT_EQ(1U, stats.misses_);
+  EXPECT_EQ(2U, stats.evictions_);
+  EXPECT_EQ(2U, stats.dirty_write_backs_);
+  EXPECT_EQ(1U, stats.miss_latency_.GetCount());
+  EXPECT_GT(stats.miss_latency_.GetMax(), 0U);
+  EXPECT_DOUBLE_EQ(0.5, stats.HitRatio());
+
+  // Scenario: Flushing a clean page writes it, but it is not a dirty write-back.
+  EXPECT_EQ(true, bpm->FlushPage(1));
+  EXPECT_EQ(2U, bpm->GetStats().dirty_write_backs_);
+
+  // Scenario: Reset.
+  bpm->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0U, stats.hits_);
+  EXPECT_EQ(0U, stats.misses_);
+  EXPECT_EQ(0U, stats.evictions_);
+  EXPECT_EQ(0U, stats.dirty_write_backs_);
+  EXPECT_EQ(0U, stats.miss_latency_.GetCount());
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolMetricsTest, ParallelBufferPoolTest) {
+  const std::string db_name = "test.db";
+  // Keep the background writer from evicting pages to refill the free frames.
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, 4, disk_manager);
+
+  // Scenario: The metrics of all instances are summed up, and reset together.
+  for (int i = 0; i < 4; ++i) {
+    page_id_t page_id_temp;
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  for (page_id_t page_id = 0; page_id < 4; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  EXPECT_EQ(4U, bpm->GetStats().hits_);
+  EXPECT_EQ(4U, bpm->GetStats().free_frames_);
+  bpm->ResetStats();
+  EXPECT_EQ(0U, bpm->GetStats().hits_);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolMetricsTest, ARCStatsTest) {
+  const std::string db_name = "test.db";
+  // Keep the background threads from evicting pages, the victims are the ones ARC picks for the foreground.
+  ConfigGuard bg_flush_interval_guard(&bg_flush_interval, std::chrono::milliseconds(10000));
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(2, 4, disk_manager, nullptr, ReplacerType::ARC);
+
+  // New pages go to the instances in turn, instance 0 holds the even pages, instance 1 the odd ones. Pages 0 to 3
+  // are fetched again and become frequent, so that the next new pages evict pages 4 and 5 from T1 into B1.
+  page_id_t page_id_temp;
+  for (page_id_t page_id = 0; page_id < 10; ++page_id) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(page_id, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+    if (page_id == 7) {
+      for (page_id_t frequent = 0; frequent < 4; ++frequent) {
+        ASSERT_NE(nullptr, bpm->FetchPage(frequent));
+        EXPECT_EQ(true, bpm->UnpinPage(frequent, false));
+      }
+    }
+  }
+  auto stats = bpm->GetStats();
+  EXPECT_EQ(0U, stats.arc_b1_hits_);
+  EXPECT_EQ(0U, stats.arc_target_);
+
+  // Scenario: Fetching pages 4 and 5 again hits B1 in both instances, the ghost hits and targets are summed up.
+  for (page_id_t page_id = 4; page_id < 6; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+  stats = bpm->GetStats();
+  EXPECT_EQ(2U, stats.arc_b1_hits_);
+  EXPECT_EQ(0U, stats.arc_b2_hits_);
+  EXPECT_EQ(2U, stats.arc_target_);
+
+  // Scenario: Page 6, evicted into B1 by the fetch of page 4, is deleted. Its id is handed out again, and the new
+  // page is no ghost hit.
+  EXPECT_EQ(true, bpm->DeletePage(6));
+  ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+  EXPECT_EQ(6, page_id_temp);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  EXPECT_EQ(2U, bpm->GetStats().arc_b1_hits_);
+
+  // Scenario: Reset sets the ghost hits back to zero, the target stays.
+  bpm->ResetStats();
+  stats = bpm->GetStats();
+  EXPECT_EQ(0U, stats.arc_b1_hits_);
+  EXPECT_EQ(2U, stats.arc_target_);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -10,6 +10,8 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
 #include <cstdio>
 #include <thread>  // NOLINT
 #include <vector>
@@ -19,7 +21,7 @@
 
 namespace bustub {
 
-TEST(ClockReplacerTest, DISABLED_SampleTest) {
+TEST(ClockReplacerTest, SampleTest) {
   ClockReplacer clock_replacer(7);
 
   // Scenario: unpin six elements, i.e. add them to the replacer.
@@ -60,4 +62,92 @@ TEST(ClockReplacerTest, DISABLED_SampleTest) {
   EXPECT_EQ(4, value);
 }
 
+TEST(ClockReplacerTest, ConcurrentTest) {
+  const size_t num_threads = 4;
+  const size_t frames_per_thread = 64;
+  ClockReplacer clock_replacer(num_threads * frames_per_thread);
+
+  // Scenario: every thread pins and unpins its own frames, leaving every odd frame unpinned.
+  std::vector<std::thread> threads;
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&clock_replacer, tid, frames_per_thread] {
+      for (int round = 0; round < 100; ++round) {
+        for (size_t i = 0; i < frames_per_thread; ++i) {
+          auto frame_id = static_cast<frame_id_t>(tid * frames_per_thread + i);
+          clock_replacer.Unpin(frame_id);
+          if (i % 2 == 0) {
+            clock_replacer.Pin(frame_id);
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(num_threads * frames_per_thread / 2, clock_replacer.Size());
+
+  // Scenario: concurrent victims hand out every unpinned frame exactly once.
+  std::vector<std::vector<frame_id_t>> victims(num_threads);
+  threads.clear();
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&clock_replacer, &victims, tid] {
+      frame_id_t frame_id;
+      while (clock_replacer.Victim(&frame_id)) {
+        victims[tid].push_back(frame_id);
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  std::vector<bool> seen(num_threads * frames_per_thread, false);
+  size_t num_victims = 0;
+  for (auto &list : victims) {
+    for (auto frame_id : list) {
+      EXPECT_EQ(1, frame_id % 2);
+      EXPECT_FALSE(seen[frame_id]);
+      seen[frame_id] = true;
+      num_victims++;
+    }
+  }
+  EXPECT_EQ(num_threads * frames_per_thread / 2, num_victims);
+  EXPECT_EQ(0, clock_replacer.Size());
+
+  // Scenario: pins racing with unpins of the same few frames never make the replacer look larger than it can be.
+  const size_t num_contended_frames = 2;
+  std::atomic<bool> done{false};
+  size_t max_size = 0;
+  std::thread reader([&] {
+    while (!done) {
+      max_size = std::max(max_size, clock_replacer.Size());
+    }
+  });
+  threads.clear();
+  for (size_t tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&clock_replacer, tid, num_contended_frames] {
+      for (int i = 0; i < 200000; ++i) {
+        auto frame_id = static_cast<frame_id_t>(i % num_contended_frames);
+        if (tid % 2 == 0) {
+          clock_replacer.Unpin(frame_id);
+        } else {
+          clock_replacer.Pin(frame_id);
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  reader.join();
+  EXPECT_LE(max_size, num_contended_frames);
+  for (size_t i = 0; i < num_contended_frames; ++i) {
+    clock_replacer.Pin(static_cast<frame_id_t>(i));
+  }
+  EXPECT_EQ(0, clock_replacer.Size());
+  frame_id_t frame_id;
+  EXPECT_FALSE(clock_replacer.Victim(&frame_id));
+}
+
 }  // namespace bustub
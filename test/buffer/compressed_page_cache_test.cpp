@@ -0,0 +1,319 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_cache_test.cpp
+//
+// Identification: test/buffer/compressed_page_cache_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/compressed_page_cache.h"
+#include <chrono>  // NOLINT
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <random>
+#include <string>
+#include <thread>  // NOLINT
+#include <tuple>
+#include <vector>
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/parallel_buffer_pool_manager.h"
+#include "common/config_guard.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// Fills a page with rows of text, about as compressible as a table page.
+static void FillPage(page_id_t page_id, char *data) {
+  std::string rows;
+  for (int row = 0; rows.size() < PAGE_SIZE; ++row) {
+    rows += "page " + std::to_string(page_id) + " row " + std::to_string(row) + " value " +
+            std::to_string((page_id * 7919 + row * 104729) % 100000) + ";";
+  }
+  memcpy(data, rows.data(), PAGE_SIZE);
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, SampleTest) {
+  CompressedPageCache cache(16 * PAGE_SIZE);
+  EXPECT_TRUE(cache.IsEnabled());
+  char page[PAGE_SIZE];
+  char out[PAGE_SIZE];
+  FillPage(1, page);
+
+  // Scenario: a page put into the cache comes back as it was, and leaves the cache on the way.
+  EXPECT_TRUE(cache.Insert(1, page));
+  auto stats = cache.GetStats();
+  EXPECT_EQ(1, stats.pages_);
+  EXPECT_LT(stats.memory_used_, static_cast<uint64_t>(PAGE_SIZE / 2));
+  EXPECT_TRUE(cache.Lookup(1, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  EXPECT_FALSE(cache.Lookup(1, out));
+  stats = cache.GetStats();
+  EXPECT_EQ(1, stats.hits_);
+  EXPECT_EQ(1, stats.misses_);
+  EXPECT_EQ(0, stats.pages_);
+  EXPECT_EQ(0, stats.memory_used_);
+
+  // Scenario: inserting a page again replaces its copy, and an erased page is gone.
+  EXPECT_TRUE(cache.Insert(2, page));
+  FillPage(2, page);
+  EXPECT_TRUE(cache.Insert(2, page));
+  EXPECT_EQ(1, cache.GetStats().pages_);
+  EXPECT_TRUE(cache.Lookup(2, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  EXPECT_TRUE(cache.Insert(3, page));
+  cache.Erase(3);
+  EXPECT_FALSE(cache.Lookup(3, out));
+
+  // Scenario: a staged page is found before it is compressed, and kept compressed after.
+  EXPECT_TRUE(cache.Stage(5, page));
+  EXPECT_EQ(1, cache.GetStats().staged_);
+  EXPECT_TRUE(cache.Lookup(5, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  EXPECT_EQ(0, cache.GetStats().staged_);
+  EXPECT_TRUE(cache.Stage(5, page));
+  EXPECT_TRUE(cache.Stage(6, page));
+  cache.Erase(6);
+  cache.Compress();
+  stats = cache.GetStats();
+  EXPECT_EQ(0, stats.staged_);
+  EXPECT_EQ(1, stats.pages_);
+  EXPECT_TRUE(cache.Lookup(5, out));
+  EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  EXPECT_FALSE(cache.Lookup(6, out));
+
+  // Scenario: a page that does not compress is not kept.
+  std::default_random_engine rng(15445);
+  for (auto &c : page) {
+    c = static_cast<char>(rng());
+  }
+  EXPECT_FALSE(cache.Insert(4, page));
+  EXPECT_FALSE(cache.Lookup(4, out));
+  EXPECT_EQ(1, cache.GetStats().rejects_);
+
+  cache.ResetStats();
+  stats = cache.GetStats();
+  EXPECT_EQ(0, stats.hits_ + stats.misses_ + stats.inserts_ + stats.rejects_);
+
+  // Scenario: a cache without budget keeps nothing and counts nothing.
+  CompressedPageCache disabled(0);
+  EXPECT_FALSE(disabled.IsEnabled());
+  FillPage(1, page);
+  EXPECT_FALSE(disabled.Insert(1, page));
+  EXPECT_FALSE(disabled.Stage(1, page));
+  EXPECT_FALSE(disabled.Lookup(1, out));
+  EXPECT_EQ(0, disabled.GetStats().misses_);
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, EvictionTest) {
+  const size_t capacity = 8 * PAGE_SIZE;
+  CompressedPageCache cache(capacity);
+  char page[PAGE_SIZE];
+  char out[PAGE_SIZE];
+  const page_id_t num_pages = 100;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    FillPage(page_id, page);
+    EXPECT_TRUE(cache.Insert(page_id, page));
+    EXPECT_LE(cache.GetStats().memory_used_, capacity);
+  }
+
+  // Scenario: the budget holds more pages than it has room for uncompressed, and the oldest ones were dropped.
+  auto stats = cache.GetStats();
+  EXPECT_GT(stats.pages_, capacity / PAGE_SIZE * 2);
+  EXPECT_GT(stats.CompressionRatio(), 2.0);
+  EXPECT_EQ(num_pages, stats.pages_ + stats.evictions_);
+  auto first_kept = static_cast<page_id_t>(num_pages - stats.pages_);
+  EXPECT_FALSE(cache.Lookup(first_kept - 1, out));
+  for (page_id_t page_id = first_kept; page_id < num_pages; ++page_id) {
+    EXPECT_TRUE(cache.Lookup(page_id, out));
+    FillPage(page_id, page);
+    EXPECT_EQ(0, memcmp(page, out, PAGE_SIZE));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, BufferPoolTest) {
+  const std::string db_name = "test.db";
+  const size_t buffer_pool_size = 8;
+  const page_id_t num_pages = 32;
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+  ConfigGuard compressed_cache_size_guard(&compressed_cache_size, 64 * PAGE_SIZE);
+  // Keep the background writer from writing resident pages back, a write in flight holds its page in the pool. It
+  // still compresses the staged pages when woken up.
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+  char expected[PAGE_SIZE];
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *page = bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, page);
+    FillPage(page_id, page->GetData());
+    EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  }
+
+  // Scenario: the pages evicted from the pool are fetched back from the compressed cache, not from disk.
+  bpm->ResetStats();
+  for (int round = 0; round < 3; ++round) {
+    for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+      auto *page = bpm->FetchPage(page_id);
+      ASSERT_NE(nullptr, page);
+      FillPage(page_id, expected);
+      EXPECT_EQ(0, memcmp(expected, page->GetData(), PAGE_SIZE));
+      EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+    }
+  }
+  auto stats = bpm->GetStats();
+  auto cache_stats = bpm->GetCompressedCacheStats();
+  EXPECT_GT(stats.misses_, 0);
+  EXPECT_GT(cache_stats.hits_, 0);
+  EXPECT_LE(cache_stats.hits_, stats.misses_);
+  // Every page fits into the pool and the cache together, only the first fetch of some of them goes to disk.
+  EXPECT_LE(stats.misses_ - cache_stats.hits_, static_cast<uint64_t>(num_pages));
+
+  // Scenario: a page updated in the pool is written back before it is kept, the cache never hands out old data.
+  auto *page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  snprintf(page->GetData(), PAGE_SIZE, "updated");
+  EXPECT_TRUE(bpm->UnpinPage(0, true));
+  for (page_id_t page_id = 1; page_id < num_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  page = bpm->FetchPage(0);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0, strcmp(page->GetData(), "updated"));
+  EXPECT_TRUE(bpm->UnpinPage(0, false));
+
+  // Scenario: a deleted page is dropped from the cache along with the pool. All other pages are fetched, so page 0
+  // is surely evicted, then the background writer compresses what it staged.
+  for (page_id_t page_id = 1; page_id < num_pages; ++page_id) {
+    ASSERT_NE(nullptr, bpm->FetchPage(page_id));
+    EXPECT_TRUE(bpm->UnpinPage(page_id, false));
+  }
+  while (bpm->GetCompressedCacheStats().staged_ > 0) {
+    std::this_thread::yield();
+  }
+  // The background writer may keep more pages meanwhile, the pages that left the cache other than by a hit are
+  // counted as inserted but no longer held.
+  auto before = bpm->GetCompressedCacheStats();
+  EXPECT_TRUE(bpm->DeletePage(0));
+  auto after = bpm->GetCompressedCacheStats();
+  EXPECT_EQ(before.hits_, after.hits_);
+  EXPECT_EQ(before.inserts_ - before.pages_ + 1, after.inserts_ - after.pages_);
+
+  bpm->ResetStats();
+  EXPECT_EQ(0, bpm->GetCompressedCacheStats().hits_);
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+
+  // Scenario: the instances of a parallel pool share the budget, and their counters are summed up.
+  disk_manager = new DiskManager(db_name);
+  auto *parallel_bpm = new ParallelBufferPoolManager(4, 2, disk_manager);
+  for (page_id_t i = 0; i < num_pages; ++i) {
+    page_id_t page_id;
+    auto *new_page = parallel_bpm->NewPage(&page_id);
+    ASSERT_NE(nullptr, new_page);
+    FillPage(page_id, new_page->GetData());
+    EXPECT_TRUE(parallel_bpm->UnpinPage(page_id, true));
+  }
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    auto *fetched = parallel_bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, fetched);
+    FillPage(page_id, expected);
+    EXPECT_EQ(0, memcmp(expected, fetched->GetData(), PAGE_SIZE));
+    EXPECT_TRUE(parallel_bpm->UnpinPage(page_id, false));
+  }
+  cache_stats = parallel_bpm->GetCompressedCacheStats();
+  EXPECT_EQ(compressed_cache_size.load() / 4 * 4, cache_stats.capacity_);
+  EXPECT_GT(cache_stats.hits_, 0);
+
+  delete parallel_bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// Compares random fetches over a dataset a few times larger than the pool, for the same memory spent either all on
+// frames or mostly on the compressed cache. The cache holds a multiple of the pages the frames it replaces would, so
+// fewer fetches go to disk, at the price of compressing and decompressing the pages that move between the tiers.
+// NOLINTNEXTLINE
+TEST(CompressedPageCacheTest, EffectiveCapacityBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t memory_pages = 64;
+  const page_id_t num_pages = 192;
+  const int num_fetches = 20000;
+  ConfigGuard read_ahead_depth_guard(&read_ahead_depth, 0);
+
+  struct Result {
+    double pool_hit_ratio_;
+    uint64_t disk_reads_;
+    uint64_t cached_pages_;
+    double cache_ratio_;
+    double fetch_us_;
+  };
+  auto run = [&](size_t pool_size, size_t cache_size) {
+    ConfigGuard compressed_cache_size_guard(&compressed_cache_size, cache_size);
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new BufferPoolManager(pool_size, disk_manager);
+    for (page_id_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      auto *page = bpm->NewPage(&page_id);
+      EXPECT_NE(nullptr, page);
+      FillPage(page_id, page->GetData());
+      EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+    }
+    std::default_random_engine rng(15445);
+    std::uniform_int_distribution<page_id_t> dist(0, num_pages - 1);
+    // Warm up the pool and the cache, then measure.
+    for (int i = 0; i < num_fetches / 4; ++i) {
+      page_id_t page_id = dist(rng);
+      bpm->FetchPage(page_id);
+      bpm->UnpinPage(page_id, false);
+    }
+    bpm->ResetStats();
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_fetches; ++i) {
+      page_id_t page_id = dist(rng);
+      EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+      bpm->UnpinPage(page_id, false);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    auto stats = bpm->GetStats();
+    auto cache_stats = bpm->GetCompressedCacheStats();
+    Result result{stats.HitRatio(), stats.misses_ - cache_stats.hits_, pool_size + cache_stats.pages_,
+                  cache_stats.CompressionRatio(), elapsed.count() / num_fetches};
+
+    delete bpm;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+    return result;
+  };
+
+  auto frames_only = run(memory_pages, 0);
+  auto tiered = run(memory_pages / 4, memory_pages * 3 / 4 * PAGE_SIZE);
+  std::cout << "memory          frames  cached pages  cache ratio  pool hit ratio  disk reads  fetch us" << std::endl;
+  for (auto &[name, result, frames] : {std::make_tuple("frames", frames_only, memory_pages),
+                                       std::make_tuple("frames + cache", tiered, memory_pages / 4)}) {
+    printf("%-14s  %6zu  %12" PRIu64 "  %11.2f  %14.4f  %10" PRIu64 "  %8.2f\n", name, frames, result.cached_pages_,
+           result.cache_ratio_, result.pool_hit_ratio_, result.disk_reads_, result.fetch_us_);
+  }
+  EXPECT_GT(tiered.cache_ratio_, 2.0);
+  EXPECT_GT(tiered.cached_pages_, frames_only.cached_pages_ * 3 / 2);
+  EXPECT_LT(tiered.disk_reads_, frames_only.disk_reads_);
+}
+
+}  // namespace bustub
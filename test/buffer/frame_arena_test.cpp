@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// frame_arena_test.cpp
+//
+// Identification: test/buffer/frame_arena_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdint>
+#include <cstring>
+
+#include "buffer/buffer_pool_manager.h"
+#include "buffer/frame_arena.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, SampleTest) {
+  // Scenario: Small and huge-page sized arenas hand out zeroed, writable, page aligned frames.
+  for (size_t num_frames : {1, 10, 1024}) {
+    FrameArena arena(num_frames);
+    for (size_t i = 0; i < num_frames; ++i) {
+      char *frame = arena.GetFrame(static_cast<frame_id_t>(i));
+      EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(frame) % 4096);
+      EXPECT_EQ(0, frame[0]);
+      EXPECT_EQ(0, frame[PAGE_SIZE - 1]);
+      memset(frame, static_cast<int>(i % 128), PAGE_SIZE);
+    }
+    // Frames do not overlap.
+    for (size_t i = 0; i < num_frames; ++i) {
+      char *frame = arena.GetFrame(static_cast<frame_id_t>(i));
+      EXPECT_EQ(static_cast<char>(i % 128), frame[0]);
+      EXPECT_EQ(static_cast<char>(i % 128), frame[PAGE_SIZE - 1]);
+    }
+  }
+
+  // Scenario: An empty arena maps nothing.
+  FrameArena empty(0);
+  EXPECT_FALSE(empty.IsHugeTlb());
+}
+
+// NOLINTNEXTLINE
+TEST(FrameArenaTest, BufferPoolTest) {
+  const size_t buffer_pool_size = 10;
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(buffer_pool_size, disk_manager);
+
+  // Scenario: The pool's frames are consecutive and page aligned, and pages point into them.
+  Page *pages = bpm->GetPages();
+  for (size_t i = 0; i < buffer_pool_size; ++i) {
+    EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(pages[i].GetData()) % 4096);
+    EXPECT_EQ(pages[0].GetData() + i * PAGE_SIZE, pages[i].GetData());
+  }
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  EXPECT_EQ(0U, reinterpret_cast<uintptr_t>(page->GetData()) % 4096);
+  EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+}  // namespace bustub
@@ -0,0 +1,112 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lru_k_replacer_test.cpp
+//
+// Identification: test/buffer/lru_k_replacer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <iostream>
+#include <vector>
+
+#include "../test/buffer/replacer_trace.h"
+#include "buffer/clock_replacer.h"
+#include "buffer/lru_k_replacer.h"
+#include "buffer/lru_replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+TEST(LRUKReplacerTest, SampleTest) {
+  LRUKReplacer lru_k_replacer(7, 2);
+
+  // Scenario: access and unpin six frames, then access frame 1 a second time.
+  for (frame_id_t frame_id = 1; frame_id <= 6; ++frame_id) {
+    lru_k_replacer.RecordAccess(frame_id, frame_id);
+    lru_k_replacer.Unpin(frame_id);
+  }
+  lru_k_replacer.Pin(1);
+  lru_k_replacer.RecordAccess(1, 1);
+  lru_k_replacer.Unpin(1);
+  EXPECT_EQ(6, lru_k_replacer.Size());
+
+  // Scenario: frames with a single reference have an infinite backward distance
+  // and go first, oldest reference first. Frame 1 survives although it is not
+  // the most recently used one.
+  int value;
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(3, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(4, value);
+
+  // Scenario: pinned frames are not victims.
+  lru_k_replacer.Pin(5);
+  EXPECT_EQ(2, lru_k_replacer.Size());
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(6, value);
+  lru_k_replacer.Unpin(5);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(5, value);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(1, value);
+  EXPECT_FALSE(lru_k_replacer.Victim(&value));
+
+  // Scenario: a frame reused for another page starts over with an empty history.
+  lru_k_replacer.RecordAccess(1, 1);
+  lru_k_replacer.RecordAccess(1, 1);
+  lru_k_replacer.RecordAccess(2, 2);
+  lru_k_replacer.RecordAccess(1, 100);
+  lru_k_replacer.Unpin(1);
+  lru_k_replacer.Unpin(2);
+  lru_k_replacer.Victim(&value);
+  EXPECT_EQ(2, value);
+}
+
+TEST(LRUKReplacerTest, CorrelatedPeriodTest) {
+  // Scenario: frame 1 is referenced twice in a row, then frame 3 once.
+  for (size_t correlated_period : {0, 2}) {
+    LRUKReplacer lru_k_replacer(7, 2, correlated_period);
+    lru_k_replacer.RecordAccess(1, 1);
+    lru_k_replacer.RecordAccess(1, 1);
+    lru_k_replacer.RecordAccess(3, 3);
+    lru_k_replacer.Unpin(1);
+    lru_k_replacer.Unpin(3);
+
+    // Without a correlated period frame 1 has two references and stays. With it,
+    // the burst counts as one reference and frame 1 is the oldest.
+    int value;
+    lru_k_replacer.Victim(&value);
+    EXPECT_EQ(correlated_period == 0 ? 3 : 1, value);
+  }
+}
+
+// Compares hit ratios of point lookups while a large sequential scan runs through the pool.
+TEST(LRUKReplacerTest, HitRatioBenchmark) {
+  const size_t num_frames = 256;
+  const size_t num_hot_pages = 1024;
+  const size_t num_scan_pages = 16384;
+  auto trace = MakeScanZipfianTrace(100000, num_hot_pages, num_scan_pages, 15445);
+
+  LRUReplacer lru_replacer(num_frames);
+  ClockReplacer clock_replacer(num_frames);
+  LRUKReplacer lru_k_replacer(num_frames, 2);
+  auto lru = ReplayTrace(&lru_replacer, num_frames, trace);
+  auto clock = ReplayTrace(&clock_replacer, num_frames, trace);
+  auto lru_k = ReplayTrace(&lru_k_replacer, num_frames, trace);
+
+  std::cout << "replacer  lookup hit ratio  overall hit ratio" << std::endl;
+  for (auto &[name, result] : {std::make_pair("lru", lru), std::make_pair("clock", clock),
+                               std::make_pair("lru-2", lru_k)}) {
+    printf("%-8s  %16.4f  %17.4f\n", name, result.LookupHitRatio(), result.HitRatio());
+  }
+  EXPECT_GT(lru_k.LookupHitRatio(), lru.LookupHitRatio());
+}
+
+}  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// page_table_test.cpp
+//
+// Identification: test/buffer/page_table_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <random>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/page_table.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, SampleTest) {
+  PageTable page_table(4);
+  frame_id_t frame_id;
+
+  // Scenario: Insert and look up a few pages.
+  page_table.Insert(1, 0);
+  page_table.Insert(9, 1);
+  page_table.Insert(17, 2);
+  EXPECT_EQ(3U, page_table.Size());
+  ASSERT_TRUE(page_table.Find(9, &frame_id));
+  EXPECT_EQ(1, frame_id);
+  EXPECT_FALSE(page_table.Find(2, &frame_id));
+
+  // Scenario: Erasing a page keeps the others reachable.
+  EXPECT_TRUE(page_table.Erase(1));
+  EXPECT_FALSE(page_table.Erase(1));
+  EXPECT_FALSE(page_table.Find(1, &frame_id));
+  ASSERT_TRUE(page_table.Find(17, &frame_id));
+  EXPECT_EQ(2, frame_id);
+  EXPECT_EQ(2U, page_table.Size());
+
+  // Scenario: Page ids past 32 bits keep their high bits, and do not alias the page id they share the low bits with.
+  const page_id_t large_page_id = (page_id_t{1} << 32) + 9;
+  page_table.Insert(large_page_id, 3);
+  ASSERT_TRUE(page_table.Find(large_page_id, &frame_id));
+  EXPECT_EQ(3, frame_id);
+  ASSERT_TRUE(page_table.Find(9, &frame_id));
+  EXPECT_EQ(1, frame_id);
+  EXPECT_TRUE(page_table.Erase(9));
+  EXPECT_TRUE(page_table.Find(large_page_id, &frame_id));
+  EXPECT_FALSE(page_table.Find(9, &frame_id));
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, RandomTest) {
+  const size_t num_frames = 64;
+  PageTable page_table(num_frames);
+  std::unordered_map<page_id_t, frame_id_t> expected;
+  std::default_random_engine rng(42);
+  std::uniform_int_distribution<page_id_t> page_dist(0, 1000);
+
+  // Scenario: A long mix of inserts and erases, checked against std::unordered_map. Clusters wrap around the end of
+  // the table and get shifted back by erases.
+  for (int i = 0; i < 100000; ++i) {
+    page_id_t page_id = page_dist(rng);
+    if (expected.count(page_id) > 0) {
+      EXPECT_TRUE(page_table.Erase(page_id));
+      expected.erase(page_id);
+    } else if (expected.size() < num_frames) {
+      page_table.Insert(page_id, i % num_frames);
+      expected[page_id] = i % num_frames;
+    }
+    if (i % 1000 == 0) {
+      for (page_id_t p = 0; p <= 1000; ++p) {
+        frame_id_t frame_id;
+        bool found = page_table.Find(p, &frame_id);
+        ASSERT_EQ(expected.count(p) > 0, found) << p;
+        if (found) {
+          EXPECT_EQ(expected[p], frame_id);
+        }
+      }
+    }
+  }
+  EXPECT_EQ(expected.size(), page_table.Size());
+}
+
+// NOLINTNEXTLINE
+TEST(PageTableTest, ConcurrentTest) {
+  const size_t num_frames = 16;
+  const int num_readers = 3;
+  PageTable page_table(num_frames);
+  // Pages 0..7 are never touched by the writer, they must be found on every lookup.
+  for (page_id_t p = 0; p < 8; ++p) {
+    page_table.Insert(p, p);
+  }
+
+  // Scenario: Readers look up the stable pages while a writer keeps inserting and erasing others around them.
+  std::atomic<bool> done{false};
+  std::atomic<int> num_failures{0};
+  std::vector<std::thread> readers;
+  for (int tid = 0; tid < num_readers; ++tid) {
+    readers.emplace_back([&] {
+      while (!done) {
+        for (page_id_t p = 0; p < 8; ++p) {
+          frame_id_t frame_id;
+          if (!page_table.Find(p, &frame_id) || frame_id != p) {
+            num_failures++;
+          }
+        }
+      }
+    });
+  }
+  for (int i = 0; i < 100000; ++i) {
+    page_id_t page_id = 8 + i % 64;
+    page_table.Insert(page_id, 8);
+    page_table.Erase(page_id);
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, num_failures.load());
+}
+
+}  // namespace bustub
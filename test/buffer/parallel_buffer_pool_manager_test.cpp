@@ -0,0 +1,260 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_buffer_pool_manager_test.cpp
+//
+// Identification: test/buffer/parallel_buffer_pool_manager_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "buffer/parallel_buffer_pool_manager.h"
+#include <chrono>  // NOLINT
+#include <cinttypes>
+#include <cstdio>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+#include "common/config_guard.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, SampleTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 3;
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+
+  // Scenario: We should be able to create new pages until every instance is full, and round-robin allocation
+  // should spread those pages evenly over the instances.
+  std::set<page_id_t> page_ids;
+  std::vector<size_t> per_instance(num_instances, 0);
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(page_id_temp, page->GetPageId());
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    page_ids.insert(page_id_temp);
+    per_instance[page_id_temp % num_instances]++;
+  }
+  EXPECT_EQ(num_instances * buffer_pool_size, page_ids.size());
+  for (size_t count : per_instance) {
+    EXPECT_EQ(buffer_pool_size, count);
+  }
+
+  // Scenario: Once every instance is full, we should not be able to create any new pages.
+  page_id_t page_id_temp;
+  EXPECT_EQ(nullptr, bpm->NewPage(&page_id_temp));
+
+  // Scenario: After unpinning every page, new pages evict old ones and the old data can be fetched back.
+  for (auto page_id : page_ids) {
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, true));
+  }
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    ASSERT_NE(nullptr, bpm->NewPage(&page_id_temp));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, false));
+  }
+  for (auto page_id : page_ids) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Hello " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  // Shutdown the disk manager and remove the temporary file we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FetchPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 3;
+  const size_t buffer_pool_size = 5;
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < 3 * num_instances * buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: A batch spanning every instance comes back in order.
+  std::vector<page_id_t> page_ids{7, 0, 1, 2, 30, 8};
+  std::vector<Page *> pages;
+  EXPECT_TRUE(bpm->FetchPages(page_ids, &pages));
+  ASSERT_EQ(page_ids.size(), pages.size());
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    ASSERT_NE(nullptr, pages[i]);
+    EXPECT_EQ("Hello " + std::to_string(page_ids[i]), std::string(pages[i]->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_ids[i], false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, FlushAllPagesTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 3;
+  const size_t buffer_pool_size = 5;
+  // Keep the background writers from writing pages back before the flush does.
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager);
+  for (size_t i = 0; i < num_instances * buffer_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: The dirty pages of every instance are written once, in one pass over all of them.
+  int num_writes = disk_manager->GetNumWrites();
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + static_cast<int>(num_instances * buffer_pool_size), disk_manager->GetNumWrites());
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetStats().dirty_write_backs_);
+  char data[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_instances * buffer_pool_size); ++page_id) {
+    disk_manager->ReadPage(page_id, data);
+    EXPECT_EQ("Hello " + std::to_string(page_id), std::string(data));
+  }
+  bpm->FlushAllPages();
+  EXPECT_EQ(num_writes + static_cast<int>(num_instances * buffer_pool_size), disk_manager->GetNumWrites());
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ResizeTest) {
+  const std::string db_name = "test.db";
+  const size_t num_instances = 3;
+  const size_t buffer_pool_size = 2;
+  const size_t max_pool_size = 4;
+  // Keep the background writer from pinning a frame for a write-back while the shrink runs, also one it started before
+  // the pages were flushed.
+  ConfigGuard bg_dirty_ratio_guard(&bg_dirty_ratio, 1.0);
+  ConfigGuard bg_free_frames_guard(&bg_free_frames, 0);
+
+  auto *disk_manager = new DiskManager(db_name);
+  auto *bpm = new ParallelBufferPoolManager(num_instances, buffer_pool_size, disk_manager, nullptr, ReplacerType::LRU,
+                                            max_pool_size);
+  EXPECT_EQ(num_instances * buffer_pool_size, bpm->GetPoolSize());
+  EXPECT_EQ(num_instances * max_pool_size, bpm->GetMaxPoolSize());
+  for (size_t i = 0; i < num_instances * max_pool_size; ++i) {
+    page_id_t page_id_temp;
+    auto *page = bpm->NewPage(&page_id_temp);
+    ASSERT_NE(nullptr, page);
+    snprintf(page->GetData(), PAGE_SIZE, "Hello %" PRId64, page_id_temp);
+    EXPECT_EQ(true, bpm->UnpinPage(page_id_temp, true));
+  }
+
+  // Scenario: Every instance keeps at least one frame, and none grows past its maximum.
+  EXPECT_FALSE(bpm->Resize(num_instances - 1));
+  EXPECT_FALSE(bpm->Resize(num_instances * max_pool_size + 1));
+
+  // Scenario: The new size is split among the instances, the pages survive either way.
+  EXPECT_TRUE(bpm->Resize(10));
+  EXPECT_EQ(10U, bpm->GetPoolSize());
+  EXPECT_EQ(4U, bpm->GetBufferPoolManager(0)->GetPoolSize());
+  EXPECT_EQ(3U, bpm->GetBufferPoolManager(1)->GetPoolSize());
+  // The frames past the new size are retired right away once their pages are clean.
+  bpm->FlushAllPages();
+  EXPECT_TRUE(bpm->Resize(num_instances));
+  EXPECT_EQ(num_instances, bpm->GetPoolSize());
+  for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_instances * max_pool_size); ++page_id) {
+    auto *page = bpm->FetchPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ("Hello " + std::to_string(page_id), std::string(page->GetData()));
+    EXPECT_EQ(true, bpm->UnpinPage(page_id, false));
+  }
+
+  delete bpm;
+  disk_manager->ShutDown();
+  remove("test.db");
+  delete disk_manager;
+}
+
+// Measures FetchPage/UnpinPage throughput of resident pages with several threads for a growing number of instances.
+// NOLINTNEXTLINE
+TEST(ParallelBufferPoolManagerTest, ScalingBenchmark) {
+  const std::string db_name = "test.db";
+  const size_t num_pages = 256;
+  const size_t num_threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+  const auto duration = std::chrono::milliseconds(200);
+
+  for (size_t num_instances : {1, 2, 4, 8, 16}) {
+    auto *disk_manager = new DiskManager(db_name);
+    auto *bpm = new ParallelBufferPoolManager(num_instances, num_pages / num_instances, disk_manager);
+
+    std::vector<page_id_t> page_ids;
+    for (size_t i = 0; i < num_pages; ++i) {
+      page_id_t page_id;
+      ASSERT_NE(nullptr, bpm->NewPage(&page_id));
+      bpm->UnpinPage(page_id, false);
+      page_ids.push_back(page_id);
+    }
+
+    std::atomic<bool> stop{false};
+    std::vector<size_t> lookups(num_threads, 0);
+    std::vector<std::thread> threads;
+    for (size_t tid = 0; tid < num_threads; ++tid) {
+      threads.emplace_back([&, tid] {
+        std::default_random_engine rng(tid);
+        std::uniform_int_distribution<size_t> dist(0, num_pages - 1);
+        while (!stop) {
+          page_id_t page_id = page_ids[dist(rng)];
+          Page *page = bpm->FetchPage(page_id);
+          EXPECT_NE(nullptr, page);
+          bpm->UnpinPage(page_id, false);
+          lookups[tid]++;
+        }
+      });
+    }
+    std::this_thread::sleep_for(duration);
+    stop = true;
+    for (auto &thread : threads) {
+      thread.join();
+    }
+
+    size_t total = 0;
+    for (size_t count : lookups) {
+      total += count;
+    }
+    double seconds = std::chrono::duration<double>(duration).count();
+    std::cout << "instances: " << num_instances << " threads: " << num_threads
+              << " lookups/sec: " << static_cast<size_t>(total / seconds) << std::endl;
+
+    delete bpm;
+    disk_manager->ShutDown();
+    remove("test.db");
+    delete disk_manager;
+  }
+}
+
+}  // namespace bustub
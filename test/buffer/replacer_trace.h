@@ -0,0 +1,125 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// replacer_trace.h
+//
+// Identification: test/buffer/replacer_trace.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "buffer/replacer.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+/** One access of a trace. Point lookups and scan steps are counted separately. */
+struct TraceAccess {
+  page_id_t page_id_;
+  bool is_scan_;
+};
+
+/** Hit counts of one trace replay. */
+struct TraceResult {
+  size_t lookups_{0};
+  size_t lookup_hits_{0};
+  size_t accesses_{0};
+  size_t hits_{0};
+
+  double LookupHitRatio() const { return lookups_ == 0 ? 0 : static_cast<double>(lookup_hits_) / lookups_; }
+  double HitRatio() const { return accesses_ == 0 ? 0 : static_cast<double>(hits_) / accesses_; }
+};
+
+/**
+ * Replays a trace through a replacer the way BufferPoolManager drives it: a hit pins the
+ * frame, a miss takes a free frame or a victim, and every access is unpinned right away.
+ */
+inline TraceResult ReplayTrace(Replacer *replacer, size_t num_frames, const std::vector<TraceAccess> &trace) {
+  TraceResult result;
+  std::unordered_map<page_id_t, frame_id_t> page_table;
+  std::vector<page_id_t> frames(num_frames, INVALID_PAGE_ID);
+  size_t next_free = 0;
+  for (const auto &access : trace) {
+    bool hit = page_table.count(access.page_id_) > 0;
+    frame_id_t frame_id;
+    if (hit) {
+      frame_id = page_table[access.page_id_];
+    } else if (next_free < num_frames) {
+      frame_id = static_cast<frame_id_t>(next_free++);
+    } else {
+      EXPECT_TRUE(replacer->Victim(&frame_id));
+      page_table.erase(frames[frame_id]);
+    }
+    page_table[access.page_id_] = frame_id;
+    frames[frame_id] = access.page_id_;
+    replacer->RecordAccess(frame_id, access.page_id_);
+    replacer->Pin(frame_id);
+    replacer->Unpin(frame_id);
+
+    result.accesses_++;
+    result.hits_ += hit ? 1 : 0;
+    if (!access.is_scan_) {
+      result.lookups_++;
+      result.lookup_hits_ += hit ? 1 : 0;
+    }
+  }
+  return result;
+}
+
+/** Draws page ids in [0, num_pages) following a Zipfian distribution with the given skew. */
+class ZipfianGenerator {
+ public:
+  ZipfianGenerator(size_t num_pages, double theta, uint32_t seed) : rng_(seed), cdf_(num_pages) {
+    double sum = 0;
+    for (size_t i = 0; i < num_pages; ++i) {
+      sum += 1.0 / std::pow(static_cast<double>(i + 1), theta);
+      cdf_[i] = sum;
+    }
+    for (auto &value : cdf_) {
+      value /= sum;
+    }
+  }
+
+  page_id_t Next() {
+    double u = std::uniform_real_distribution<double>(0, 1)(rng_);
+    auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+    return static_cast<page_id_t>(std::min<size_t>(it - cdf_.begin(), cdf_.size() - 1));
+  }
+
+ private:
+  std::default_random_engine rng_;
+  std::vector<double> cdf_;
+};
+
+/**
+ * Builds a trace of Zipfian point lookups over a hot set of pages. While a scan is running,
+ * which is the middle half of the trace, every lookup is followed by the next page of a
+ * sequential scan over a table much larger than the buffer pool.
+ */
+inline std::vector<TraceAccess> MakeScanZipfianTrace(size_t num_lookups, size_t num_hot_pages, size_t num_scan_pages,
+                                                    uint32_t seed) {
+  ZipfianGenerator zipf(num_hot_pages, 0.99, seed);
+  auto scan_start = static_cast<page_id_t>(num_hot_pages);
+  std::vector<TraceAccess> trace;
+  size_t scan_pos = 0;
+  for (size_t i = 0; i < num_lookups; ++i) {
+    trace.push_back({zipf.Next(), false});
+    if (i >= num_lookups / 4 && i < num_lookups * 3 / 4) {
+      trace.push_back({scan_start + static_cast<page_id_t>(scan_pos), true});
+      scan_pos = (scan_pos + 1) % num_scan_pages;
+    }
+  }
+  return trace;
+}
+
+}  // namespace bustub
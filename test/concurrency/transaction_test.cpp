@@ -69,6 +69,11 @@ class TransactionTest : public ::testing::Test {
   void TearDown() override {
     // Commit our transaction.
     txn_mgr_->Commit(txn_);
+    // Stop the buffer pool before the disk manager, its background threads still do I/O until then.
+    execution_engine_.reset();
+    exec_ctx_.reset();
+    catalog_.reset();
+    bpm_.reset();
     // Shut down the disk manager and clean up the transaction.
     disk_manager_->ShutDown();
     remove("executor_test.db");
@@ -67,10 +67,10 @@ TEST(HashTablePageTest, BlockPageSampleTest) {
 
   // unpin the header page now that we are done
   bpm->UnpinPage(block_page_id, true, nullptr);
+  delete bpm;
   disk_manager->ShutDown();
   remove("test.db");
   delete disk_manager;
-  delete bpm;
 }
 
 }  // namespace bustub
@@ -43,10 +43,10 @@ TEST(HashTableTest, SimpleTest) {
 
   EXPECT_EQ(ht.GetSize(), 5);
 
+  delete bpm;
   disk_manager->ShutDown();
   remove("test.db");
   delete disk_manager;
-  delete bpm;
 }
 
 TEST(HashTableTest, SampleTest) {
@@ -133,10 +133,10 @@ TEST(HashTableTest, SampleTest) {
 
   EXPECT_EQ(ht.GetSize(), 0);
 
+  delete bpm;
   disk_manager->ShutDown();
   remove("test.db");
   delete disk_manager;
-  delete bpm;
 }
 
 TEST(HashTableTest, ResizeTest) {
@@ -168,11 +168,11 @@ TEST(HashTableTest, ResizeTest) {
 
   EXPECT_EQ(ht.GetSize(), 1000);
 
-  disk_manager->ShutDown();
   bpm->UnpinPage(page_id, true);
+  delete bpm;
+  disk_manager->ShutDown();
   remove("test.db");
   delete disk_manager;
-  delete bpm;
 }
 
 TEST(HashTableTest, RemoveTest) {
@@ -213,11 +213,11 @@ TEST(HashTableTest, RemoveTest) {
     }
   }
 
-  disk_manager->ShutDown();
   bpm->UnpinPage(page_id, true);
+  delete bpm;
+  disk_manager->ShutDown();
   remove("test.db");
   delete disk_manager;
-  delete bpm;
 }
 
 class HashTableConcurrentTest : public ::testing::Test {
@@ -239,8 +239,10 @@ class HashTableConcurrentTest : public ::testing::Test {
   }
 
   void TearDown() override {
-    disk_manager_->ShutDown();
     bpm_->UnpinPage(page_id_, true);
+    ht_.reset();
+    bpm_.reset();
+    disk_manager_->ShutDown();
     remove("test.db");
     remove("test.log");
   };
@@ -0,0 +1,47 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// config_guard.h
+//
+// Identification: test/include/common/config_guard.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+
+#include "common/config.h"
+
+namespace bustub {
+
+/**
+ * ConfigGuard sets a configuration knob for the scope of a test and restores its old value when it goes out of scope,
+ * also when an ASSERT_* returns early, so that the change never leaks into later tests.
+ */
+template <typename T>
+class ConfigGuard {
+ public:
+  /**
+   * @param knob the knob, e.g. &bg_free_frames
+   * @param value the value for the scope of the guard
+   */
+  ConfigGuard(std::atomic<T> *knob, typename std::atomic<T>::value_type value)
+      : knob_(knob), old_value_(knob->load()) {
+    knob_->store(value);
+  }
+
+  ~ConfigGuard() { knob_->store(old_value_); }
+
+  ConfigGuard(const ConfigGuard &) = delete;
+  ConfigGuard &operator=(const ConfigGuard &) = delete;
+
+ private:
+  std::atomic<T> *knob_;
+  T old_value_;
+};
+
+}  // namespace bustub
@@ -2,6 +2,7 @@
  * b_plus_tree_test.cpp
  */
 
+#include <atomic>
 #include <chrono>  // NOLINT
 #include <cstdio>
 #include <functional>
@@ -142,8 +143,8 @@ TEST(BPlusTreeConcurrentTest, InsertTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -197,8 +198,8 @@ TEST(BPlusTreeConcurrentTest, InsertTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -240,8 +241,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest1) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -284,8 +285,8 @@ TEST(BPlusTreeConcurrentTest, DeleteTest2) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -330,8 +331,83 @@ TEST(BPlusTreeConcurrentTest, MixTest) {
 
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
+  delete bpm;
   delete disk_manager;
+  remove("test.db");
+  remove("test.log");
+}
+
+TEST(BPlusTreeConcurrentTest, ReadWhileInsertTest) {
+  // create KeyComparator and index schema
+  Schema *key_schema = ParseCreateStatement("a bigint");
+  GenericComparator<8> comparator(key_schema);
+
+  DiskManager *disk_manager = new DiskManager("test.db");
+  BufferPoolManager *bpm = new BufferPoolManager(1000, disk_manager);
+  // small pages, so that the inserts keep splitting internal pages under the readers
+  BPlusTree<GenericKey<8>, RID, GenericComparator<8>> tree("foo_pk", bpm, comparator, 4, 4);
+
+  // create and fetch header_page
+  page_id_t page_id;
+  auto header_page = bpm->NewPage(&page_id);
+  (void)header_page;
+  std::vector<int64_t> keys;
+  for (int64_t key = 1; key <= 100; key++) {
+    keys.push_back(key);
+  }
+  InsertHelper(&tree, keys);
+
+  // Readers descend optimistically while two writers insert more keys. Every key of the first batch must be found
+  // on every lookup.
+  std::vector<int64_t> more_keys;
+  for (int64_t key = 101; key <= 400; key++) {
+    more_keys.push_back(key);
+  }
+  std::atomic<bool> done{false};
+  std::atomic<int> num_missing{0};
+  std::vector<std::thread> threads;
+  for (uint64_t thread_id = 0; thread_id < 2; thread_id++) {
+    threads.emplace_back(InsertHelperSplit, &tree, more_keys, 2, thread_id);
+  }
+  std::vector<std::thread> readers;
+  for (int i = 0; i < 2; i++) {
+    readers.emplace_back([&] {
+      GenericKey<8> index_key;
+      std::vector<RID> rids;
+      Transaction transaction(0);
+      while (!done) {
+        for (auto key : keys) {
+          rids.clear();
+          index_key.SetFromInteger(key);
+          if (!tree.GetValue(index_key, &rids, &transaction) || rids[0].GetSlotNum() != key) {
+            num_missing++;
+          }
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  done = true;
+  for (auto &reader : readers) {
+    reader.join();
+  }
+  EXPECT_EQ(0, num_missing.load());
+
+  GenericKey<8> index_key;
+  std::vector<RID> rids;
+  Transaction transaction(0);
+  for (auto key : more_keys) {
+    rids.clear();
+    index_key.SetFromInteger(key);
+    EXPECT_TRUE(tree.GetValue(index_key, &rids, &transaction));
+  }
+
+  bpm->UnpinPage(HEADER_PAGE_ID, true);
+  delete key_schema;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -88,8 +88,8 @@ TEST(BPlusTreeTests, DeleteTest0) {
 
   delete key_schema;
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
   // remove("tree.dot");
@@ -131,8 +131,8 @@ TEST(BPlusTreeTests, DeleteTest3) {
 
   delete key_schema;
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -211,8 +211,8 @@ TEST(BPlusTreeTests, DeleteTest1) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -290,8 +290,8 @@ TEST(BPlusTreeTests, DeleteTest2) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
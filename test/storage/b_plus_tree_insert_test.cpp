@@ -96,8 +96,8 @@ TEST(BPlusTreeTests, InsertTest0) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
   remove("tree.dot");
@@ -162,8 +162,8 @@ TEST(BPlusTreeTests, InsertTest1) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
   remove("tree.dot");
@@ -222,8 +222,8 @@ TEST(BPlusTreeTests, InsertTest2) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
@@ -293,8 +293,8 @@ TEST(BPlusTreeTests, InsertTest3) {
   bpm->UnpinPage(HEADER_PAGE_ID, true);
   delete key_schema;
   delete transaction;
-  delete disk_manager;
   delete bpm;
+  delete disk_manager;
   remove("test.db");
   remove("test.log");
 }
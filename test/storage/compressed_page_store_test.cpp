@@ -0,0 +1,263 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compressed_page_store_test.cpp
+//
+// Identification: test/storage/compressed_page_store_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/stat.h>
+#include <chrono>  // NOLINT
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/table_generator.h"
+#include "common/util/lz_codec.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/executor_context.h"
+#include "gtest/gtest.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+static void RemoveDatabase(const std::string &name) {
+  for (const char *extension : {".db", ".log", ".fsm", ".cmap", ".cdat"}) {
+    remove((name + extension).c_str());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LZCodecTest, RoundTripTest) {
+  std::default_random_engine rng(15445);
+  std::vector<std::string> inputs;
+  inputs.emplace_back("");
+  inputs.emplace_back("abc");
+  inputs.emplace_back(PAGE_SIZE, '\0');
+  inputs.emplace_back(100000, 'x');
+  std::string text;
+  while (text.size() < PAGE_SIZE) {
+    text += "tuple " + std::to_string(text.size() % 97) + " of a table page, ";
+  }
+  inputs.push_back(text);
+  std::string noise(PAGE_SIZE, '\0');
+  for (auto &c : noise) {
+    c = static_cast<char>(rng());
+  }
+  inputs.push_back(noise);
+
+  for (const auto &input : inputs) {
+    std::vector<char> compressed(LZCodec::MaxCompressedSize(input.size()));
+    size_t size = LZCodec::Compress(input.data(), input.size(), compressed.data(), compressed.size());
+    ASSERT_NE(0, size);
+    std::vector<char> output(input.size() + 1);
+    EXPECT_EQ(input.size(), LZCodec::Decompress(compressed.data(), size, output.data(), output.size()));
+    EXPECT_EQ(0, memcmp(input.data(), output.data(), input.size()));
+    if (input.size() >= PAGE_SIZE && input != noise) {
+      EXPECT_LT(size, input.size() / 4);
+    }
+  }
+
+  // Scenario: Output that does not fit is refused, and so is corrupt input.
+  char small[16];
+  EXPECT_EQ(0, LZCodec::Compress(noise.data(), noise.size(), small, sizeof(small)));
+  std::vector<char> compressed(LZCodec::MaxCompressedSize(text.size()));
+  size_t size = LZCodec::Compress(text.data(), text.size(), compressed.data(), compressed.size());
+  std::vector<char> output(text.size());
+  EXPECT_EQ(0, LZCodec::Decompress(compressed.data(), size, output.data(), text.size() - 1));
+  for (int i = 0; i < 1000; ++i) {
+    std::vector<char> corrupt(compressed.begin(), compressed.begin() + size);
+    corrupt[rng() % size] = static_cast<char>(rng());
+    LZCodec::Decompress(corrupt.data(), rng() % (size + 1), output.data(), output.size());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageStoreTest, DiskManagerTest) {
+  const std::string db_name = "test_compressed";
+  RemoveDatabase(db_name);
+  const int num_pages = 8;
+  char data[PAGE_SIZE];
+  char buf[PAGE_SIZE];
+  auto fill = [&](page_id_t page_id) {
+    memset(data, 0, PAGE_SIZE);
+    for (size_t offset = 0; offset + 64 < PAGE_SIZE; offset += 64) {
+      snprintf(data + offset, 64, "Page %" PRId64 " row %zu", page_id, offset / 64);
+    }
+  };
+
+  auto *dm = new DiskManager(db_name + ".db");
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+  }
+  // Scenario: Compression is off until it is enabled for a page, and no files are created until then.
+  struct stat stat_buf;
+  EXPECT_FALSE(dm->IsPageCompressed(0));
+  EXPECT_NE(0, stat((db_name + ".cmap").c_str(), &stat_buf));
+  for (page_id_t page_id = 0; page_id < num_pages; page_id += 2) {
+    dm->SetPageCompression(page_id, true);
+  }
+  EXPECT_TRUE(dm->IsPageCompressed(2));
+  EXPECT_FALSE(dm->IsPageCompressed(3));
+
+  // Scenario: A batch of compressed and raw pages is written and read back, the compressed pages take a fraction of
+  // a page each.
+  std::vector<std::vector<char>> pages(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> write_data;
+  std::vector<char *> read_data;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    fill(page_id);
+    memcpy(pages[page_id].data(), data, PAGE_SIZE);
+    page_ids.push_back(page_id);
+    write_data.push_back(pages[page_id].data());
+  }
+  EXPECT_TRUE(dm->WritePages(page_ids, write_data));
+  auto stats = dm->GetCompressionStats();
+  EXPECT_EQ(static_cast<uint64_t>(num_pages / 2), stats.pages_written_);
+  EXPECT_GT(stats.CompressionRatio(), 2.0);
+  EXPECT_EQ(static_cast<int64_t>(stats.stored_bytes_), dm->GetCompressedDataSize());
+  std::vector<std::vector<char>> bufs(num_pages, std::vector<char>(PAGE_SIZE));
+  for (auto &page_buf : bufs) {
+    read_data.push_back(page_buf.data());
+  }
+  EXPECT_TRUE(dm->ReadPages(page_ids, read_data));
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ(0, memcmp(pages[page_id].data(), bufs[page_id].data(), PAGE_SIZE));
+  }
+  auto read = dm->ReadPageAsync(4, buf);
+  dm->SubmitIO();
+  EXPECT_TRUE(read.get());
+  EXPECT_EQ(0, memcmp(pages[4].data(), buf, PAGE_SIZE));
+
+  // Scenario: A page that no longer compresses is kept as it is, and one that compresses again moves back.
+  for (auto &c : data) {
+    c = static_cast<char>(rand());  // NOLINT
+  }
+  dm->WritePage(0, data);
+  dm->ReadPage(0, buf);
+  EXPECT_EQ(0, memcmp(data, buf, PAGE_SIZE));
+  dm->WritePage(0, pages[0].data());
+  dm->ReadPage(0, buf);
+  EXPECT_EQ(0, memcmp(pages[0].data(), buf, PAGE_SIZE));
+
+  // Scenario: A page compression is disabled for goes back to the tablespace on its next write, and a deallocated
+  // page leaves the store.
+  dm->SetPageCompression(2, false);
+  dm->ReadPage(2, buf);
+  EXPECT_EQ(0, memcmp(pages[2].data(), buf, PAGE_SIZE));
+  dm->WritePage(2, pages[2].data());
+  EXPECT_FALSE(dm->IsPageCompressed(2));
+  dm->DeallocatePage(6);
+  EXPECT_FALSE(dm->IsPageCompressed(6));
+  EXPECT_EQ(6, dm->AllocatePage());
+  dm->ReadPage(6, buf);
+  EXPECT_EQ(0, buf[0]);
+  dm->WritePage(6, pages[6].data());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: The map survives a restart, and slots given up before are reused.
+  dm = new DiskManager(db_name + ".db");
+  EXPECT_TRUE(dm->IsPageCompressed(0));
+  EXPECT_TRUE(dm->IsPageCompressed(4));
+  EXPECT_FALSE(dm->IsPageCompressed(2));
+  int64_t data_size = dm->GetCompressedDataSize();
+  dm->SetPageCompression(6, true);
+  dm->WritePage(6, pages[6].data());
+  EXPECT_EQ(data_size, dm->GetCompressedDataSize());
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    dm->ReadPage(page_id, buf);
+    EXPECT_EQ(0, memcmp(pages[page_id].data(), buf, PAGE_SIZE));
+  }
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A read-only database reads its compressed pages from the store, not from the mapping.
+  dm = new DiskManager(db_name + ".db", DiskManagerMode::READ_ONLY);
+  EXPECT_EQ(nullptr, dm->GetMappedPage(4));
+  EXPECT_NE(nullptr, dm->GetMappedPage(3));
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    dm->ReadPage(page_id, buf);
+    EXPECT_EQ(0, memcmp(pages[page_id].data(), buf, PAGE_SIZE));
+  }
+  EXPECT_THROW(dm->SetPageCompression(3, true), Exception);
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: The store of a database that is gone is not picked up by a new one.
+  remove((db_name + ".db").c_str());
+  dm = new DiskManager(db_name + ".db");
+  EXPECT_FALSE(dm->IsPageCompressed(0));
+  EXPECT_NE(0, stat((db_name + ".cmap").c_str(), &stat_buf));
+  dm->ShutDown();
+  delete dm;
+  RemoveDatabase(db_name);
+}
+
+// NOLINTNEXTLINE
+TEST(CompressedPageStoreTest, TableGeneratorBenchmark) {
+  const std::string db_name = "test_compressed";
+  const size_t buffer_pool_size = 32;
+
+  auto run = [&](bool compressed, const char *name) {
+    RemoveDatabase(db_name);
+    auto disk_manager = std::make_unique<DiskManager>(db_name + ".db");
+    auto bpm = std::make_unique<BufferPoolManager>(buffer_pool_size, disk_manager.get());
+    auto lock_manager = std::make_unique<LockManager>();
+    auto txn_mgr = std::make_unique<TransactionManager>(lock_manager.get(), nullptr);
+    auto catalog = std::make_unique<Catalog>(bpm.get(), lock_manager.get(), nullptr);
+    auto *txn = txn_mgr->Begin();
+    auto exec_ctx = std::make_unique<ExecutorContext>(txn, catalog.get(), bpm.get(), txn_mgr.get(), lock_manager.get());
+    TableGenerator gen{exec_ctx.get()};
+    gen.GenerateTestTables(compressed);
+    bpm->FlushAllPages();
+    txn_mgr->Commit(txn);
+    delete txn;
+
+    // Read every page back from disk, through the store for the compressed ones.
+    size_t num_pages = disk_manager->GetNumAllocatedPages();
+    char buf[PAGE_SIZE];
+    auto start = std::chrono::steady_clock::now();
+    for (page_id_t page_id = 0; page_id < static_cast<page_id_t>(num_pages); ++page_id) {
+      disk_manager->ReadPage(page_id, buf);
+    }
+    std::chrono::duration<double, std::micro> read_time = std::chrono::steady_clock::now() - start;
+
+    auto stats = disk_manager->GetCompressionStats();
+    // A compressed page writes its slot, the others a whole page.
+    uint64_t raw_bytes = static_cast<uint64_t>(disk_manager->GetNumWrites()) * PAGE_SIZE;
+    uint64_t io_bytes = raw_bytes - stats.raw_bytes_ + stats.stored_bytes_;
+    double compress_ns = stats.pages_written_ == 0 ? 0 : static_cast<double>(stats.compress_ns_) / stats.pages_written_;
+    double decompress_ns = stats.pages_read_ == 0 ? 0 : static_cast<double>(stats.decompress_ns_) / stats.pages_read_;
+    printf("%-10s  %6zu  %10" PRIu64 "  %10" PRIu64 "  %6.2f  %8.1f%%  %12.0f  %14.0f  %10.1f\n", name, num_pages,
+           raw_bytes, io_bytes, stats.CompressionRatio(), 100.0 * (raw_bytes - io_bytes) / raw_bytes, compress_ns,
+           decompress_ns, read_time.count());
+    if (compressed) {
+      EXPECT_GT(stats.CompressionRatio(), 1.0);
+      EXPECT_LT(io_bytes, raw_bytes);
+    }
+    exec_ctx.reset();
+    catalog.reset();
+    bpm.reset();
+    disk_manager->ShutDown();
+  };
+
+  std::cout << "mode         pages  page bytes    io bytes   ratio  io saved  compress ns  decompress ns  read us"
+            << std::endl;
+  run(false, "raw");
+  run(true, "compressed");
+  RemoveDatabase(db_name);
+}
+
+}  // namespace bustub
@@ -10,8 +10,18 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
+#include <unistd.h>
+#include <atomic>
+#include <cinttypes>
+#include <cstdio>
 #include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
 
+#include "common/config_guard.h"
 #include "common/exception.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
@@ -24,12 +34,14 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.fsm");
   };
 };
 
@@ -55,6 +67,138 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadPagesTest) {
+  const int num_pages = 8;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    snprintf(data, sizeof(data), "Page %" PRId64, page_id);
+    dm.WritePage(page_id, data);
+  }
+
+  // Scenario: Unordered pages, with runs of consecutive pages and a duplicate, land in their own buffers.
+  std::vector<page_id_t> page_ids{5, 1, 2, 3, 7, 0, 2};
+  std::vector<std::vector<char>> buffers(page_ids.size(), std::vector<char>(PAGE_SIZE));
+  std::vector<char *> page_data;
+  for (auto &buffer : buffers) {
+    page_data.push_back(buffer.data());
+  }
+  dm.ReadPages(page_ids, page_data);
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    EXPECT_EQ("Page " + std::to_string(page_ids[i]), std::string(page_data[i]));
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, WritePagesTest) {
+  const int num_pages = 8;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: Unordered pages, some of them consecutive in one buffer and some in buffers of their own, all land at
+  // their offset.
+  std::vector<char> run(3 * PAGE_SIZE);
+  std::vector<std::vector<char>> buffers(num_pages, std::vector<char>(PAGE_SIZE));
+  std::vector<page_id_t> page_ids{6, 3, 4, 5, 0, 7, 1, 2};
+  std::vector<const char *> page_data;
+  for (size_t i = 0; i < page_ids.size(); ++i) {
+    char *data = page_ids[i] >= 3 && page_ids[i] <= 5 ? &run[(page_ids[i] - 3) * PAGE_SIZE] : buffers[i].data();
+    snprintf(data, PAGE_SIZE, "Page %" PRId64, page_ids[i]);
+    page_data.push_back(data);
+  }
+  dm.WritePages(page_ids, page_data);
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+  char data[PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    dm.ReadPage(page_id, data);
+    EXPECT_EQ("Page " + std::to_string(page_id), std::string(data));
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ConcurrentReadWriteTest) {
+  const int num_threads = 8;
+  const int num_pages = 64;
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file);
+
+  // Scenario: Threads write and read back their own pages at the same time, interleaved with the other threads'
+  // pages, and nobody sees anybody else's data.
+  std::vector<int> num_failures(num_threads, 0);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      char data[PAGE_SIZE] = {0};
+      char buf[PAGE_SIZE] = {0};
+      for (int round = 0; round < 3; ++round) {
+        for (page_id_t page_id = tid; page_id < num_pages; page_id += num_threads) {
+          snprintf(data, sizeof(data), "Page %" PRId64 " round %d", page_id, round);
+          dm.WritePage(page_id, data);
+          dm.ReadPage(page_id, buf);
+          num_failures[tid] += std::memcmp(buf, data, sizeof(buf)) == 0 ? 0 : 1;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int tid = 0; tid < num_threads; ++tid) {
+    EXPECT_EQ(0, num_failures[tid]) << tid;
+  }
+  EXPECT_EQ(3 * num_pages, dm.GetNumWrites());
+
+  // Scenario: The file grew with the writes, a page past its end reads as zeroes.
+  char buf[PAGE_SIZE];
+  std::memset(buf, 1, sizeof(buf));
+  dm.ReadPage(num_pages, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(0, buf[PAGE_SIZE - 1]);
+  dm.ReadPage(num_pages - 1, buf);
+  EXPECT_EQ("Page " + std::to_string(num_pages - 1) + " round 2", std::string(buf));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, DirectIOTest) {
+  std::string db_file("test.db");
+  auto dm = DiskManager(db_file, true);
+  if (!dm.IsDirectIO()) {
+    std::cout << "direct I/O is not supported here, skipping" << std::endl;
+    dm.ShutDown();
+    return;
+  }
+
+  // Scenario: Aligned buffers go straight to disk and back, one by one or in a batch.
+  alignas(DiskManager::DIRECT_IO_ALIGNMENT) char data[3 * PAGE_SIZE] = {0};
+  alignas(DiskManager::DIRECT_IO_ALIGNMENT) char buf[3 * PAGE_SIZE] = {0};
+  for (page_id_t page_id = 0; page_id < 3; ++page_id) {
+    snprintf(data + page_id * PAGE_SIZE, PAGE_SIZE, "Page %" PRId64, page_id);
+  }
+  dm.WritePage(0, data);
+  dm.WritePages({2, 1}, {data + 2 * PAGE_SIZE, data + PAGE_SIZE});
+  dm.ReadPage(0, buf);
+  dm.ReadPages({1, 2}, {buf + PAGE_SIZE, buf + 2 * PAGE_SIZE});
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+
+  // Scenario: A page past the end of the file reads as zeroes.
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(0, buf[0]);
+
+  // Scenario: An unaligned buffer is rejected.
+  EXPECT_THROW(dm.WritePage(0, data + 1), Exception);
+  EXPECT_THROW(dm.ReadPage(0, buf + 512), Exception);
+
+  dm.ShutDown();
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ReadWriteLogTest) {
   char buf[16] = {0};
@@ -72,6 +216,453 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, AsyncIOTest) {
+  // More writes than fit into the ring at once.
+  const int num_pages = 1000;
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  std::vector<char> data(num_pages * PAGE_SIZE);
+  for (int i = 0; i < num_pages; ++i) {
+    snprintf(&data[i * PAGE_SIZE], PAGE_SIZE, "page %d", i);
+  }
+
+  // Scenario: Writes queued in batches all complete and run their callbacks.
+  std::atomic<int> num_written{0};
+  for (int i = 0; i < num_pages; ++i) {
+    dm.WritePageAsync(i, &data[i * PAGE_SIZE], [&](bool success) { num_written += success ? 1 : 0; });
+    if (i % 64 == 63) {
+      dm.SubmitIO();
+    }
+  }
+  dm.SubmitIO();
+  while (num_written < num_pages) {
+    std::this_thread::yield();
+  }
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: Reads return the pages written, in and out of order, the one past the end of the file as zeroes.
+  std::vector<char> buf(num_pages * PAGE_SIZE);
+  std::vector<std::future<bool>> reads;
+  for (int i = num_pages - 1; i >= 0; --i) {
+    reads.push_back(dm.ReadPageAsync(i, &buf[i * PAGE_SIZE]));
+  }
+  char past_end[PAGE_SIZE];
+  std::memset(past_end, 1, sizeof(past_end));
+  reads.push_back(dm.ReadPageAsync(num_pages, past_end));
+  dm.SubmitIO();
+  for (auto &read : reads) {
+    EXPECT_TRUE(read.get());
+  }
+  EXPECT_EQ(0, std::memcmp(data.data(), buf.data(), buf.size()));
+  EXPECT_EQ(0, past_end[0]);
+
+  // Scenario: Asynchronous log appends land in the order they were queued, and mix with synchronous ones.
+  char log_data[3][16] = {"first entry", "second entry", "third entry"};
+  auto first = dm.WriteLogAsync(log_data[0], sizeof(log_data[0]));
+  auto second = dm.WriteLogAsync(log_data[1], sizeof(log_data[1]));
+  dm.SubmitIO();
+  EXPECT_TRUE(first.get());
+  EXPECT_TRUE(second.get());
+  dm.WriteLog(log_data[2], sizeof(log_data[2]));
+  char log_buf[3 * 16];
+  EXPECT_TRUE(dm.ReadLog(log_buf, sizeof(log_buf), 0));
+  EXPECT_EQ(0, std::memcmp(log_data, log_buf, sizeof(log_buf)));
+  EXPECT_FALSE(dm.ReadLog(log_buf, sizeof(log_buf), sizeof(log_buf)));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, SyncFallbackIOTest) {
+  ConfigGuard enable_io_uring_guard(&enable_io_uring, false);
+  const int num_pages = 100;
+  std::string db_file("test.db");
+  DiskManager dm(db_file);
+  std::vector<char> data(num_pages * PAGE_SIZE);
+  for (int i = 0; i < num_pages; ++i) {
+    snprintf(&data[i * PAGE_SIZE], PAGE_SIZE, "page %d", i);
+  }
+
+  // Scenario: Without io_uring, asynchronous writes are done right away and run their callbacks before returning.
+  // Each one is counted once.
+  int num_written = 0;
+  for (int i = 0; i < num_pages; ++i) {
+    dm.WritePageAsync(i, &data[i * PAGE_SIZE], [&](bool success) { num_written += success ? 1 : 0; });
+  }
+  EXPECT_EQ(num_pages, num_written);
+  EXPECT_EQ(num_pages, dm.GetNumWrites());
+
+  // Scenario: Asynchronous reads return the pages written.
+  std::vector<char> buf(num_pages * PAGE_SIZE);
+  for (int i = 0; i < num_pages; ++i) {
+    EXPECT_TRUE(dm.ReadPageAsync(i, &buf[i * PAGE_SIZE]).get());
+  }
+  EXPECT_EQ(0, std::memcmp(data.data(), buf.data(), buf.size()));
+
+  // Scenario: Asynchronous log appends are written too.
+  char log_data[16] = "an entry";
+  EXPECT_TRUE(dm.WriteLogAsync(log_data, sizeof(log_data)).get());
+  char log_buf[16];
+  EXPECT_TRUE(dm.ReadLog(log_buf, sizeof(log_buf), 0));
+  EXPECT_EQ(0, std::memcmp(log_data, log_buf, sizeof(log_buf)));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FreeSpaceMapTest) {
+  const int num_pages = 10;
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  auto *dm = new DiskManager("test.db");
+
+  // Scenario: A new database allocates its pages front to back, and they read back what was written.
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+    dm->WritePage(page_id, data);
+  }
+  EXPECT_EQ(static_cast<size_t>(num_pages), dm->GetNumAllocatedPages());
+
+  // Scenario: Deallocated pages are reused lowest first before the file grows, and read as zeroes again.
+  dm->DeallocatePage(7);
+  dm->DeallocatePage(3);
+  dm->DeallocatePage(4);
+  dm->DeallocatePage(4);
+  EXPECT_FALSE(dm->IsPageAllocated(3));
+  EXPECT_TRUE(dm->IsPageAllocated(5));
+  EXPECT_EQ(static_cast<size_t>(num_pages - 3), dm->GetNumAllocatedPages());
+  EXPECT_EQ(3, dm->AllocatePage());
+  dm->ReadPage(3, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(4, dm->AllocatePage());
+  EXPECT_EQ(7, dm->AllocatePage());
+  EXPECT_EQ(num_pages, dm->AllocatePage());
+
+  // Scenario: An instance of a parallel buffer pool only gets the pages of its residue.
+  dm->DeallocatePage(4);
+  dm->DeallocatePage(5);
+  EXPECT_EQ(5, dm->AllocatePage(2, 1));
+  EXPECT_EQ(num_pages + 2, dm->AllocatePage(3, 0));
+  EXPECT_EQ(4, dm->AllocatePage(2, 0));
+
+  // Scenario: The map survives a restart.
+  dm->DeallocatePage(2);
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db");
+  EXPECT_FALSE(dm->IsPageAllocated(2));
+  EXPECT_TRUE(dm->IsPageAllocated(num_pages + 2));
+  EXPECT_FALSE(dm->IsPageAllocated(num_pages + 1));
+  EXPECT_EQ(static_cast<size_t>(num_pages + 1), dm->GetNumAllocatedPages());
+  EXPECT_EQ(2, dm->AllocatePage());
+
+  // Scenario: A reused page is allocated in the map on disk before it is handed out, so that a crash before the next
+  // Sync does not free it again. The read-only instance sees the map as it is on disk.
+  dm->DeallocatePage(3);
+  dm->Sync();
+  EXPECT_EQ(3, dm->AllocatePage());
+  {
+    DiskManager on_disk("test.db", DiskManagerMode::READ_ONLY);
+    EXPECT_TRUE(on_disk.IsPageAllocated(3));
+  }
+
+  // Scenario: Pages freed at the end of the file stay free after a restart, and are reused before the file grows.
+  size_t num_allocated = dm->GetNumAllocatedPages();
+  dm->DeallocatePage(num_pages - 1);
+  dm->DeallocatePage(num_pages - 2);
+  dm->Sync();
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(num_allocated - 2, dm->GetNumAllocatedPages());
+  EXPECT_FALSE(dm->IsPageAllocated(num_pages - 1));
+  EXPECT_EQ(num_pages - 2, dm->AllocatePage());
+  EXPECT_EQ(num_pages - 1, dm->AllocatePage());
+
+  // Scenario: A database without a map, e.g. one of format version 1, is refused, in read-only mode too.
+  dm->ShutDown();
+  delete dm;
+  remove("test.fsm");
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+  remove("test.fsm");
+  EXPECT_THROW(DiskManager("test.db", DiskManagerMode::READ_ONLY), Exception);
+
+  // Scenario: A map whose database file is gone is dropped.
+  remove("test.db");
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(0U, dm->GetNumAllocatedPages());
+  EXPECT_EQ(0, dm->AllocatePage());
+
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ExtentTest) {
+  const int extent_pages = 16;
+  ConfigGuard db_extent_size_guard(&db_extent_size, extent_pages * PAGE_SIZE);
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+  struct stat stat_buf;
+  auto *dm = new DiskManager("test.db");
+
+  // Scenario: The first allocation reserves a whole extent, the file size stays at the pages written.
+  EXPECT_EQ(0, dm->GetReservedSize());
+  EXPECT_EQ(0, dm->AllocatePage());
+  if (dm->GetReservedSize() == 0) {
+    std::cout << "Preallocation is not supported here, skipping." << std::endl;
+    dm->ShutDown();
+    delete dm;
+    return;
+  }
+  EXPECT_EQ(extent_pages * PAGE_SIZE, dm->GetReservedSize());
+  ASSERT_EQ(0, stat("test.db", &stat_buf));
+  EXPECT_EQ(0, stat_buf.st_size);
+  EXPECT_LE(extent_pages * PAGE_SIZE, stat_buf.st_blocks * 512);
+
+  // Scenario: The file grows by another extent once the allocations pass the end of the reserved space.
+  for (page_id_t page_id = 1; page_id < extent_pages; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+  }
+  EXPECT_EQ(extent_pages * PAGE_SIZE, dm->GetReservedSize());
+  EXPECT_EQ(extent_pages, dm->AllocatePage());
+  EXPECT_EQ(2 * extent_pages * PAGE_SIZE, dm->GetReservedSize());
+
+  // Scenario: Pages in the reserved space read back what was written, or zeroes before that.
+  dm->WritePage(extent_pages, data);
+  dm->ReadPage(extent_pages, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  dm->ReadPage(3, buf);
+  EXPECT_EQ(0, buf[0]);
+  ASSERT_EQ(0, stat("test.db", &stat_buf));
+  EXPECT_EQ((extent_pages + 1) * PAGE_SIZE, stat_buf.st_size);
+
+  // Scenario: After a restart, the reserved space starts at the end of the file and the allocations go on past the
+  // pages allocated before, growing it by an extent again.
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db");
+  EXPECT_EQ((extent_pages + 1) * PAGE_SIZE, dm->GetReservedSize());
+  EXPECT_EQ(static_cast<size_t>(extent_pages + 1), dm->GetNumAllocatedPages());
+  EXPECT_EQ(extent_pages + 1, dm->AllocatePage());
+  EXPECT_EQ(2 * extent_pages * PAGE_SIZE, dm->GetReservedSize());
+  dm->ReadPage(extent_pages, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+
+  // Scenario: With preallocation turned off, the reserved space stays where it is.
+  db_extent_size = 0;
+  for (page_id_t page_id = extent_pages + 2; page_id <= 2 * extent_pages; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+  }
+  EXPECT_EQ(2 * extent_pages * PAGE_SIZE, dm->GetReservedSize());
+
+  dm->ShutDown();
+  delete dm;
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, LargeFileTest) {
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  DiskManager dm("test.db");
+
+  // Scenario: Pages past 2GiB, and past the 8TiB a 32-bit page id could address, are written and read back in a
+  // sparse file.
+  std::vector<page_id_t> page_ids{(page_id_t{1} << 31) / PAGE_SIZE + 1, (page_id_t{1} << 31) + 5};
+  for (page_id_t page_id : page_ids) {
+    snprintf(data, sizeof(data), "Page %" PRId64, page_id);
+    dm.WritePage(page_id, data);
+  }
+  for (page_id_t page_id : page_ids) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ("Page " + std::to_string(page_id), std::string(buf));
+  }
+  struct stat stat_buf;
+  ASSERT_EQ(0, stat("test.db", &stat_buf));
+  EXPECT_EQ((page_ids.back() + 1) * PAGE_SIZE, stat_buf.st_size);
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, FormatVersionTest) {
+  auto *dm = new DiskManager("test.db");
+  EXPECT_EQ(0, dm->AllocatePage());
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A database stamped with the current format version opens again.
+  dm = new DiskManager("test.db");
+  EXPECT_TRUE(dm->IsPageAllocated(0));
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A database stamped with another version, e.g. one with 32-bit page ids, is refused.
+  FILE *fsm = fopen("test.fsm", "r+b");
+  ASSERT_NE(nullptr, fsm);
+  uint32_t old_version = 1;
+  fseek(fsm, sizeof(uint64_t), SEEK_SET);
+  fwrite(&old_version, sizeof(old_version), 1, fsm);
+  fclose(fsm);
+  EXPECT_THROW(DiskManager("test.db"), Exception);
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, TablespaceTest) {
+  const int stripe_pages = 4;
+  const int num_pages = 6 * stripe_pages;
+  const std::vector<std::string> directories{"test_ts0", "test_ts1", "test_ts2"};
+  for (const auto &directory : directories) {
+    mkdir(directory.c_str(), 0755);
+  }
+  auto *dm = new DiskManager("test.db", directories, false, stripe_pages * PAGE_SIZE);
+  EXPECT_EQ(directories.size(), dm->GetTablespace().GetNumFiles());
+  std::vector<std::vector<char>> data(num_pages + 1, std::vector<char>(PAGE_SIZE));
+
+  // Scenario: A batch spanning several stripes is written to and read back from the files the stripes are dealt to.
+  std::vector<page_id_t> page_ids;
+  std::vector<const char *> write_data;
+  std::vector<char *> read_data;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    snprintf(data[page_id].data(), PAGE_SIZE, "Page %" PRId64, page_id);
+    page_ids.push_back(page_id);
+    write_data.push_back(data[page_id].data());
+  }
+  EXPECT_TRUE(dm->WritePages(page_ids, write_data));
+  std::vector<std::vector<char>> buf(num_pages, std::vector<char>(PAGE_SIZE));
+  for (auto &page_buf : buf) {
+    read_data.push_back(page_buf.data());
+  }
+  EXPECT_TRUE(dm->ReadPages(page_ids, read_data));
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ("Page " + std::to_string(page_id), std::string(buf[page_id].data()));
+  }
+  struct stat stat_buf;
+  for (size_t i = 0; i < directories.size(); ++i) {
+    ASSERT_EQ(0, stat(dm->GetTablespace().GetFileName(i).c_str(), &stat_buf));
+    EXPECT_EQ(2 * stripe_pages * PAGE_SIZE, stat_buf.st_size);
+  }
+  FILE *file = fopen("test_ts1/test.1.db", "rb");
+  ASSERT_NE(nullptr, file);
+  fseek(file, stripe_pages * PAGE_SIZE, SEEK_SET);
+  EXPECT_EQ(PAGE_SIZE, fread(buf[0].data(), 1, PAGE_SIZE, file));
+  fclose(file);
+  EXPECT_EQ("Page " + std::to_string(4 * stripe_pages), std::string(buf[0].data()));
+
+  // Scenario: Asynchronous I/O goes to the file of the page too.
+  snprintf(data[num_pages].data(), PAGE_SIZE, "Page %d", num_pages + 2);
+  auto write = dm->WritePageAsync(num_pages + 2, data[num_pages].data());
+  dm->SubmitIO();
+  EXPECT_TRUE(write.get());
+  auto read = dm->ReadPageAsync(stripe_pages + 1, buf[0].data());
+  dm->SubmitIO();
+  EXPECT_TRUE(read.get());
+  EXPECT_EQ("Page " + std::to_string(stripe_pages + 1), std::string(buf[0].data()));
+
+  // Scenario: After a restart, the pages up to the last one written in any file are taken as allocated and read back.
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db", directories, false, stripe_pages * PAGE_SIZE);
+  EXPECT_EQ(static_cast<size_t>(num_pages + 3), dm->GetNumAllocatedPages());
+  EXPECT_EQ(num_pages + 3, dm->AllocatePage());
+  dm->ReadPage(num_pages + 2, buf[0].data());
+  EXPECT_EQ("Page " + std::to_string(num_pages + 2), std::string(buf[0].data()));
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A database is not opened with another tablespace layout.
+  EXPECT_THROW(DiskManager("test.db", {"test_ts0", "test_ts1"}, false, stripe_pages * PAGE_SIZE), Exception);
+  EXPECT_THROW(DiskManager("test.db", directories, false, 2 * stripe_pages * PAGE_SIZE), Exception);
+
+  for (size_t i = 0; i < directories.size(); ++i) {
+    remove((directories[i] + "/test." + std::to_string(i) + ".db").c_str());
+    rmdir(directories[i].c_str());
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ReadOnlyTest) {
+  const int num_pages = 8;
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+
+  // Scenario: A database that does not exist is not created in read-only mode.
+  EXPECT_THROW(DiskManager("test.db", DiskManagerMode::READ_ONLY), Exception);
+
+  auto *dm = new DiskManager("test.db");
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ(page_id, dm->AllocatePage());
+    snprintf(data, PAGE_SIZE, "Page %" PRId64, page_id);
+    dm->WritePage(page_id, data);
+  }
+  EXPECT_FALSE(dm->IsReadOnly());
+  EXPECT_EQ(nullptr, dm->GetMappedPage(0));
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: The pages are copied out of the mapping, or handed out in place.
+  dm = new DiskManager("test.db", DiskManagerMode::READ_ONLY);
+  EXPECT_TRUE(dm->IsReadOnly());
+  EXPECT_EQ(static_cast<size_t>(num_pages), dm->GetNumAllocatedPages());
+  dm->Advise(0, 0, AccessHint::SEQUENTIAL);
+  dm->Advise(num_pages - 2, 2, AccessHint::WILLNEED);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    dm->ReadPage(page_id, buf);
+    EXPECT_EQ("Page " + std::to_string(page_id), std::string(buf));
+    const char *page = dm->GetMappedPage(page_id);
+    ASSERT_NE(nullptr, page);
+    EXPECT_EQ(0, memcmp(buf, page, PAGE_SIZE));
+  }
+  auto read = dm->ReadPageAsync(3, buf);
+  dm->SubmitIO();
+  EXPECT_TRUE(read.get());
+  EXPECT_EQ("Page 3", std::string(buf));
+  EXPECT_EQ(nullptr, dm->GetMappedPage(num_pages));
+  EXPECT_EQ(nullptr, dm->GetMappedPage(INVALID_PAGE_ID));
+
+  // Scenario: Nothing that would change the database is done.
+  EXPECT_THROW(dm->WritePage(0, data), Exception);
+  EXPECT_THROW(dm->AllocatePage(), Exception);
+  EXPECT_THROW(dm->DeallocatePage(0), Exception);
+  EXPECT_THROW(dm->WriteLog(data, 16), Exception);
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db");
+  EXPECT_EQ(num_pages, dm->AllocatePage());
+  dm->ReadPage(0, buf);
+  EXPECT_EQ("Page 0", std::string(buf));
+  dm->ShutDown();
+  delete dm;
+
+  // Scenario: A striped database is mapped file by file.
+  const std::vector<std::string> directories{"test_ts0", "test_ts1"};
+  for (const auto &directory : directories) {
+    mkdir(directory.c_str(), 0755);
+  }
+  remove("test.fsm");
+  dm = new DiskManager("test.db", directories, false, PAGE_SIZE);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    snprintf(data, PAGE_SIZE, "Striped page %" PRId64, page_id);
+    dm->WritePage(page_id, data);
+  }
+  dm->ShutDown();
+  delete dm;
+  dm = new DiskManager("test.db", directories, false, PAGE_SIZE, DiskManagerMode::READ_ONLY);
+  dm->Advise(1, 0, AccessHint::SEQUENTIAL);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_EQ("Striped page " + std::to_string(page_id), std::string(dm->GetMappedPage(page_id)));
+  }
+  dm->ShutDown();
+  delete dm;
+  for (size_t i = 0; i < directories.size(); ++i) {
+    remove((directories[i] + "/test." + std::to_string(i) + ".db").c_str());
+    rmdir(directories[i].c_str());
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 
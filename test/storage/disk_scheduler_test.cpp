@@ -0,0 +1,227 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// disk_scheduler_test.cpp
+//
+// Identification: test/storage/disk_scheduler_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <future>  // NOLINT
+#include <string>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "storage/disk/disk_scheduler.h"
+
+namespace bustub {
+
+class DiskSchedulerTest : public ::testing::Test {
+ protected:
+  // This function is called before every test.
+  void SetUp() override {
+    remove("test.db");
+    remove("test.log");
+  }
+
+  // This function is called after every test.
+  void TearDown() override {
+    remove("test.db");
+    remove("test.log");
+  };
+};
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ScheduleTest) {
+  DiskManager dm("test.db");
+  auto *scheduler = new DiskScheduler(&dm, 2);
+  char data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  std::strncpy(data, "A test string.", sizeof(data));
+
+  // Scenario: A write and a read after it complete through their futures.
+  EXPECT_TRUE(scheduler->ScheduleWrite(0, data).get());
+  EXPECT_TRUE(scheduler->ScheduleRead(0, buf).get());
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  auto stats = scheduler->GetStats();
+  EXPECT_EQ(2U, stats.requests_);
+  EXPECT_EQ(0U, stats.merged_requests_);
+  EXPECT_EQ(0U, scheduler->GetQueueDepth());
+  EXPECT_LE(1U, stats.max_queue_depth_);
+
+  // Scenario: The synchronous calls are counted like scheduled requests.
+  std::memset(buf, 0, sizeof(buf));
+  EXPECT_TRUE(scheduler->WritePage(1, data));
+  EXPECT_TRUE(scheduler->ReadPage(1, buf));
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  EXPECT_EQ(4U, scheduler->GetStats().requests_);
+  EXPECT_EQ(0U, scheduler->GetQueueDepth());
+
+  // Scenario: Requests still waiting are served before the scheduler goes away.
+  std::vector<std::future<bool>> writes;
+  for (page_id_t page_id = 0; page_id < 16; ++page_id) {
+    writes.push_back(scheduler->ScheduleWrite(page_id, data, DiskRequestPriority::BACKGROUND));
+  }
+  delete scheduler;
+  for (auto &write : writes) {
+    EXPECT_TRUE(write.get());
+  }
+  EXPECT_EQ(18, dm.GetNumWrites());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, MergeTest) {
+  const int num_pages = 8;
+  DiskManager dm("test.db");
+  DiskScheduler scheduler(&dm, 1);
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+
+  // Scenario: Unordered writes of consecutive pages scheduled together are served as one request, and a request of
+  // another kind for an adjacent page is not merged into them.
+  std::vector<page_id_t> page_ids{3, 1, 6, 0, 2, 7, 4, 5};
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> futures;
+  for (page_id_t page_id : page_ids) {
+    snprintf(data[page_id].data(), PAGE_SIZE, "Page %" PRId64, page_id);
+    requests.push_back(DiskRequest{true, data[page_id].data(), page_id, std::promise<bool>()});
+    futures.push_back(requests.back().callback_.get_future());
+  }
+  char buf[PAGE_SIZE];
+  requests.push_back(DiskRequest{false, buf, num_pages, std::promise<bool>()});
+  futures.push_back(requests.back().callback_.get_future());
+  scheduler.Schedule(&requests);
+  EXPECT_TRUE(requests.empty());
+  for (auto &future : futures) {
+    future.get();
+  }
+  auto stats = scheduler.GetStats();
+  EXPECT_EQ(static_cast<uint64_t>(num_pages + 1), stats.requests_);
+  EXPECT_EQ(static_cast<uint64_t>(num_pages - 1), stats.merged_requests_);
+  EXPECT_EQ(static_cast<size_t>(num_pages + 1), stats.max_queue_depth_);
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    dm.ReadPage(page_id, buf);
+    EXPECT_EQ("Page " + std::to_string(page_id), std::string(buf));
+  }
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, PriorityTest) {
+  DiskManager dm("test.db");
+  DiskScheduler scheduler(&dm, 1);
+  char old_data[PAGE_SIZE] = {0};
+  char new_data[PAGE_SIZE] = {0};
+  char buf[PAGE_SIZE] = {0};
+  std::strncpy(old_data, "old", sizeof(old_data));
+  std::strncpy(new_data, "new", sizeof(new_data));
+  EXPECT_TRUE(scheduler.ScheduleWrite(0, old_data).get());
+
+  // Scenario: A foreground read scheduled after a background write of the same page is served first.
+  std::vector<DiskRequest> requests;
+  requests.push_back(DiskRequest{true, new_data, 0, std::promise<bool>(), DiskRequestPriority::BACKGROUND});
+  auto write = requests.back().callback_.get_future();
+  requests.push_back(DiskRequest{false, buf, 0, std::promise<bool>(), DiskRequestPriority::FOREGROUND});
+  auto read = requests.back().callback_.get_future();
+  scheduler.Schedule(&requests);
+  EXPECT_TRUE(read.get());
+  EXPECT_TRUE(write.get());
+  EXPECT_EQ("old", std::string(buf));
+  EXPECT_TRUE(scheduler.ScheduleRead(0, buf).get());
+  EXPECT_EQ("new", std::string(buf));
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, ConcurrentScheduleTest) {
+  const int num_threads = 8;
+  const int num_pages = 64;
+  DiskManager dm("test.db");
+  DiskScheduler scheduler(&dm, 4);
+
+  // Scenario: Threads write and read back their own pages through the scheduler, nobody sees anybody else's data.
+  std::vector<int> num_failures(num_threads, 0);
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; ++tid) {
+    threads.emplace_back([&, tid] {
+      char data[PAGE_SIZE] = {0};
+      char buf[PAGE_SIZE] = {0};
+      for (int round = 0; round < 3; ++round) {
+        for (page_id_t page_id = tid; page_id < num_pages; page_id += num_threads) {
+          snprintf(data, sizeof(data), "Page %" PRId64 " round %d", page_id, round);
+          num_failures[tid] += scheduler.ScheduleWrite(page_id, data, DiskRequestPriority::BACKGROUND).get() ? 0 : 1;
+          num_failures[tid] += scheduler.ScheduleRead(page_id, buf).get() ? 0 : 1;
+          num_failures[tid] += std::memcmp(buf, data, sizeof(buf)) == 0 ? 0 : 1;
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+  for (int tid = 0; tid < num_threads; ++tid) {
+    EXPECT_EQ(0, num_failures[tid]) << tid;
+  }
+  EXPECT_EQ(static_cast<uint64_t>(2 * 3 * num_pages), scheduler.GetStats().requests_);
+  EXPECT_EQ(0U, scheduler.GetQueueDepth());
+
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskSchedulerTest, StripedScheduleTest) {
+  const int stripe_pages = 4;
+  const int num_pages = 4 * stripe_pages;
+  const std::vector<std::string> directories{"test_ts0", "test_ts1"};
+  for (const auto &directory : directories) {
+    mkdir(directory.c_str(), 0755);
+  }
+  auto *dm = new DiskManager("test.db", directories, false, stripe_pages * PAGE_SIZE);
+  auto *scheduler = new DiskScheduler(dm, 1);
+  std::vector<std::vector<char>> data(num_pages, std::vector<char>(PAGE_SIZE));
+
+  // Scenario: A batch is split up among the queues of the files, adjacent pages are only merged within a stripe.
+  std::vector<DiskRequest> requests;
+  std::vector<std::future<bool>> futures;
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    snprintf(data[page_id].data(), PAGE_SIZE, "Page %" PRId64, page_id);
+    requests.push_back(DiskRequest{true, data[page_id].data(), page_id, std::promise<bool>()});
+    futures.push_back(requests.back().callback_.get_future());
+  }
+  scheduler->Schedule(&requests);
+  for (auto &future : futures) {
+    EXPECT_TRUE(future.get());
+  }
+  auto stats = scheduler->GetStats();
+  EXPECT_EQ(static_cast<uint64_t>(num_pages), stats.requests_);
+  EXPECT_EQ(static_cast<uint64_t>(num_pages - num_pages / stripe_pages), stats.merged_requests_);
+
+  // Scenario: Every file has a worker of its own, even with a single worker asked for.
+  char buf[PAGE_SIZE];
+  for (page_id_t page_id = 0; page_id < num_pages; ++page_id) {
+    EXPECT_TRUE(scheduler->ScheduleRead(page_id, buf).get());
+    EXPECT_EQ("Page " + std::to_string(page_id), std::string(buf));
+  }
+
+  delete scheduler;
+  dm->ShutDown();
+  delete dm;
+  for (size_t i = 0; i < directories.size(); ++i) {
+    remove((directories[i] + "/test." + std::to_string(i) + ".db").c_str());
+    rmdir(directories[i].c_str());
+  }
+}
+
+}  // namespace bustub
@@ -63,11 +63,11 @@ TEST(TupleTest, DISABLED_TableHeapTest) {
     // std::cout << i++ << std::endl;
     assert(table->MarkDelete(rid, transaction) == 1);
   }
+  delete buffer_pool_manager;
   disk_manager->ShutDown();
   remove("test.db");  // remove db file
   remove("test.log");
   delete table;
-  delete buffer_pool_manager;
   delete disk_manager;
 }
 